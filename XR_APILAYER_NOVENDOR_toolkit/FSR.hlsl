@@ -27,11 +27,16 @@ cbuffer cb : register(b0)
   uint4 Const2;
   uint4 Const3;
   uint4 Const4;
+  uint4 Const5; // EASU input offset (normalized), output offset
+  uint4 Const6; // output size, RCAS input offset
 };
 
 #define A_GPU 1
 #define A_HLSL 1
 
+// EASU samples the input rectangle of the view.
+#define EASU_UV(p) ((p) + asfloat(Const5.xy))
+
 SamplerState		samLinearClamp : register(s0);
 
 #if SAMPLE_SLOW_FALLBACK
@@ -40,16 +45,16 @@ SamplerState		samLinearClamp : register(s0);
   RWTexture2D<float4> OutputTexture : register(u0);
   #if SAMPLE_EASU
     #define FSR_EASU_F 1
-    AF4 FsrEasuRF(AF2 p) { AF4 res = InputTexture.GatherRed(samLinearClamp, p, int2(0, 0)); return res; }
-    AF4 FsrEasuGF(AF2 p) { AF4 res = InputTexture.GatherGreen(samLinearClamp, p, int2(0, 0)); return res; }
-    AF4 FsrEasuBF(AF2 p) { AF4 res = InputTexture.GatherBlue(samLinearClamp, p, int2(0, 0)); return res; }
+    AF4 FsrEasuRF(AF2 p) { AF4 res = InputTexture.GatherRed(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }
+    AF4 FsrEasuGF(AF2 p) { AF4 res = InputTexture.GatherGreen(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }
+    AF4 FsrEasuBF(AF2 p) { AF4 res = InputTexture.GatherBlue(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }
   #endif
   #if SAMPLE_RCAS
     #define FSR_RCAS_F
     #if SAMPLE_HDR_OUTPUT
-      AF4 FsrRcasLoadF(ASU2 p) { return sqrt(InputTexture.Load(int3(ASU2(p), 0))); }
+      AF4 FsrRcasLoadF(ASU2 p) { return sqrt(InputTexture.Load(int3(ASU2(p) + ASU2(Const6.zw), 0))); }
     #else
-      AF4 FsrRcasLoadF(ASU2 p) { return InputTexture.Load(int3(ASU2(p), 0)); }
+      AF4 FsrRcasLoadF(ASU2 p) { return InputTexture.Load(int3(ASU2(p) + ASU2(Const6.zw), 0)); }
     #endif
     void FsrRcasInputF(inout AF1 r, inout AF1 g, inout AF1 b) {
     }
@@ -61,13 +66,13 @@ SamplerState		samLinearClamp : register(s0);
   RWTexture2D<AH4> OutputTexture : register(u0);
   #if SAMPLE_EASU
     #define FSR_EASU_H 1
-    AH4 FsrEasuRH(AF2 p) { AH4 res = InputTexture.GatherRed(samLinearClamp, p, int2(0, 0)); return res; }
-    AH4 FsrEasuGH(AF2 p) { AH4 res = InputTexture.GatherGreen(samLinearClamp, p, int2(0, 0)); return res; }
-    AH4 FsrEasuBH(AF2 p) { AH4 res = InputTexture.GatherBlue(samLinearClamp, p, int2(0, 0)); return res; }	
+    AH4 FsrEasuRH(AF2 p) { AH4 res = InputTexture.GatherRed(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }
+    AH4 FsrEasuGH(AF2 p) { AH4 res = InputTexture.GatherGreen(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }
+    AH4 FsrEasuBH(AF2 p) { AH4 res = InputTexture.GatherBlue(samLinearClamp, EASU_UV(p), int2(0, 0)); return res; }	
   #endif
   #if SAMPLE_RCAS
     #define FSR_RCAS_H
-    AH4 FsrRcasLoadH(ASW2 p) { return InputTexture.Load(ASW3(ASW2(p), 0)); }
+    AH4 FsrRcasLoadH(ASW2 p) { return InputTexture.Load(ASW3(ASW2(p) + ASW2(Const6.zw), 0)); }
     void FsrRcasInputH(inout AH1 r,inout AH1 g,inout AH1 b){}
   #endif
 #endif
@@ -76,9 +81,14 @@ SamplerState		samLinearClamp : register(s0);
 
 void CurrFilter(int2 pos)
 {
+  // Stay within the output rectangle, the neighboring pixels may belong to another view.
+  if (any(uint2(pos) >= Const6.xy))
+    return;
+  const int2 dst = pos + int2(Const5.zw);
+
 #if SAMPLE_BILINEAR
   AF2 pp = (AF2(pos) * AF2_AU2(Const0.xy) + AF2_AU2(Const0.zw)) * AF2_AU2(Const1.xy) + AF2(0.5, -0.5) * AF2_AU2(Const1.zw);
-  OutputTexture[pos] = InputTexture.SampleLevel(samLinearClamp, pp, 0.0);
+  OutputTexture[dst] = InputTexture.SampleLevel(samLinearClamp, EASU_UV(pp), 0.0);
 #endif
 #if SAMPLE_EASU
   #if SAMPLE_SLOW_FALLBACK
@@ -87,14 +97,14 @@ void CurrFilter(int2 pos)
     #if SAMPLE_HDR_OUTPUT
       c *= c;
     #endif
-    OutputTexture[pos] = float4(c, 1);
+    OutputTexture[dst] = float4(c, 1);
   #else
     AH3 c;
     FsrEasuH(c, pos, Const0, Const1, Const2, Const3);
     #if SAMPLE_HDR_OUTPUT
       c *= c;
     #endif
-    OutputTexture[pos] = AH4(c, 1);
+    OutputTexture[dst] = AH4(c, 1);
   #endif
 #endif
 #if SAMPLE_RCAS
@@ -104,14 +114,14 @@ void CurrFilter(int2 pos)
     #if SAMPLE_HDR_OUTPUT
       c *= c;
     #endif
-    OutputTexture[pos] = float4(c, 1);
+    OutputTexture[dst] = float4(c, 1);
   #else
     AH3 c;
     FsrRcasH(c.r, c.g, c.b, pos, Const4);
     #if SAMPLE_HDR_OUTPUT
       c *= c;
     #endif
-    OutputTexture[pos] = AH4(c, 1);
+    OutputTexture[dst] = AH4(c, 1);
   #endif
 #endif
 }
@@ -120,6 +130,7 @@ void CurrFilter(int2 pos)
 void mainCS(uint3 LocalThreadId : SV_GroupThreadID, uint3 WorkGroupId : SV_GroupID, uint3 Dtid : SV_DispatchThreadID)
 {
   // Do remapping of local xy in workgroup for a more PS-like swizzle pattern.
+#if FSR_THREAD_GROUP_SIZE == 64
   AU2 gxy = ARmp8x8(LocalThreadId.x) + AU2(WorkGroupId.x << 4u, WorkGroupId.y << 4u);
   CurrFilter(gxy);
   gxy.x += 8u;
@@ -128,6 +139,15 @@ void mainCS(uint3 LocalThreadId : SV_GroupThreadID, uint3 WorkGroupId : SV_Group
   CurrFilter(gxy);
   gxy.x -= 8u;
   CurrFilter(gxy);
+#else
+  // Larger groups split the 16x16 region in 8x8 quadrants, with fewer pixels per thread.
+  const AU2 gxy = ARmp8x8(LocalThreadId.x & 63u) + AU2(WorkGroupId.x << 4u, WorkGroupId.y << 4u);
+  [unroll]
+  for (AU1 i = 0; i < 256u / FSR_THREAD_GROUP_SIZE; i++) {
+    const AU1 quadrant = (LocalThreadId.x >> 6u) + i * (FSR_THREAD_GROUP_SIZE / 64u);
+    CurrFilter(gxy + AU2(quadrant & 1u, quadrant >> 1u) * 8u);
+  }
+#endif
 }
 
 // clang-format on
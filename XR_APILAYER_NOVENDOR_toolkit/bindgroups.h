@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+namespace toolkit::graphics {
+
+    // A bind group is the immutable set of descriptors for a (shader, inputs, outputs) tuple. The descriptors are
+    // written once into a fixed-size slot of a descriptor heap, so that they can be bound with a single descriptor
+    // table per dispatch. We only keep weak references to the objects: a bind group whose objects were destroyed is
+    // stale. Its slot is recycled once the GPU has completed the last submission that used it.
+    //
+    // The cache does not know about the graphics API: the device provides the fence and writes the descriptors.
+    class BindGroupCache {
+      public:
+        using Key = std::vector<uintptr_t>;
+
+        struct BindGroup {
+            uint32_t slot;
+            std::vector<std::weak_ptr<void>> objects;
+            uint64_t lastUsedFenceValue;
+
+            bool isStale() const {
+                return std::any_of(objects.cbegin(), objects.cend(), [](const std::weak_ptr<void>& object) {
+                    return object.expired();
+                });
+            }
+        };
+
+        BindGroupCache(uint32_t numSlots,
+                       std::function<uint64_t()> getCompletedFenceValue,
+                       std::function<void(uint64_t)> waitForFence)
+            : m_numSlots(numSlots), m_getCompletedFenceValue(getCompletedFenceValue), m_waitForFence(waitForFence) {
+        }
+
+        // Return the bind group for the key, or create it and call writeDescriptors(slot) to fill its slot. The
+        // callback returns the objects referenced by the descriptors. The bind group is marked as used by the
+        // submission that completes with currentFenceValue: the caller must update lastUsedFenceValue if it uses the
+        // bind group again with a later submission. Returns nullptr when all the slots are used by that submission.
+        template <typename WriteDescriptors>
+        BindGroup* getOrCreate(const Key& key, uint64_t currentFenceValue, WriteDescriptors&& writeDescriptors) {
+            auto it = m_bindGroups.find(key);
+            if (it != m_bindGroups.end() && !it->second.isStale()) {
+                it->second.lastUsedFenceValue = currentFenceValue;
+                return &it->second;
+            }
+
+            const auto slot = allocateSlot(currentFenceValue);
+            if (!slot) {
+                return nullptr;
+            }
+
+            BindGroup bindGroup{slot.value(), writeDescriptors(slot.value()), currentFenceValue};
+            return &m_bindGroups.insert_or_assign(key, std::move(bindGroup)).first->second;
+        }
+
+        // Forget all bind groups. The caller must have waited for the GPU to be idle.
+        void clear() {
+            m_bindGroups.clear();
+            m_retiredSlots.clear();
+            m_nextSlot = 0;
+        }
+
+        size_t size() const {
+            return m_bindGroups.size();
+        }
+
+      private:
+        // Retire the bind groups matching the predicate. Their slots are recycled once the GPU is done with them.
+        template <typename Predicate>
+        void retire(Predicate predicate) {
+            for (auto it = m_bindGroups.begin(); it != m_bindGroups.end();) {
+                if (predicate(it->second)) {
+                    m_retiredSlots.push_back({it->second.lastUsedFenceValue, it->second.slot});
+                    it = m_bindGroups.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        std::optional<uint32_t> recycleSlot(uint64_t completedFenceValue) {
+            const auto it = std::find_if(m_retiredSlots.begin(), m_retiredSlots.end(), [&](const auto& retired) {
+                return retired.first <= completedFenceValue;
+            });
+            if (it == m_retiredSlots.end()) {
+                return {};
+            }
+            const auto slot = it->second;
+            m_retiredSlots.erase(it);
+            return slot;
+        }
+
+        std::optional<uint32_t> allocateSlot(uint64_t currentFenceValue) {
+            // Stale bind groups will never be used again.
+            retire([](const BindGroup& bindGroup) { return bindGroup.isStale(); });
+            if (const auto slot = recycleSlot(m_getCompletedFenceValue())) {
+                return slot;
+            }
+
+            if (m_nextSlot < m_numSlots) {
+                return m_nextSlot++;
+            }
+
+            // Out of slots: evict the bind groups that are not used by in-flight submissions. They will be recreated
+            // if needed.
+            const uint64_t completedFenceValue = m_getCompletedFenceValue();
+            retire([&](const BindGroup& bindGroup) { return bindGroup.lastUsedFenceValue <= completedFenceValue; });
+            if (const auto slot = recycleSlot(completedFenceValue)) {
+                return slot;
+            }
+
+            // Last resort: wait for the previous submissions to complete, and evict all the bind groups that are not
+            // used by the current one.
+            const uint64_t submittedFenceValue = currentFenceValue - 1;
+            m_waitForFence(submittedFenceValue);
+            retire([&](const BindGroup& bindGroup) { return bindGroup.lastUsedFenceValue <= submittedFenceValue; });
+            return recycleSlot(submittedFenceValue);
+        }
+
+        const uint32_t m_numSlots;
+        const std::function<uint64_t()> m_getCompletedFenceValue;
+        const std::function<void(uint64_t)> m_waitForFence;
+
+        std::map<Key, BindGroup> m_bindGroups;
+        uint32_t m_nextSlot{0};
+        std::deque<std::pair<uint64_t, uint32_t>> m_retiredSlots; // fence value, slot
+    };
+
+} // namespace toolkit::graphics
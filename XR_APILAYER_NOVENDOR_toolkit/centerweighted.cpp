@@ -0,0 +1,193 @@
+// MIT License
+//
+// Copyright(c) 2021 Matthieu Bucchianeri
+// Copyright(c) 2021-2022 Jean-Luc Dupiot - Reality XP
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "shader_utilities.h"
+#include "factories.h"
+#include "interfaces.h"
+#include "layer.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::config;
+    using namespace toolkit::graphics;
+    using namespace toolkit::utilities;
+    using namespace toolkit::log;
+
+    struct alignas(16) CenterWeightedConfig {
+        XrVector4f InputDims; // input w, h, 1/w, 1/h
+        XrVector4f Center;    // center.xy (ndc), radius, 1/falloff
+        XrVector4f Params;    // sharpness
+        XrVector4f InputRect; // offset.xy, scale.zw (normalized)
+    };
+
+    // Width of the transition between the full quality and the bilinear reconstruction, in NDC units.
+    constexpr float kCenterFalloff = 0.3f;
+
+    // The application renders with its regular (linear) projection at a lower resolution, and the pixel density is
+    // not changed. Since the lenses cannot resolve the finest details away from their center, only a disc around each
+    // projection center gets the more expensive Catmull-Rom reconstruction and sharpening, the rest is bilinear.
+    class CenterWeightedUpscaler : public ICenterWeightedUpscaler {
+      public:
+        CenterWeightedUpscaler(std::shared_ptr<IConfigManager> configManager,
+                               std::shared_ptr<IDevice> graphicsDevice,
+                               uint32_t renderWidth,
+                               uint32_t renderHeight)
+            : m_configManager(configManager), m_device(graphicsDevice), m_inputWidth(renderWidth),
+              m_inputHeight(renderHeight) {
+            createRenderResources();
+        }
+
+        void reload() override {
+            createRenderResources();
+        }
+
+        void update() override {
+            if (m_configManager->hasChanged(SettingSharpness) ||
+                m_configManager->hasChanged(SettingCenterWeightedRadius)) {
+                m_configUpdated = true;
+            }
+        }
+
+        void setViewProjectionCenters(XrVector2f left, XrVector2f right) override {
+            m_centers[0] = left;
+            m_centers[1] = right;
+            m_configUpdated = true;
+        }
+
+        void process(const std::shared_ptr<ITexture>& input,
+                     const std::shared_ptr<ITexture>& output,
+                     const ProcessingRegion& region) override {
+            const auto eye = std::min(to_integral(region.eye), ViewCount - 1);
+
+            // Only read the rectangle rendered by the application.
+            const auto& inputInfo = input->getInfo();
+            const Viewport viewport{region.inputRect, inputInfo.width, inputInfo.height};
+            if (memcmp(&viewport, &m_viewports[eye], sizeof(viewport))) {
+                m_viewports[eye] = viewport;
+                m_configUpdated = true;
+            }
+
+            if (m_configUpdated) {
+                updateConfig();
+                m_configUpdated = false;
+            }
+
+            m_device->setShader(m_shaders[input->isArray()], SamplerType::LinearClamp);
+            m_device->setShaderInput(0, m_cbParams[eye]);
+            m_device->setShaderInput(0, input, region.slice);
+            m_device->setShaderOutput(0, output, region.slice);
+            m_device->setViewport(region.outputRect);
+            m_device->dispatchShader();
+        }
+
+      private:
+        // The rectangle to read for a view and the dimensions of the texture it belongs to.
+        struct Viewport {
+            XrRect2Di input;
+            uint32_t inputWidth;
+            uint32_t inputHeight;
+        };
+
+        void createRenderResources() {
+            const auto shadersDir = dllHome / "shaders";
+            const auto shaderFile = shadersDir / "centerweighted.hlsl";
+
+            shader::Defines defines;
+            m_shaders[0] =
+                m_device->createQuadShader(shaderFile, "mainCenterWeighted", "Center-weighted PS", defines.get());
+
+            defines.add("VPRT", true);
+            m_shaders[1] = m_device->createQuadShader(
+                shaderFile, "mainCenterWeighted", "Center-weighted PS (VPRT)", defines.get());
+
+            for (auto& it : m_cbParams) {
+                it = m_device->createBuffer(sizeof(CenterWeightedConfig), "Center-weighted CB");
+            }
+
+            // Until the first frame, assume the application renders to the whole texture.
+            for (auto& viewport : m_viewports) {
+                if (!viewport.inputWidth) {
+                    viewport.input = {{0, 0},
+                                      {static_cast<int32_t>(m_inputWidth), static_cast<int32_t>(m_inputHeight)}};
+                    viewport.inputWidth = m_inputWidth;
+                    viewport.inputHeight = m_inputHeight;
+                }
+            }
+
+            updateConfig();
+        }
+
+        void updateConfig() {
+            CenterWeightedConfig config;
+            config.Params = {m_configManager->getValue(SettingSharpness) / 100.f, 0.f, 0.f, 0.f};
+
+            const auto radius = m_configManager->getValue(SettingCenterWeightedRadius) / 100.f;
+            for (size_t eye = 0; eye < std::size(m_cbParams); eye++) {
+                const auto& viewport = m_viewports[eye];
+                const auto inputWidth = viewport.inputWidth;
+                const auto inputHeight = viewport.inputHeight;
+                const auto& rect = viewport.input;
+
+                config.InputDims = {static_cast<float>(inputWidth),
+                                    static_cast<float>(inputHeight),
+                                    1.f / std::max(inputWidth, 1u),
+                                    1.f / std::max(inputHeight, 1u)};
+                config.InputRect = {static_cast<float>(rect.offset.x) / inputWidth,
+                                    static_cast<float>(rect.offset.y) / inputHeight,
+                                    static_cast<float>(rect.extent.width) / inputWidth,
+                                    static_cast<float>(rect.extent.height) / inputHeight};
+                config.Center = {m_centers[eye].x, m_centers[eye].y, radius, 1.f / kCenterFalloff};
+                m_cbParams[eye]->uploadData(&config, sizeof(config));
+            }
+        }
+
+        const std::shared_ptr<IConfigManager> m_configManager;
+        const std::shared_ptr<IDevice> m_device;
+        const uint32_t m_inputWidth;
+        const uint32_t m_inputHeight;
+
+        XrVector2f m_centers[ViewCount]{{0.f, 0.f}, {0.f, 0.f}};
+        Viewport m_viewports[ViewCount]{};
+        bool m_configUpdated{false};
+
+        std::shared_ptr<IQuadShader> m_shaders[2]; // non-vprt, vprt
+        std::shared_ptr<IShaderBuffer> m_cbParams[ViewCount];
+    };
+
+} // namespace
+
+namespace toolkit::graphics {
+
+    std::shared_ptr<ICenterWeightedUpscaler>
+    CreateCenterWeightedUpscaler(std::shared_ptr<IConfigManager> configManager,
+                                 std::shared_ptr<IDevice> graphicsDevice,
+                                 uint32_t renderWidth,
+                                 uint32_t renderHeight) {
+        return std::make_shared<CenterWeightedUpscaler>(configManager, graphicsDevice, renderWidth, renderHeight);
+    }
+
+} // namespace toolkit::graphics
@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright(c) 2021-2022 Matthieu Bucchianeri
+// Copyright(c) 2021-2022 Jean-Luc Dupiot - Reality XP
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// clang-format off
+
+cbuffer config : register(b0) {
+    float4 InputDims; // input w, h, 1/w, 1/h
+    float4 Center;    // center.xy (ndc), radius, 1/falloff
+    float4 Params;    // sharpness
+    float4 InputRect; // offset.xy, scale.zw (normalized)
+};
+
+SamplerState sourceSampler : register(s0);
+
+#ifdef VPRT
+Texture2DArray sourceTexture : register(t0);
+#define TEXTURE_SAMP(texcoord) sourceTexture.Sample(sourceSampler, float3((texcoord), 0))
+#else
+Texture2D sourceTexture : register(t0);
+#define TEXTURE_SAMP(texcoord) sourceTexture.Sample(sourceSampler, (texcoord))
+#endif
+
+// Catmull-Rom filter using 9 bilinear taps.
+float4 SampleCatmullRom(float2 texcoord) {
+    const float2 samplePos = texcoord * InputDims.xy;
+    const float2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    const float2 f = samplePos - texPos1;
+
+    const float2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    const float2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    const float2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    const float2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    const float2 w12 = w1 + w2;
+    const float2 uv0 = (texPos1 - 1) * InputDims.zw;
+    const float2 uv12 = (texPos1 + w2 / w12) * InputDims.zw;
+    const float2 uv3 = (texPos1 + 2) * InputDims.zw;
+
+    float4 color = 0;
+    color += TEXTURE_SAMP(float2(uv0.x,  uv0.y))  * w0.x  * w0.y;
+    color += TEXTURE_SAMP(float2(uv12.x, uv0.y))  * w12.x * w0.y;
+    color += TEXTURE_SAMP(float2(uv3.x,  uv0.y))  * w3.x  * w0.y;
+    color += TEXTURE_SAMP(float2(uv0.x,  uv12.y)) * w0.x  * w12.y;
+    color += TEXTURE_SAMP(float2(uv12.x, uv12.y)) * w12.x * w12.y;
+    color += TEXTURE_SAMP(float2(uv3.x,  uv12.y)) * w3.x  * w12.y;
+    color += TEXTURE_SAMP(float2(uv0.x,  uv3.y))  * w0.x  * w3.y;
+    color += TEXTURE_SAMP(float2(uv12.x, uv3.y))  * w12.x * w3.y;
+    color += TEXTURE_SAMP(float2(uv3.x,  uv3.y))  * w3.x  * w3.y;
+    return color;
+}
+
+float4 mainCenterWeighted(in float4 position : SV_POSITION, in float2 texcoord : TEXCOORD0) : SV_TARGET {
+    const float2 uv = InputRect.xy + texcoord * InputRect.zw;
+    const float4 color = TEXTURE_SAMP(uv);
+
+    // Sharper reconstruction near the projection center, where the lens resolves the most detail, fading out over the
+    // falloff band.
+    const float2 ndc = float2(texcoord.x * 2 - 1, 1 - texcoord.y * 2);
+    const float weight = saturate((Center.z - distance(ndc, Center.xy)) * Center.w + 1);
+
+    [branch]
+    if (weight > 0) {
+        const float4 sharp = SampleCatmullRom(uv);
+        return lerp(color, max(sharp + (sharp - color) * Params.x, 0), weight);
+    }
+
+    return color;
+}
@@ -0,0 +1,148 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::utilities;
+    using namespace toolkit::log;
+
+    // The share of the frame time that each feature may use. These are several times the typical costs, in order to
+    // only catch a feature that misbehaves (eg: an unexpected resolution or a driver issue).
+    constexpr float Budgets[to_integral(GuardedFeature::MaxValue)] = {
+        0.4f,  // Upscaling
+        0.25f, // PostProcess
+        0.f,   // VariableRateShading (not timed)
+        0.25f, // HandTracking
+    };
+
+    constexpr const char* FeatureNames[to_integral(GuardedFeature::MaxValue)] = {
+        "Upscaling",
+        "Post-processing",
+        "Foveated rendering",
+        "Hand tracking",
+    };
+
+    // Consecutive seconds over budget before tripping.
+    constexpr uint32_t MaxStrikes = 5;
+
+    // Number of exceptions before tripping.
+    constexpr uint32_t MaxFaults = 3;
+
+    class CircuitBreaker : public ICircuitBreaker {
+      public:
+        bool reportCost(GuardedFeature feature, uint64_t costUs, uint64_t frameTimeUs) override {
+            std::unique_lock lock(m_mutex);
+
+            auto& state = m_states[to_integral(feature)];
+            const auto budgetUs = static_cast<uint64_t>(Budgets[to_integral(feature)] * frameTimeUs);
+            if (state.isTripped || !budgetUs) {
+                return false;
+            }
+
+            if (costUs <= budgetUs) {
+                state.numStrikes = 0;
+                return false;
+            }
+
+            if (++state.numStrikes < MaxStrikes) {
+                return false;
+            }
+
+            Log("%s exceeded its budget for %u seconds (%lluus out of %lluus per frame)\n",
+                FeatureNames[to_integral(feature)],
+                MaxStrikes,
+                costUs,
+                frameTimeUs);
+            return trip(feature);
+        }
+
+        bool reportFault(GuardedFeature feature, const char* what) override {
+            std::unique_lock lock(m_mutex);
+
+            auto& state = m_states[to_integral(feature)];
+            if (state.isTripped) {
+                return false;
+            }
+
+            Log("%s faulted: %s\n", FeatureNames[to_integral(feature)], what);
+            if (++state.numFaults < MaxFaults) {
+                return false;
+            }
+
+            return trip(feature);
+        }
+
+        bool isTripped(GuardedFeature feature) const override {
+            std::unique_lock lock(m_mutex);
+
+            return m_states[to_integral(feature)].isTripped;
+        }
+
+        uint32_t getTrippedFeatures() const override {
+            std::unique_lock lock(m_mutex);
+
+            uint32_t tripped = 0;
+            for (uint32_t i = 0; i < std::size(m_states); i++) {
+                if (m_states[i].isTripped) {
+                    tripped |= 1u << i;
+                }
+            }
+            return tripped;
+        }
+
+      private:
+        bool trip(GuardedFeature feature) {
+            m_states[to_integral(feature)].isTripped = true;
+
+            Log("%s is degraded for the remainder of the session\n", FeatureNames[to_integral(feature)]);
+            TraceLoggingWrite(g_traceProvider, "CircuitBreaker_Trip", TLArg(to_integral(feature), "Feature"));
+
+            return true;
+        }
+
+        struct FeatureState {
+            uint32_t numStrikes{0};
+            uint32_t numFaults{0};
+            bool isTripped{false};
+        };
+
+        // Faults can be reported from the application's threads (eg: from the hooks).
+        mutable std::mutex m_mutex;
+        FeatureState m_states[to_integral(GuardedFeature::MaxValue)];
+    };
+
+} // namespace
+
+namespace toolkit::utilities {
+
+    std::shared_ptr<ICircuitBreaker> CreateCircuitBreaker() {
+        return std::make_shared<CircuitBreaker>();
+    }
+
+} // namespace toolkit::utilities
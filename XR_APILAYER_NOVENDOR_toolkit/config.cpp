@@ -36,6 +36,34 @@ namespace {
 
     constexpr unsigned int WriteDelay = 22; // 1s in bad VR.
 
+    // Settings that are not part of a profile (they are about the layer itself rather than the rendering).
+    const std::set<std::string> NonProfileSettings = {SettingFirstRun,
+                                                      SettingDeveloper,
+                                                      SettingReloadShaders,
+                                                      SettingScreenshotEnabled,
+                                                      SettingScreenshotFileFormat,
+                                                      SettingScreenshotEye,
+                                                      SettingScreenshotKey,
+                                                      SettingKeyCtrlModifier,
+                                                      SettingKeyAltModifier,
+                                                      SettingMenuKeyUp,
+                                                      SettingMenuKeyDown,
+                                                      SettingMenuKeyLeft,
+                                                      SettingMenuKeyRight,
+                                                      SettingProfileKey,
+                                                      SettingProfileCadence,
+                                                      SettingMenuEyeVisibility,
+                                                      SettingMenuEyeOffset,
+                                                      SettingMenuDistance,
+                                                      SettingMenuOpacity,
+                                                      SettingMenuLegacyMode,
+                                                      SettingOverlayType,
+                                                      SettingOverlayXOffset,
+                                                      SettingOverlayYOffset,
+                                                      SettingMenuFontSize,
+                                                      SettingMenuTimeout,
+                                                      SettingMenuExpert};
+
     struct ConfigValue {
         int value;
         int defaultValue{0};
@@ -86,7 +114,8 @@ namespace {
                 const std::string& name = value.first;
                 ConfigValue& entry = value.second;
 
-                if (m_needRefresh && !m_ignoreRefresh.count(name)) {
+                // Do not overwrite the values of an applied profile. The refresh will happen upon reverting it.
+                if (m_needRefresh && !m_isProfileApplied && !m_ignoreRefresh.count(name)) {
                     refreshValue(name, entry);
                 }
 
@@ -106,7 +135,7 @@ namespace {
             }
 
             // Only clear the need for refresh if the whole tick update saw the changes.
-            m_needRefresh = m_wasNeedRefresh != m_needRefresh;
+            m_needRefresh = m_isProfileApplied ? m_needRefresh : m_wasNeedRefresh != m_needRefresh;
             if (!m_needRefresh) {
                 m_ignoreRefresh.clear();
             }
@@ -198,7 +227,74 @@ namespace {
             return m_safeMode;
         }
 
+        void saveProfile(const std::string& profile) override {
+            const std::wstring profileKey = getProfileKey(profile);
+            for (const auto& value : m_values) {
+                const std::string& name = value.first;
+                if (NonProfileSettings.count(name)) {
+                    continue;
+                }
+
+                RegSetDword(HKEY_CURRENT_USER, profileKey, std::wstring(name.begin(), name.end()), value.second.value);
+            }
+            RegSetDword(HKEY_CURRENT_USER, profileKey, L"saved", 1);
+
+            TraceLoggingWrite(g_traceProvider, "Config_SaveProfile", TLArg(profile.c_str(), "Profile"));
+        }
+
+        bool hasProfile(const std::string& profile) const override {
+            return RegGetDword(HKEY_CURRENT_USER, getProfileKey(profile), L"saved").value_or(0);
+        }
+
+        std::vector<std::string> applyProfile(const std::string& profile) override {
+            std::vector<std::string> changed;
+
+            const std::wstring profileKey = getProfileKey(profile);
+            for (auto& value : m_values) {
+                const std::string& name = value.first;
+                ConfigValue& entry = value.second;
+                if (NonProfileSettings.count(name)) {
+                    continue;
+                }
+
+                const auto profileValue =
+                    RegGetDword(HKEY_CURRENT_USER, profileKey, std::wstring(name.begin(), name.end()));
+                if (profileValue && profileValue.value() != entry.value) {
+                    entry.value = profileValue.value();
+                    entry.changedSinceLastQuery = true;
+
+                    // The profile is only applied in memory.
+                    entry.writeCountdown = 0;
+
+                    changed.push_back(name);
+                }
+            }
+            m_isProfileApplied = true;
+
+            TraceLoggingWrite(g_traceProvider,
+                              "Config_ApplyProfile",
+                              TLArg(profile.c_str(), "Profile"),
+                              TLArg(changed.size(), "NumChanged"));
+
+            return changed;
+        }
+
+        void revertProfile() override {
+            if (!m_isProfileApplied) {
+                return;
+            }
+
+            for (auto& value : m_values) {
+                refreshValue(value.first, value.second);
+            }
+            m_isProfileApplied = false;
+
+            TraceLoggingWrite(g_traceProvider, "Config_RevertProfile");
+        }
+
         void hardReset() override {
+            RegDeleteKey(HKEY_CURRENT_USER, getProfileKey(ProfileA));
+            RegDeleteKey(HKEY_CURRENT_USER, getProfileKey(ProfileB));
             RegDeleteKey(HKEY_CURRENT_USER, m_baseKey);
             for (auto& value : m_values) {
                 ConfigValue& entry = value.second;
@@ -210,6 +306,10 @@ namespace {
         }
 
       private:
+        std::wstring getProfileKey(const std::string& profile) const {
+            return m_baseKey + L"\\profile_" + std::wstring(profile.begin(), profile.end());
+        }
+
         std::optional<int> readRegistry(const std::string& name) const {
             auto value = RegGetDword(HKEY_CURRENT_USER, m_baseKey, std::wstring(name.begin(), name.end()));
             if (!value) {
@@ -263,6 +363,7 @@ namespace {
         wil::unique_registry_watcher m_watcher;
         bool m_needRefresh{false};
         std::set<std::string> m_ignoreRefresh;
+        bool m_isProfileApplied{false};
 
         mutable std::map<std::string, ConfigValue> m_values;
     };
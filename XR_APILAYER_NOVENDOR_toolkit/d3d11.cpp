@@ -513,7 +513,7 @@ namespace {
                 0);
         }
 
-        void copyTo(std::shared_ptr<ITexture> destination) const override {
+        void copyTo(const std::shared_ptr<ITexture>& destination) const override {
             m_device->getContextAs<D3D11>()->CopySubresourceRegion(
                 destination->getAs<D3D11>(), 0, 0, 0, 0, m_texture.Get(), 0, nullptr);
         }
@@ -844,6 +844,16 @@ namespace {
 
                 m_gpuArchitecture = graphics::GetGpuArchitecture(desc.VendorId);
 
+                LARGE_INTEGER driverVersion{};
+                adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+                m_driverIdentifier = fmt::format("{:04x}-{:04x}-{}.{}.{}.{}",
+                                                 desc.VendorId,
+                                                 desc.DeviceId,
+                                                 HIWORD(driverVersion.HighPart),
+                                                 LOWORD(driverVersion.HighPart),
+                                                 HIWORD(driverVersion.LowPart),
+                                                 LOWORD(driverVersion.LowPart));
+
                 if (!textOnly) {
                     // Log the adapter name to help debugging customer issues.
                     Log("Using Direct3D 11 on adapter: %s\n", m_deviceName.c_str());
@@ -886,6 +896,7 @@ namespace {
             m_currentDrawRenderTarget.reset();
             m_currentDrawDepthBuffer.reset();
             m_currentMesh.reset();
+            m_wrappedImmediateContext.reset();
 
             m_meshModelBuffer.reset();
             m_meshViewProjectionBuffer.reset();
@@ -899,6 +910,10 @@ namespace {
             return m_deviceName;
         }
 
+        const std::string& getDriverIdentifier() const override {
+            return m_driverIdentifier;
+        }
+
         GpuArchitecture GetGpuArchitecture() const override {
             return m_gpuArchitecture;
         }
@@ -1128,7 +1143,11 @@ namespace {
             return std::make_shared<D3D11GpuTimer>(shared_from_this());
         }
 
-        void setShader(std::shared_ptr<IQuadShader> shader, SamplerType sampler) override {
+        void deferRelease(std::shared_ptr<void> object) override {
+            // Direct3D 11 already keeps the resources used by the GPU alive until it is done with them.
+        }
+
+        void setShader(const std::shared_ptr<IQuadShader>& shader, SamplerType sampler) override {
             m_currentQuadShader.reset();
             m_currentComputeShader.reset();
             m_currentShaderHighestSRV = m_currentShaderHighestUAV = m_currentShaderHighestRTV = 0;
@@ -1152,7 +1171,7 @@ namespace {
             }
         }
 
-        void setShader(std::shared_ptr<IComputeShader> shader, SamplerType sampler) override {
+        void setShader(const std::shared_ptr<IComputeShader>& shader, SamplerType sampler) override {
             m_currentQuadShader.reset();
             m_currentComputeShader.reset();
             m_currentShaderHighestSRV = m_currentShaderHighestUAV = m_currentShaderHighestRTV = 0;
@@ -1167,7 +1186,7 @@ namespace {
             }
         }
 
-        void setShaderInput(uint32_t slot, std::shared_ptr<ITexture> input, int32_t slice) override {
+        void setShaderInput(uint32_t slot, const std::shared_ptr<ITexture>& input, int32_t slice) override {
             ID3D11ShaderResourceView* const shaderResourceViews[] = {
                 input->getShaderResourceView(slice)->getAs<D3D11>()};
             if (m_currentQuadShader) {
@@ -1180,7 +1199,7 @@ namespace {
             m_currentShaderHighestSRV = std::max(m_currentShaderHighestSRV, slot);
         }
 
-        void setShaderInput(uint32_t slot, std::shared_ptr<IShaderBuffer> input) override {
+        void setShaderInput(uint32_t slot, const std::shared_ptr<IShaderBuffer>& input) override {
             ID3D11Buffer* const constantBuffers[] = {input->getAs<D3D11>()};
             if (m_currentQuadShader) {
                 m_context->PSSetConstantBuffers(slot, ARRAYSIZE(constantBuffers), constantBuffers);
@@ -1191,7 +1210,7 @@ namespace {
             }
         }
 
-        void setShaderOutput(uint32_t slot, std::shared_ptr<ITexture> output, int32_t slice) override {
+        void setShaderOutput(uint32_t slot, const std::shared_ptr<ITexture>& output, int32_t slice) override {
             if (m_currentQuadShader) {
                 if (slot) {
                     throw std::runtime_error("Only use slot 0 for IQuadShader");
@@ -1214,7 +1233,7 @@ namespace {
             }
         }
 
-        void dispatchShader(bool doNotClear) const override {
+        void dispatchShader(bool doNotClear) override {
             if (m_currentQuadShader) {
                 m_context->Draw(3, 0);
             } else if (m_currentComputeShader) {
@@ -1261,10 +1280,21 @@ namespace {
             m_currentMesh.reset();
         }
 
+        void setViewport(const XrRect2Di& viewport) override {
+            D3D11_VIEWPORT d3dViewport;
+            ZeroMemory(&d3dViewport, sizeof(d3dViewport));
+            d3dViewport.TopLeftX = (float)viewport.offset.x;
+            d3dViewport.TopLeftY = (float)viewport.offset.y;
+            d3dViewport.Width = (float)viewport.extent.width;
+            d3dViewport.Height = (float)viewport.extent.height;
+            d3dViewport.MaxDepth = 1.0f;
+            m_context->RSSetViewports(1, &d3dViewport);
+        }
+
         void setRenderTargets(size_t numRenderTargets,
                               const std::shared_ptr<ITexture>* renderTargets,
                               int32_t* renderSlices = nullptr,
-                              std::shared_ptr<ITexture> depthBuffer = nullptr,
+                              const std::shared_ptr<ITexture>& depthBuffer = nullptr,
                               int32_t depthSlice = -1) override {
             assert(renderTargets || !numRenderTargets);
             assert(depthBuffer || depthSlice < 0);
@@ -1287,7 +1317,7 @@ namespace {
             if (numRenderTargets) {
                 m_currentDrawRenderTarget = renderTargets[0];
                 m_currentDrawRenderTargetSlice = renderSlices ? renderSlices[0] : -1;
-                m_currentDrawDepthBuffer = std::move(depthBuffer);
+                m_currentDrawDepthBuffer = depthBuffer;
                 m_currentDrawDepthBufferSlice = depthSlice;
 
                 D3D11_VIEWPORT viewport;
@@ -1349,7 +1379,7 @@ namespace {
                 view.NearFar.Near > view.NearFar.Far ? get(m_reversedZDepthNoStencilTest) : nullptr, 0);
         }
 
-        void draw(std::shared_ptr<ISimpleMesh> mesh, const XrPosef& pose, XrVector3f scaling) override {
+        void draw(const std::shared_ptr<ISimpleMesh>& mesh, const XrPosef& pose, XrVector3f scaling) override {
             if (auto meshData = mesh->getAs<D3D11>()) {
                 if (mesh != m_currentMesh) {
                     if (!m_meshModelBuffer) {
@@ -1452,6 +1482,33 @@ namespace {
             m_mipMapBias = bias;
         }
 
+        void setMipMapBiasPassActive(const std::shared_ptr<IContext>& context, bool active) override {
+            auto d3d11Context = context->getAs<D3D11>();
+            {
+                // Deferred contexts are recorded concurrently, each with their own passes.
+                std::unique_lock lock(m_samplersLock);
+                auto& isActive = m_isMipMapBiasPassActive.try_emplace(d3d11Context, true).first->second;
+                if (isActive == active) {
+                    return;
+                }
+                isActive = active;
+            }
+
+            if (m_mipMapBiasingType == config::MipMapBias::Off) {
+                return;
+            }
+
+            // Re-issue the samplers currently bound so that they are swapped with (or back from) their biased twins.
+            ID3D11SamplerState* samplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT]{};
+            d3d11Context->PSGetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, samplers);
+            d3d11Context->PSSetSamplers(0, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, samplers);
+            for (auto sampler : samplers) {
+                if (sampler) {
+                    sampler->Release();
+                }
+            }
+        }
+
         uint32_t getNumBiasedSamplersThisFrame() const override {
             return std::exchange(m_numBiasedSamplersThisFrame, 0);
         }
@@ -1479,6 +1536,18 @@ namespace {
             m_copyTextureEvent = event;
         }
 
+        void registerCloseContextEvent(CloseContextEvent event) override {
+            m_closeContextEvent = event;
+        }
+
+        void registerExecuteContextsEvent(ExecuteContextsEvent event) override {
+            m_executeContextsEvent = event;
+        }
+
+        void registerSetShadingRateEvent(SetShadingRateEvent event) override {
+            // The D3D11 applications program VRS through NVAPI, which we do not intercept.
+        }
+
         bool isEventsSupported() const override {
             return m_allowInterceptor;
         }
@@ -1533,6 +1602,44 @@ namespace {
                                10,
                                hooked_ID3D11DeviceContext_PSSetSamplers,
                                g_original_ID3D11DeviceContext_PSSetSamplers);
+            DetourMethodAttach(get(m_context),
+                               // Method offset is 7 + method index (0-based) for ID3D11DeviceContext.
+                               58,
+                               hooked_ID3D11DeviceContext_ExecuteCommandList,
+                               g_original_ID3D11DeviceContext_ExecuteCommandList);
+
+            // Hook to the Direct3D device to intercept the deferred contexts used by multithreaded engines.
+            DetourMethodAttach(get(m_device),
+                               // Method offset is 3 + method index (0-based) for ID3D11Device.
+                               27,
+                               hooked_ID3D11Device_CreateDeferredContext,
+                               g_original_ID3D11Device_CreateDeferredContext);
+
+            // The deferred contexts may also be created through the newer versions of the device interface.
+            ComPtr<ID3D11Device1> device1;
+            if (SUCCEEDED(m_device->QueryInterface(set(device1)))) {
+                DetourMethodAttach(get(device1),
+                                   // Method offset is 43 + method index (0-based) for ID3D11Device1.
+                                   44,
+                                   hooked_ID3D11Device1_CreateDeferredContext1,
+                                   g_original_ID3D11Device1_CreateDeferredContext1);
+            }
+            ComPtr<ID3D11Device2> device2;
+            if (SUCCEEDED(m_device->QueryInterface(set(device2)))) {
+                DetourMethodAttach(get(device2),
+                                   // Method offset is 50 + method index (0-based) for ID3D11Device2.
+                                   51,
+                                   hooked_ID3D11Device2_CreateDeferredContext2,
+                                   g_original_ID3D11Device2_CreateDeferredContext2);
+            }
+            ComPtr<ID3D11Device3> device3;
+            if (SUCCEEDED(m_device->QueryInterface(set(device3)))) {
+                DetourMethodAttach(get(device3),
+                                   // Method offset is 54 + method index (0-based) for ID3D11Device3.
+                                   62,
+                                   hooked_ID3D11Device3_CreateDeferredContext3,
+                                   g_original_ID3D11Device3_CreateDeferredContext3);
+            }
         }
 
         void uninitializeInterceptor() {
@@ -1561,6 +1668,85 @@ namespace {
                                10,
                                hooked_ID3D11DeviceContext_PSSetSamplers,
                                g_original_ID3D11DeviceContext_PSSetSamplers);
+            DetourMethodDetach(get(m_context),
+                               // Method offset is 7 + method index (0-based) for ID3D11DeviceContext.
+                               58,
+                               hooked_ID3D11DeviceContext_ExecuteCommandList,
+                               g_original_ID3D11DeviceContext_ExecuteCommandList);
+            DetourMethodDetach(get(m_device),
+                               // Method offset is 3 + method index (0-based) for ID3D11Device.
+                               27,
+                               hooked_ID3D11Device_CreateDeferredContext,
+                               g_original_ID3D11Device_CreateDeferredContext);
+            ComPtr<ID3D11Device1> device1;
+            if (SUCCEEDED(m_device->QueryInterface(set(device1)))) {
+                DetourMethodDetach(get(device1),
+                                   // Method offset is 43 + method index (0-based) for ID3D11Device1.
+                                   44,
+                                   hooked_ID3D11Device1_CreateDeferredContext1,
+                                   g_original_ID3D11Device1_CreateDeferredContext1);
+            }
+            ComPtr<ID3D11Device2> device2;
+            if (SUCCEEDED(m_device->QueryInterface(set(device2)))) {
+                DetourMethodDetach(get(device2),
+                                   // Method offset is 50 + method index (0-based) for ID3D11Device2.
+                                   51,
+                                   hooked_ID3D11Device2_CreateDeferredContext2,
+                                   g_original_ID3D11Device2_CreateDeferredContext2);
+            }
+            ComPtr<ID3D11Device3> device3;
+            if (SUCCEEDED(m_device->QueryInterface(set(device3)))) {
+                DetourMethodDetach(get(device3),
+                                   // Method offset is 54 + method index (0-based) for ID3D11Device3.
+                                   62,
+                                   hooked_ID3D11Device3_CreateDeferredContext3,
+                                   g_original_ID3D11Device3_CreateDeferredContext3);
+            }
+
+            // The deferred contexts methods were hooked through their own vtable, which the detach does not need.
+#define UNHOOK_DEFERRED_METHOD(offset, method)                                                                         \
+    DetourMethodDetach(get(m_context),                                                                                 \
+                       offset,                                                                                         \
+                       hooked_ID3D11DeviceContext_Deferred_##method,                                                   \
+                       g_original_ID3D11DeviceContext_Deferred_##method);
+
+            UNHOOK_DEFERRED_METHOD(33, OMSetRenderTargets);
+            UNHOOK_DEFERRED_METHOD(34, OMSetRenderTargetsAndUnorderedAccessViews);
+            UNHOOK_DEFERRED_METHOD(47, CopyResource);
+            UNHOOK_DEFERRED_METHOD(46, CopySubresourceRegion);
+            UNHOOK_DEFERRED_METHOD(10, PSSetSamplers);
+
+#undef UNHOOK_DEFERRED_METHOD
+
+            DetourMethodDetach(get(m_context),
+                               // Method offset is 7 + method index (0-based) for ID3D11DeviceContext.
+                               114,
+                               hooked_ID3D11DeviceContext_FinishCommandList,
+                               g_original_ID3D11DeviceContext_FinishCommandList);
+
+            // The samplers of the application may outlive us.
+            {
+                std::unique_lock lock(m_samplersLock);
+                for (const auto& [biasedSampler, origin] : m_biasedSamplerOrigins) {
+                    ComPtr<ID3DDestructionNotifier> notifier;
+                    if (SUCCEEDED(origin.sampler->QueryInterface(set(notifier)))) {
+                        notifier->UnregisterDestructionCallback(origin.destructionCallbackId);
+                    }
+                }
+                m_biasedSamplerOrigins.clear();
+            }
+
+            // The command lists of the application may outlive us.
+            {
+                std::unique_lock lock(m_deferredContextsLock);
+                for (const auto& [commandList, commandListContext] : m_commandListContexts) {
+                    ComPtr<ID3DDestructionNotifier> notifier;
+                    if (SUCCEEDED(commandList->QueryInterface(set(notifier)))) {
+                        notifier->UnregisterDestructionCallback(commandListContext.destructionCallbackId);
+                    }
+                }
+                m_commandListContexts.clear();
+            }
 
             g_instance = nullptr;
         }
@@ -1716,14 +1902,11 @@ namespace {
                 return;
             }
 
-            ComPtr<ID3D11Device> device;
-            context->GetDevice(set(device));
-            if (device != m_device) {
+            const auto& wrappedContext = getWrappedContext(context);
+            if (!wrappedContext) {
                 return;
             }
 
-            auto wrappedContext = std::make_shared<D3D11Context>(shared_from_this(), context);
-
             if (!numViews || !renderTargetViews[0]) {
                 INVOKE_EVENT(unsetRenderTargetEvent, wrappedContext);
                 return;
@@ -1755,7 +1938,7 @@ namespace {
 
             auto renderTarget = std::make_shared<D3D11Texture>(
                 shared_from_this(), getTextureInfo(textureDesc), textureDesc, get(texture));
-            INVOKE_EVENT(setRenderTargetEvent, wrappedContext, renderTarget);
+            INVOKE_EVENT(setRenderTargetEvent, wrappedContext, renderTarget, depthStencilView != nullptr);
         }
 
         void onCopyResource(ID3D11DeviceContext* context,
@@ -1767,9 +1950,8 @@ namespace {
                 return;
             }
 
-            ComPtr<ID3D11Device> device;
-            context->GetDevice(set(device));
-            if (device != m_device) {
+            const auto& wrappedContext = getWrappedContext(context);
+            if (!wrappedContext) {
                 return;
             }
 
@@ -1783,8 +1965,6 @@ namespace {
                 return;
             }
 
-            auto wrappedContext = std::make_shared<D3D11Context>(shared_from_this(), context);
-
             D3D11_TEXTURE2D_DESC sourceTextureDesc;
             sourceTexture->GetDesc(&sourceTextureDesc);
 
@@ -1804,6 +1984,113 @@ namespace {
 
 #undef INVOKE_EVENT
 
+        // Return the wrapper for the context passed to our hooks, or nullptr if the context is not on our device.
+        // The wrapper for our immediate context is created once, since it is by far the most frequently seen. Deferred
+        // contexts are used from several threads, so they get their own wrapper.
+        std::shared_ptr<IContext> getWrappedContext(ID3D11DeviceContext* context) {
+            if (context == get(m_context)) {
+                if (!m_wrappedImmediateContext) {
+                    m_wrappedImmediateContext = std::make_shared<D3D11Context>(shared_from_this(), context);
+                }
+                return m_wrappedImmediateContext;
+            }
+
+            ComPtr<ID3D11Device> device;
+            context->GetDevice(set(device));
+            if (device != m_device) {
+                return nullptr;
+            }
+
+            return std::make_shared<D3D11Context>(shared_from_this(), context);
+        }
+
+        // Deferred contexts may use different implementations of the methods we hook on the immediate context.
+        void hookDeferredContext(ID3D11DeviceContext* context) {
+            std::unique_lock lock(m_deferredContextsLock);
+
+            LPVOID* immediateVtable = *((LPVOID**)get(m_context));
+            LPVOID* deferredVtable = *((LPVOID**)context);
+
+#define HOOK_DEFERRED_METHOD(offset, method)                                                                           \
+    if (deferredVtable[offset] != immediateVtable[offset]) {                                                           \
+        DetourMethodAttach(context,                                                                                    \
+                           offset,                                                                                     \
+                           hooked_ID3D11DeviceContext_Deferred_##method,                                               \
+                           g_original_ID3D11DeviceContext_Deferred_##method);                                          \
+    }
+
+            // Method offset is 7 + method index (0-based) for ID3D11DeviceContext.
+            HOOK_DEFERRED_METHOD(33, OMSetRenderTargets);
+            HOOK_DEFERRED_METHOD(34, OMSetRenderTargetsAndUnorderedAccessViews);
+            HOOK_DEFERRED_METHOD(47, CopyResource);
+            HOOK_DEFERRED_METHOD(46, CopySubresourceRegion);
+            HOOK_DEFERRED_METHOD(10, PSSetSamplers);
+
+#undef HOOK_DEFERRED_METHOD
+
+            DetourMethodAttach(context,
+                               // Method offset is 7 + method index (0-based) for ID3D11DeviceContext.
+                               114,
+                               hooked_ID3D11DeviceContext_FinishCommandList,
+                               g_original_ID3D11DeviceContext_FinishCommandList);
+        }
+
+        void onFinishCommandList(ID3D11DeviceContext* context) {
+            // The state of the deferred context is reset after recording.
+            {
+                std::unique_lock lock(m_samplersLock);
+                m_isMipMapBiasPassActive.erase(context);
+            }
+
+            // Not subject to blocking: the state recorded into the command list must always be closed.
+            if (m_closeContextEvent) {
+                if (auto wrappedContext = getWrappedContext(context)) {
+                    m_closeContextEvent(wrappedContext);
+                }
+            }
+        }
+
+        void onDeferredContextCreated(ID3D11Device* device, ID3D11DeviceContext* context) {
+            if (device == get(m_device)) {
+                hookDeferredContext(context);
+            }
+        }
+
+        void onCommandListFinished(ID3D11DeviceContext* context, ID3D11CommandList* commandList) {
+            // A command list may be executed several times: we forget about it once the application releases it.
+            CommandListContext commandListContext{context, 0};
+            ComPtr<ID3DDestructionNotifier> notifier;
+            if (FAILED(commandList->QueryInterface(set(notifier))) ||
+                FAILED(notifier->RegisterDestructionCallback(
+                    onCommandListDestroyed, commandList, &commandListContext.destructionCallbackId))) {
+                // We cannot track the lifetime of this command list: do not attribute it to its deferred context.
+                return;
+            }
+
+            std::unique_lock lock(m_deferredContextsLock);
+            m_commandListContexts.insert_or_assign(commandList, commandListContext);
+        }
+
+        void onExecuteCommandList(ID3D11DeviceContext* context, ID3D11CommandList* commandList) {
+            if (context != get(m_context)) {
+                return;
+            }
+
+            const void* deferredContext;
+            {
+                std::unique_lock lock(m_deferredContextsLock);
+                auto it = m_commandListContexts.find(commandList);
+                if (it == m_commandListContexts.end()) {
+                    return;
+                }
+                deferredContext = it->second.context;
+            }
+
+            if (m_executeContextsEvent) {
+                m_executeContextsEvent({deferredContext});
+            }
+        }
+
         void patchSamplers(ID3D11DeviceContext* context, ID3D11SamplerState** samplers, size_t numSamplers) {
             if (m_blockEvents || m_mipMapBiasingType == config::MipMapBias::Off) {
                 return;
@@ -1815,11 +2102,30 @@ namespace {
                 return;
             }
 
+            std::unique_lock lock(m_samplersLock);
+
+            const auto passIt = m_isMipMapBiasPassActive.find(context);
+            const bool isPassActive = passIt == m_isMipMapBiasPassActive.cend() || passIt->second;
+
             for (size_t i = 0; i < numSamplers; i++) {
                 if (!samplers[i]) {
                     continue;
                 }
 
+                // Handle samplers that we have biased before (eg: when re-issued with PSGetSamplers()).
+                const auto it = m_biasedSamplerOrigins.find(samplers[i]);
+                if (it != m_biasedSamplerOrigins.cend()) {
+                    if (!isPassActive) {
+                        samplers[i] = it->second.sampler;
+                    }
+                    continue;
+                }
+
+                // Only bias the passes rendering the eye views.
+                if (!isPassActive) {
+                    continue;
+                }
+
                 bool needUpdate = false;
 
                 // Retrieve any previously biased sampler.
@@ -1854,8 +2160,35 @@ namespace {
                         // Allow negative LOD.
                         desc.MinLOD -= std::ceilf(m_mipMapBias);
 
-                        CHECK_HRCMD(m_device->CreateSamplerState(&desc, set(biasedSampler)));
+                        ComPtr<ID3D11SamplerState> newBiasedSampler;
+                        const HRESULT hr = m_device->CreateSamplerState(&desc, set(newBiasedSampler));
+                        if (FAILED(hr)) {
+                            // Do not fail the application's call, eg: when it reaches the limit of sampler states.
+                            Log("Failed to create biased sampler: %d\n", hr);
+                            continue;
+                        }
+
+                        // The origin keeps its biased twin alive through its private data. We only keep a non-owning
+                        // reference to the origin, and we forget about it when the origin is destroyed.
+                        BiasedSamplerOrigin origin{samplers[i], 0};
+                        const auto previousIt = biasedSampler ? m_biasedSamplerOrigins.find(get(biasedSampler))
+                                                              : m_biasedSamplerOrigins.end();
+                        if (previousIt != m_biasedSamplerOrigins.end()) {
+                            origin = previousIt->second;
+                            m_biasedSamplerOrigins.erase(previousIt);
+                        } else {
+                            ComPtr<ID3DDestructionNotifier> notifier;
+                            if (FAILED(samplers[i]->QueryInterface(set(notifier))) ||
+                                FAILED(notifier->RegisterDestructionCallback(
+                                    onBiasedSamplerOriginDestroyed, samplers[i], &origin.destructionCallbackId))) {
+                                // We cannot track the lifetime of this sampler: leave it unbiased.
+                                continue;
+                            }
+                        }
+
+                        biasedSampler = std::move(newBiasedSampler);
                         samplers[i]->SetPrivateDataInterface(__uuidof(ID3D11SamplerState), get(biasedSampler));
+                        m_biasedSamplerOrigins.insert_or_assign(get(biasedSampler), origin);
                     }
                 }
 
@@ -1868,8 +2201,16 @@ namespace {
 
         const ComPtr<ID3D11Device> m_device;
         ComPtr<ID3D11DeviceContext> m_context;
+        std::shared_ptr<IContext> m_wrappedImmediateContext;
+        std::mutex m_deferredContextsLock;
+        struct CommandListContext {
+            const void* context;
+            UINT destructionCallbackId;
+        };
+        std::map<ID3D11CommandList*, CommandListContext> m_commandListContexts;
         D3D11ContextState m_state;
         std::string m_deviceName;
+        std::string m_driverIdentifier;
         GpuArchitecture m_gpuArchitecture;
         const bool m_allowInterceptor;
         uint32_t m_lateInitCountdown{0};
@@ -1900,17 +2241,26 @@ namespace {
         config::MipMapBias m_mipMapBiasingType{config::MipMapBias::Off};
         float m_mipMapBias{0.f};
         mutable uint32_t m_numBiasedSamplersThisFrame{0};
+        std::mutex m_samplersLock;
+        std::map<ID3D11DeviceContext*, bool> m_isMipMapBiasPassActive;
+        struct BiasedSamplerOrigin {
+            ID3D11SamplerState* sampler;
+            UINT destructionCallbackId;
+        };
+        std::map<ID3D11SamplerState*, BiasedSamplerOrigin> m_biasedSamplerOrigins;
 
         SetRenderTargetEvent m_setRenderTargetEvent;
         UnsetRenderTargetEvent m_unsetRenderTargetEvent;
         CopyTextureEvent m_copyTextureEvent;
+        CloseContextEvent m_closeContextEvent;
+        ExecuteContextsEvent m_executeContextsEvent;
         std::atomic<bool> m_blockEvents{false};
 
-        mutable std::shared_ptr<IQuadShader> m_currentQuadShader;
-        mutable std::shared_ptr<IComputeShader> m_currentComputeShader;
-        mutable uint32_t m_currentShaderHighestSRV;
-        mutable uint32_t m_currentShaderHighestUAV;
-        mutable uint32_t m_currentShaderHighestRTV;
+        std::shared_ptr<IQuadShader> m_currentQuadShader;
+        std::shared_ptr<IComputeShader> m_currentComputeShader;
+        uint32_t m_currentShaderHighestSRV;
+        uint32_t m_currentShaderHighestUAV;
+        uint32_t m_currentShaderHighestRTV;
 
         static XrSwapchainCreateInfo getTextureInfo(const D3D11_TEXTURE2D_DESC& textureDesc) {
             XrSwapchainCreateInfo info;
@@ -1951,6 +2301,29 @@ namespace {
             }
         }
 
+        // Invoked when the last reference to a sampler that we biased is released.
+        static void __stdcall onBiasedSamplerOriginDestroyed(void* sampler) {
+            if (g_instance) {
+                std::unique_lock lock(g_instance->m_samplersLock);
+                for (auto it = g_instance->m_biasedSamplerOrigins.begin();
+                     it != g_instance->m_biasedSamplerOrigins.end();) {
+                    if (it->second.sampler == sampler) {
+                        it = g_instance->m_biasedSamplerOrigins.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+        }
+
+        // Invoked when the last reference to a command list is released.
+        static void __stdcall onCommandListDestroyed(void* commandList) {
+            if (g_instance) {
+                std::unique_lock lock(g_instance->m_deferredContextsLock);
+                g_instance->m_commandListContexts.erase(reinterpret_cast<ID3D11CommandList*>(commandList));
+            }
+        }
+
         static inline D3D11Device* g_instance = nullptr;
         // NB: Maximum resources possible are:
         // - D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT (128)
@@ -2099,6 +2472,235 @@ namespace {
 
             TraceLoggingWriteStop(local, "ID3D11DeviceContext_PSSetSamplers");
         }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D11Device_CreateDeferredContext,
+                                ID3D11Device* Device,
+                                UINT ContextFlags,
+                                ID3D11DeviceContext** ppDeferredContext) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D11Device_CreateDeferredContext", TLPArg(Device));
+
+            assert(g_original_ID3D11Device_CreateDeferredContext);
+            const HRESULT result =
+                g_original_ID3D11Device_CreateDeferredContext(Device, ContextFlags, ppDeferredContext);
+            if (SUCCEEDED(result) && ppDeferredContext && *ppDeferredContext) {
+                assert(g_instance);
+                g_instance->onDeferredContextCreated(Device, *ppDeferredContext);
+            }
+
+            TraceLoggingWriteStop(local, "ID3D11Device_CreateDeferredContext", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D11Device1_CreateDeferredContext1,
+                                ID3D11Device1* Device,
+                                UINT ContextFlags,
+                                ID3D11DeviceContext1** ppDeferredContext) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D11Device1_CreateDeferredContext1", TLPArg(Device));
+
+            assert(g_original_ID3D11Device1_CreateDeferredContext1);
+            const HRESULT result =
+                g_original_ID3D11Device1_CreateDeferredContext1(Device, ContextFlags, ppDeferredContext);
+            if (SUCCEEDED(result) && ppDeferredContext && *ppDeferredContext) {
+                assert(g_instance);
+                g_instance->onDeferredContextCreated(Device, *ppDeferredContext);
+            }
+
+            TraceLoggingWriteStop(local, "ID3D11Device1_CreateDeferredContext1", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D11Device2_CreateDeferredContext2,
+                                ID3D11Device2* Device,
+                                UINT ContextFlags,
+                                ID3D11DeviceContext2** ppDeferredContext) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D11Device2_CreateDeferredContext2", TLPArg(Device));
+
+            assert(g_original_ID3D11Device2_CreateDeferredContext2);
+            const HRESULT result =
+                g_original_ID3D11Device2_CreateDeferredContext2(Device, ContextFlags, ppDeferredContext);
+            if (SUCCEEDED(result) && ppDeferredContext && *ppDeferredContext) {
+                assert(g_instance);
+                g_instance->onDeferredContextCreated(Device, *ppDeferredContext);
+            }
+
+            TraceLoggingWriteStop(local, "ID3D11Device2_CreateDeferredContext2", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D11Device3_CreateDeferredContext3,
+                                ID3D11Device3* Device,
+                                UINT ContextFlags,
+                                ID3D11DeviceContext3** ppDeferredContext) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D11Device3_CreateDeferredContext3", TLPArg(Device));
+
+            assert(g_original_ID3D11Device3_CreateDeferredContext3);
+            const HRESULT result =
+                g_original_ID3D11Device3_CreateDeferredContext3(Device, ContextFlags, ppDeferredContext);
+            if (SUCCEEDED(result) && ppDeferredContext && *ppDeferredContext) {
+                assert(g_instance);
+                g_instance->onDeferredContextCreated(Device, *ppDeferredContext);
+            }
+
+            TraceLoggingWriteStop(local, "ID3D11Device3_CreateDeferredContext3", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_FinishCommandList,
+                                ID3D11DeviceContext* Context,
+                                BOOL RestoreDeferredContextState,
+                                ID3D11CommandList** ppCommandList) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D11DeviceContext_FinishCommandList", TLPArg(Context));
+
+            assert(g_instance);
+            g_instance->onFinishCommandList(Context);
+
+            assert(g_original_ID3D11DeviceContext_FinishCommandList);
+            const HRESULT result =
+                g_original_ID3D11DeviceContext_FinishCommandList(Context, RestoreDeferredContextState, ppCommandList);
+            if (SUCCEEDED(result) && ppCommandList && *ppCommandList) {
+                g_instance->onCommandListFinished(Context, *ppCommandList);
+            }
+
+            TraceLoggingWriteStop(local, "ID3D11DeviceContext_FinishCommandList", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_ExecuteCommandList,
+                                ID3D11DeviceContext* Context,
+                                ID3D11CommandList* pCommandList,
+                                BOOL RestoreContextState) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "ID3D11DeviceContext_ExecuteCommandList", TLPArg(Context), TLPArg(pCommandList));
+
+            assert(g_instance);
+            g_instance->onExecuteCommandList(Context, pCommandList);
+
+            assert(g_original_ID3D11DeviceContext_ExecuteCommandList);
+            g_original_ID3D11DeviceContext_ExecuteCommandList(Context, pCommandList, RestoreContextState);
+
+            TraceLoggingWriteStop(local, "ID3D11DeviceContext_ExecuteCommandList");
+        }
+
+        // The deferred contexts variants, when their implementation differs from the immediate context. They share
+        // the handling with the immediate context hooks.
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_Deferred_OMSetRenderTargets,
+                                ID3D11DeviceContext* Context,
+                                UINT NumViews,
+                                ID3D11RenderTargetView* const* ppRenderTargetViews,
+                                ID3D11DepthStencilView* pDepthStencilView) {
+            assert(g_instance);
+            g_instance->onSetRenderTargets(Context, NumViews, ppRenderTargetViews, pDepthStencilView);
+
+            assert(g_original_ID3D11DeviceContext_Deferred_OMSetRenderTargets);
+            g_original_ID3D11DeviceContext_Deferred_OMSetRenderTargets(
+                Context, NumViews, ppRenderTargetViews, pDepthStencilView);
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_Deferred_OMSetRenderTargetsAndUnorderedAccessViews,
+                                ID3D11DeviceContext* Context,
+                                UINT NumRTVs,
+                                ID3D11RenderTargetView* const* ppRenderTargetViews,
+                                ID3D11DepthStencilView* pDepthStencilView,
+                                UINT UAVStartSlot,
+                                UINT NumUAVs,
+                                ID3D11UnorderedAccessView* const* ppUnorderedAccessViews,
+                                const UINT* pUAVInitialCounts) {
+            assert(g_instance);
+            g_instance->onSetRenderTargets(Context, NumRTVs, ppRenderTargetViews, pDepthStencilView);
+
+            assert(g_original_ID3D11DeviceContext_Deferred_OMSetRenderTargetsAndUnorderedAccessViews);
+            g_original_ID3D11DeviceContext_Deferred_OMSetRenderTargetsAndUnorderedAccessViews(Context,
+                                                                                              NumRTVs,
+                                                                                              ppRenderTargetViews,
+                                                                                              pDepthStencilView,
+                                                                                              UAVStartSlot,
+                                                                                              NumUAVs,
+                                                                                              ppUnorderedAccessViews,
+                                                                                              pUAVInitialCounts);
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_Deferred_CopyResource,
+                                ID3D11DeviceContext* Context,
+                                ID3D11Resource* pDstResource,
+                                ID3D11Resource* pSrcResource) {
+            assert(g_instance);
+            g_instance->onCopyResource(Context, pSrcResource, pDstResource);
+
+            assert(g_original_ID3D11DeviceContext_Deferred_CopyResource);
+            g_original_ID3D11DeviceContext_Deferred_CopyResource(Context, pDstResource, pSrcResource);
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_Deferred_CopySubresourceRegion,
+                                ID3D11DeviceContext* Context,
+                                ID3D11Resource* pDstResource,
+                                UINT DstSubresource,
+                                UINT DstX,
+                                UINT DstY,
+                                UINT DstZ,
+                                ID3D11Resource* pSrcResource,
+                                UINT SrcSubresource,
+                                const D3D11_BOX* pSrcBox) {
+            assert(g_instance);
+            g_instance->onCopyResource(Context, pSrcResource, pDstResource, SrcSubresource, DstSubresource);
+
+            assert(g_original_ID3D11DeviceContext_Deferred_CopySubresourceRegion);
+            g_original_ID3D11DeviceContext_Deferred_CopySubresourceRegion(
+                Context, pDstResource, DstSubresource, DstX, DstY, DstZ, pSrcResource, SrcSubresource, pSrcBox);
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D11DeviceContext_Deferred_PSSetSamplers,
+                                ID3D11DeviceContext* Context,
+                                UINT StartSlot,
+                                UINT NumSamplers,
+                                ID3D11SamplerState* const* ppSamplers) {
+            if (NumSamplers > UINT(D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT))
+                NumSamplers = UINT(D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT);
+
+            ID3D11SamplerState* updatedSamplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+            for (UINT i = 0; i < NumSamplers; i++) {
+                updatedSamplers[i] = ppSamplers[i];
+            }
+
+            assert(g_instance);
+            g_instance->patchSamplers(Context, updatedSamplers, NumSamplers);
+
+            assert(g_original_ID3D11DeviceContext_Deferred_PSSetSamplers);
+            g_original_ID3D11DeviceContext_Deferred_PSSetSamplers(Context, StartSlot, NumSamplers, updatedSamplers);
+        }
     };
 
     decltype(D3D11CreateDeviceAndSwapChain)* g_original_D3D11CreateDeviceAndSwapChain = nullptr;
@@ -23,6 +23,7 @@
 
 #include "pch.h"
 
+#include "bindgroups.h"
 #include "d3dcommon.h"
 #include "shader_utilities.h"
 #include "factories.h"
@@ -41,6 +42,9 @@ namespace {
 
     constexpr size_t MaxGpuTimers = 32;
     constexpr size_t MaxModelBuffers = 128;
+    constexpr size_t MaxBindGroupDescriptors = 1024;
+    // Each bind group uses a fixed-size range of descriptors, so that any recycled range fits any bind group.
+    constexpr UINT BindGroupSlotSize = 8;
 
     inline void SetDebugName(ID3D12Object* resource, std::string_view name) {
         if (resource && !name.empty())
@@ -68,9 +72,14 @@ namespace {
             descSize = device->GetDescriptorHandleIncrementSize(type);
         }
 
-        void allocate(D3D12_CPU_DESCRIPTOR_HANDLE& desc) {
-            assert((UINT)heapOffset < heapSize);
-            desc = CD3DX12_CPU_DESCRIPTOR_HANDLE(heapStartCPU, heapOffset++, descSize);
+        void allocate(D3D12_CPU_DESCRIPTOR_HANDLE& desc, UINT count = 1) {
+            assert((UINT)heapOffset + count <= heapSize);
+            desc = CD3DX12_CPU_DESCRIPTOR_HANDLE(heapStartCPU, heapOffset, descSize);
+            heapOffset += count;
+        }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE offset(D3D12_CPU_DESCRIPTOR_HANDLE desc, UINT index) const {
+            return CD3DX12_CPU_DESCRIPTOR_HANDLE(desc, index, descSize);
         }
 
         // TODO: Implement freeing a descriptor
@@ -88,11 +97,32 @@ namespace {
         UINT descSize;
     };
 
+    // The resources referenced by the descriptors of an application RTV heap, indexed by descriptor slot.
+    struct RenderTargetHeapSlots {
+        ID3D12DescriptorHeap* heap;
+        SIZE_T start;
+        UINT descSize;
+        std::vector<ID3D12Resource*> resources;
+        std::optional<UINT> destructionCallbackId;
+
+        SIZE_T end() const {
+            return start + resources.size() * descSize;
+        }
+
+        ID3D12Resource** find(D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+            if (handle.ptr < start || handle.ptr >= end()) {
+                return nullptr;
+            }
+            return &resources[(handle.ptr - start) / descSize];
+        }
+    };
+
     // Wrap shader resources, common code for root signature creation.
-    // Upon first use of the shader, we require the use of the register*() method below to create the root signature.
-    // When ready to invoke the shader for the first time, we ask the caller to "resolve" the root signature, which in
-    // turn create the necessary pipeline state. This process assumes that the order of setInput/Output() calls
-    // are going to be identical for a given shader, which is an acceptable constraint.
+    // Upon first use of the shader, we ask the caller to "resolve" the root signature from the list of inputs/outputs
+    // that were set, which in turn create the necessary pipeline state. The root signature has exactly 2 parameters: a
+    // descriptor table for the sampler, and a descriptor table for all the resources, in the order they were set. This
+    // lets us bind all the resources with a single call (see BindGroupCache). This process assumes that the
+    // order of setInput/Output() calls are going to be identical for a given shader, which is an acceptable constraint.
     class D3D12Shader {
       public:
         D3D12Shader(std::shared_ptr<IDevice> device, ID3DBlob* shaderBytes, std::string_view debugName)
@@ -105,34 +135,18 @@ namespace {
             m_outputInfo = info;
         }
 
-        void registerSamplerParameter(uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-            m_parametersDescriptorRanges.push_back(
-                CD3DX12_DESCRIPTOR_RANGE(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, slot));
-            m_parametersForFirstCall.push_back(std::make_pair((uint32_t)m_parametersForFirstCall.size(), handle));
-        }
-
-        void registerCBVParameter(uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-            m_parametersDescriptorRanges.push_back(CD3DX12_DESCRIPTOR_RANGE(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, slot));
-            m_parametersForFirstCall.push_back(std::make_pair((uint32_t)m_parametersForFirstCall.size(), handle));
-        }
-
-        void registerSRVParameter(uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-            m_parametersDescriptorRanges.push_back(CD3DX12_DESCRIPTOR_RANGE(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, slot));
-            m_parametersForFirstCall.push_back(std::make_pair((uint32_t)m_parametersForFirstCall.size(), handle));
-        }
-
-        void registerUAVParameter(uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle) {
-            m_parametersDescriptorRanges.push_back(CD3DX12_DESCRIPTOR_RANGE(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, slot));
-            m_parametersForFirstCall.push_back(std::make_pair((uint32_t)m_parametersForFirstCall.size(), handle));
-        }
-
-        virtual void resolve() {
+        virtual void resolve(const std::vector<CD3DX12_DESCRIPTOR_RANGE>& resourceRanges) {
             // Common code for creating the root signature.
             if (auto device = m_device->getAs<D3D12>()) {
-                std::vector<CD3DX12_ROOT_PARAMETER> parametersDescriptors;
-                for (const auto& range : m_parametersDescriptorRanges) {
+                // TODO: This is somewhat restrictive, but for now we only support a sampler in slot 0.
+                const CD3DX12_DESCRIPTOR_RANGE samplerRange(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0);
+
+                std::vector<CD3DX12_ROOT_PARAMETER> parametersDescriptors(1);
+                parametersDescriptors.back().InitAsDescriptorTable(1, &samplerRange);
+                if (!resourceRanges.empty()) {
                     parametersDescriptors.push_back({});
-                    parametersDescriptors.back().InitAsDescriptorTable(1, &range);
+                    parametersDescriptors.back().InitAsDescriptorTable((UINT)resourceRanges.size(),
+                                                                       resourceRanges.data());
                 }
 
                 CD3DX12_ROOT_SIGNATURE_DESC desc((UINT)parametersDescriptors.size(),
@@ -156,15 +170,19 @@ namespace {
                                                         serializedRootSignature->GetBufferPointer(),
                                                         serializedRootSignature->GetBufferSize(),
                                                         IID_PPV_ARGS(set(m_rootSignature))));
-
-                m_parametersDescriptorRanges.clear();
             }
+            m_numResourceRanges = resourceRanges.size();
         }
 
         bool needsResolve() const {
             return !m_pipelineState;
         }
 
+        // Only valid once resolved.
+        size_t getNumResourceRanges() const {
+            return m_numResourceRanges;
+        }
+
       protected:
         const std::shared_ptr<IDevice> m_device;
         // Keep a reference for memory management purposes.
@@ -173,11 +191,10 @@ namespace {
 
         ComPtr<ID3D12RootSignature> m_rootSignature;
         ComPtr<ID3D12PipelineState> m_pipelineState;
+        size_t m_numResourceRanges{0};
 
         // Only used during pre-resolve phase.
         XrSwapchainCreateInfo m_outputInfo{};
-        std::vector<CD3DX12_DESCRIPTOR_RANGE> m_parametersDescriptorRanges;
-        std::vector<std::pair<uint32_t, D3D12_GPU_DESCRIPTOR_HANDLE>> m_parametersForFirstCall;
 
         mutable struct D3D12::ShaderData m_shaderData;
     };
@@ -199,9 +216,9 @@ namespace {
             return m_device;
         }
 
-        void resolve() override {
+        void resolve(const std::vector<CD3DX12_DESCRIPTOR_RANGE>& resourceRanges) override {
             // Create the root signature now.
-            D3D12Shader::resolve();
+            D3D12Shader::resolve(resourceRanges);
 
             // Initialize the pipeline state now.
             // TODO: We must support the RTV format changing.
@@ -228,19 +245,6 @@ namespace {
 
                 m_shaderData.rootSignature = get(m_rootSignature);
                 m_shaderData.pipelineState = get(m_pipelineState);
-
-                // Setup the pipeline to make up for the deferred initialization.
-                auto context = m_device->getContextAs<D3D12>();
-                context->SetGraphicsRootSignature(get(m_rootSignature));
-                context->SetPipelineState(get(m_pipelineState));
-                context->IASetIndexBuffer(nullptr);
-                context->IASetVertexBuffers(0, 0, nullptr);
-                context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-                for (const auto& parameter : m_parametersForFirstCall) {
-                    context->SetGraphicsRootDescriptorTable(parameter.first, parameter.second);
-                }
-
-                m_parametersForFirstCall.clear();
             }
         }
 
@@ -281,9 +285,9 @@ namespace {
             return m_threadGroups;
         }
 
-        void resolve() override {
+        void resolve(const std::vector<CD3DX12_DESCRIPTOR_RANGE>& resourceRanges) override {
             // Create the root signature now.
-            D3D12Shader::resolve();
+            D3D12Shader::resolve(resourceRanges);
 
             // Initialize the pipeline state now.
             if (auto device = m_device->getAs<D3D12>()) {
@@ -294,16 +298,6 @@ namespace {
 
                 m_shaderData.rootSignature = get(m_rootSignature);
                 m_shaderData.pipelineState = get(m_pipelineState);
-
-                // Setup the pipeline to make up for the deferred initialization.
-                auto context = m_device->getContextAs<D3D12>();
-                context->SetComputeRootSignature(get(m_rootSignature));
-                context->SetPipelineState(get(m_pipelineState));
-                for (const auto& parameter : m_parametersForFirstCall) {
-                    context->SetComputeRootDescriptorTable(parameter.first, parameter.second);
-                }
-
-                m_parametersForFirstCall.clear();
             }
         }
 
@@ -462,7 +456,7 @@ namespace {
             }
         }
 
-        void copyTo(std::shared_ptr<ITexture> destination) const override {
+        void copyTo(const std::shared_ptr<ITexture>& destination) const override {
             D3D12_TEXTURE_COPY_LOCATION destLoc{
                 destination->getAs<D3D12>(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, 0};
             D3D12_TEXTURE_COPY_LOCATION srcLoc{m_texture.Get(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, 0};
@@ -510,8 +504,8 @@ namespace {
             return static_cast<uint64_t>(m_textureDesc.Format);
         }
 
-      private:
-        std::shared_ptr<D3D12ResourceView> makeShaderInputViewInternal(uint32_t slice) const {
+        // Write a shader resource view at an arbitrary location of the resource view heap (see BindGroupCache).
+        void createShaderResourceView(int32_t slice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const {
             if (m_textureDesc.Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE) {
                 throw std::runtime_error("Texture was created with D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE");
             }
@@ -523,19 +517,16 @@ namespace {
                     m_info.arraySize == 1 ? D3D12_SRV_DIMENSION_TEXTURE2D : D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
                 desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
                 desc.Texture2DArray.ArraySize = 1;
-                desc.Texture2DArray.FirstArraySlice = slice;
+                desc.Texture2DArray.FirstArraySlice = std::max(slice, 0);
                 desc.Texture2DArray.MipLevels = m_info.mipCount;
                 desc.Texture2DArray.MostDetailedMip = D3D12CalcSubresource(0, 0, 0, m_info.mipCount, m_info.arraySize);
 
-                D3D12_CPU_DESCRIPTOR_HANDLE handle;
-                m_rvHeap.allocate(handle);
                 device->CreateShaderResourceView(get(m_texture), &desc, handle);
-                return std::make_shared<D3D12ResourceView>(m_device, handle);
             }
-            return nullptr;
         }
 
-        std::shared_ptr<D3D12ResourceView> makeUnorderedAccessViewInternal(uint32_t slice) const {
+        // Write an unordered access view at an arbitrary location of the resource view heap (see BindGroupCache).
+        void createUnorderedAccessView(int32_t slice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const {
             if (!(m_textureDesc.Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS)) {
                 throw std::runtime_error("Texture was not created with D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS");
             }
@@ -546,15 +537,26 @@ namespace {
                 desc.ViewDimension =
                     m_info.arraySize == 1 ? D3D12_UAV_DIMENSION_TEXTURE2D : D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
                 desc.Texture2DArray.ArraySize = 1;
-                desc.Texture2DArray.FirstArraySlice = slice;
+                desc.Texture2DArray.FirstArraySlice = std::max(slice, 0);
                 desc.Texture2DArray.MipSlice = D3D12CalcSubresource(0, 0, 0, m_info.mipCount, m_info.arraySize);
 
-                D3D12_CPU_DESCRIPTOR_HANDLE handle;
-                m_rvHeap.allocate(handle);
                 device->CreateUnorderedAccessView(get(m_texture), nullptr, &desc, handle);
-                return std::make_shared<D3D12ResourceView>(m_device, handle);
             }
-            return nullptr;
+        }
+
+      private:
+        std::shared_ptr<D3D12ResourceView> makeShaderInputViewInternal(uint32_t slice) const {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            m_rvHeap.allocate(handle);
+            createShaderResourceView(slice, handle);
+            return std::make_shared<D3D12ResourceView>(m_device, handle);
+        }
+
+        std::shared_ptr<D3D12ResourceView> makeUnorderedAccessViewInternal(uint32_t slice) const {
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            m_rvHeap.allocate(handle);
+            createUnorderedAccessView(slice, handle);
+            return std::make_shared<D3D12ResourceView>(m_device, handle);
         }
 
         std::shared_ptr<D3D12ResourceView> makeRenderTargetViewInternal(uint32_t slice) const {
@@ -683,23 +685,25 @@ namespace {
         // TODO: Consider moving this operation up to IShaderBuffer. Will prevent the need for dynamic_cast below.
         D3D12_CPU_DESCRIPTOR_HANDLE getConstantBufferView() const {
             if (!m_constantBufferView) {
-                {
-                    D3D12_CPU_DESCRIPTOR_HANDLE handle;
-                    m_rvHeap.allocate(handle);
-                    m_constantBufferView = handle;
-                }
-
-                if (auto device = m_device->getAs<D3D12>()) {
-                    D3D12_CONSTANT_BUFFER_VIEW_DESC desc;
-                    desc.BufferLocation = m_buffer->GetGPUVirtualAddress();
-                    desc.SizeInBytes =
-                        alignTo(static_cast<UINT>(m_bufferDesc.Width), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-                    device->CreateConstantBufferView(&desc, m_constantBufferView.value());
-                }
+                D3D12_CPU_DESCRIPTOR_HANDLE handle;
+                m_rvHeap.allocate(handle);
+                createConstantBufferView(handle);
+                m_constantBufferView = handle;
             }
             return m_constantBufferView.value();
         }
 
+        // Write a constant buffer view at an arbitrary location of the resource view heap (see BindGroupCache).
+        void createConstantBufferView(D3D12_CPU_DESCRIPTOR_HANDLE handle) const {
+            if (auto device = m_device->getAs<D3D12>()) {
+                D3D12_CONSTANT_BUFFER_VIEW_DESC desc;
+                desc.BufferLocation = m_buffer->GetGPUVirtualAddress();
+                desc.SizeInBytes =
+                    alignTo(static_cast<UINT>(m_bufferDesc.Width), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+                device->CreateConstantBufferView(&desc, handle);
+            }
+        }
+
         void* getNativePtr() const override {
             return get(m_buffer);
         }
@@ -763,10 +767,15 @@ namespace {
         D3D12GpuTimer(std::shared_ptr<IDevice> device,
                       ID3D12QueryHeap* queryHeap,
                       std::function<uint64_t(UINT, UINT)> queryTimestampDelta,
+                      std::function<void(UINT)> releaseTimestamps,
                       UINT startIndex,
                       UINT stopIndex)
             : m_device(device), m_queryHeap(queryHeap), m_queryTimestampDelta(queryTimestampDelta),
-              m_startIndex(startIndex), m_stopIndex(stopIndex) {
+              m_releaseTimestamps(releaseTimestamps), m_startIndex(startIndex), m_stopIndex(stopIndex) {
+        }
+
+        ~D3D12GpuTimer() override {
+            m_releaseTimestamps(m_startIndex);
         }
 
         Api getApi() const override {
@@ -793,6 +802,7 @@ namespace {
         const std::shared_ptr<IDevice> m_device;
         const ComPtr<ID3D12QueryHeap> m_queryHeap;
         const std::function<uint64_t(UINT, UINT)> m_queryTimestampDelta;
+        const std::function<void(UINT)> m_releaseTimestamps;
         const UINT m_startIndex;
         const UINT m_stopIndex;
     };
@@ -859,6 +869,16 @@ namespace {
 
                         m_gpuArchitecture = graphics::GetGpuArchitecture(adapterDesc.VendorId);
 
+                        LARGE_INTEGER driverVersion{};
+                        dxgiAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+                        m_driverIdentifier = fmt::format("{:04x}-{:04x}-{}.{}.{}.{}",
+                                                         adapterDesc.VendorId,
+                                                         adapterDesc.DeviceId,
+                                                         HIWORD(driverVersion.HighPart),
+                                                         LOWORD(driverVersion.HighPart),
+                                                         HIWORD(driverVersion.LowPart),
+                                                         LOWORD(driverVersion.LowPart));
+
                         // Log the adapter name to help debugging customer issues.
                         Log("Using Direct3D 12 on adapter: %s\n", m_deviceName.c_str());
                         break;
@@ -892,7 +912,9 @@ namespace {
             // Initialize the command lists and heaps.
             m_rtvHeap.initialize(get(m_device), D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
             m_dsvHeap.initialize(get(m_device), D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
-            m_rvHeap.initialize(get(m_device), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 32 + MaxModelBuffers);
+            m_rvHeap.initialize(
+                get(m_device), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 32 + MaxModelBuffers + MaxBindGroupDescriptors);
+            m_rvHeap.allocate(m_bindGroupDescriptors, MaxBindGroupDescriptors);
             m_samplerHeap.initialize(get(m_device), D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
             {
                 D3D12_QUERY_HEAP_DESC desc;
@@ -987,6 +1009,14 @@ namespace {
             // Clear all references that could hold a cyclic reference themselves.
             m_currentComputeShader.reset();
             m_currentQuadShader.reset();
+            m_currentBindings.clear();
+            m_hasPreparedBindGroup = false;
+            waitForFence(m_fenceValue);
+            m_bindGroups.clear();
+            {
+                std::unique_lock lock(m_deferredReleasesLock);
+                m_deferredReleases.clear();
+            }
             m_currentDrawRenderTarget.reset();
             m_currentDrawDepthBuffer.reset();
             m_currentTextRenderTarget.reset();
@@ -1010,6 +1040,10 @@ namespace {
             return m_deviceName;
         }
 
+        const std::string& getDriverIdentifier() const override {
+            return m_driverIdentifier;
+        }
+
         GpuArchitecture GetGpuArchitecture() const override {
             return m_gpuArchitecture;
         }
@@ -1072,15 +1106,23 @@ namespace {
             ID3D12CommandList* const lists[] = {get(m_context)};
             m_queue->ExecuteCommandLists(ARRAYSIZE(lists), lists);
 
+            // Signal every submission, so we know when the resources it used can be recycled (see BindGroupCache).
+            m_queue->Signal(get(m_fence), ++m_fenceValue);
             if (blocking) {
-                m_queue->Signal(get(m_fence), ++m_fenceValue);
-                if (m_fence->GetCompletedValue() < m_fenceValue) {
-                    HANDLE eventHandle = CreateEventEx(nullptr, L"flushContext Fence", 0, EVENT_ALL_ACCESS);
-                    CHECK_HRCMD(m_fence->SetEventOnCompletion(m_fenceValue, eventHandle));
-                    WaitForSingleObject(eventHandle, INFINITE);
-                    CloseHandle(eventHandle);
+                waitForFence(m_fenceValue);
+            }
+
+            // Release the objects that the GPU is done with (outside of the lock).
+            std::deque<std::pair<UINT64, std::shared_ptr<void>>> releases;
+            {
+                std::unique_lock lock(m_deferredReleasesLock);
+                const UINT64 completedFenceValue = m_fence->GetCompletedValue();
+                while (!m_deferredReleases.empty() && m_deferredReleases.front().first <= completedFenceValue) {
+                    releases.push_back(std::move(m_deferredReleases.front()));
+                    m_deferredReleases.pop_front();
                 }
             }
+            releases.clear();
 
             if (++m_currentContext == NumInflightContexts) {
                 m_currentContext = 0;
@@ -1296,117 +1338,65 @@ namespace {
         }
 
         std::shared_ptr<IGpuTimer> createTimer() override {
-            assert(m_nextGpuTimestampIndex < ARRAYSIZE(m_queryBuffer));
-            const UINT startGpuTimestampIndex = m_nextGpuTimestampIndex++;
-            const UINT stopGpuTimestampIndex = m_nextGpuTimestampIndex++;
+            UINT startGpuTimestampIndex;
+            {
+                // Reuse the queries of a released timer first.
+                std::unique_lock lock(m_gpuTimersLock);
+                if (!m_freeGpuTimestampIndices.empty()) {
+                    startGpuTimestampIndex = m_freeGpuTimestampIndices.back();
+                    m_freeGpuTimestampIndices.pop_back();
+                } else {
+                    assert(m_nextGpuTimestampIndex < ARRAYSIZE(m_queryBuffer));
+                    startGpuTimestampIndex = m_nextGpuTimestampIndex;
+                    m_nextGpuTimestampIndex += 2;
+                }
+            }
             return std::make_shared<D3D12GpuTimer>(
                 shared_from_this(),
                 get(m_queryHeap),
                 [&](UINT startIndex, UINT stopIndex) { return queryTimeStampDelta(startIndex, stopIndex); },
+                [&](UINT startIndex) { releaseTimestamps(startIndex); },
                 startGpuTimestampIndex,
-                stopGpuTimestampIndex);
+                startGpuTimestampIndex + 1);
         }
 
-        void setShader(std::shared_ptr<IQuadShader> shader, SamplerType sampler) override {
-            m_currentQuadShader.reset();
-            m_currentComputeShader.reset();
-            m_currentRootSlot = 0;
-
-            ID3D12DescriptorHeap* const heaps[] = {
-                get(m_rvHeap.heap),
-                get(m_samplerHeap.heap),
-            };
-            m_context->SetDescriptorHeaps(ARRAYSIZE(heaps), heaps);
-
-            auto d3d12Shader = dynamic_cast<D3D12Shader*>(shader.get());
-            if (!d3d12Shader->needsResolve()) {
-                // Prepare to draw the quad.
-                const auto shaderData = shader->getAs<D3D12>();
-                // TODO: This code is duplicated in D3D12QuadShader::resolve().
-                m_context->SetGraphicsRootSignature(shaderData->rootSignature);
-                m_context->SetPipelineState(shaderData->pipelineState);
-                m_context->IASetIndexBuffer(nullptr);
-                m_context->IASetVertexBuffers(0, 0, nullptr);
-                m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-                // TODO: This is somewhat restrictive, but for now we only support a linear sampler in slot 0.
-                m_context->SetGraphicsRootDescriptorTable(m_currentRootSlot++,
-                                                          m_samplerHeap.getGPUHandle(m_samplers[to_integral(sampler)]));
-            } else {
-                d3d12Shader->registerSamplerParameter(0, m_samplerHeap.getGPUHandle(m_samplers[to_integral(sampler)]));
-            }
+        void deferRelease(std::shared_ptr<void> object) override {
+            // The current context completes with the next fence value.
+            std::unique_lock lock(m_deferredReleasesLock);
+            m_deferredReleases.push_back({m_fenceValue + 1, std::move(object)});
+        }
 
+        void setShader(const std::shared_ptr<IQuadShader>& shader, SamplerType sampler) override {
             m_currentQuadShader = shader;
+            m_currentComputeShader.reset();
+            m_currentSampler = sampler;
+            m_currentBindings.clear();
+            m_hasPreparedBindGroup = false;
         }
 
-        void setShader(std::shared_ptr<IComputeShader> shader, SamplerType sampler) override {
+        void setShader(const std::shared_ptr<IComputeShader>& shader, SamplerType sampler) override {
             m_currentQuadShader.reset();
-            m_currentComputeShader.reset();
-            m_currentRootSlot = 0;
-
-            ID3D12DescriptorHeap* const heaps[] = {
-                get(m_rvHeap.heap),
-                get(m_samplerHeap.heap),
-            };
-            m_context->SetDescriptorHeaps(ARRAYSIZE(heaps), heaps);
-
-            auto d3d12Shader = dynamic_cast<D3D12Shader*>(shader.get());
-            if (!d3d12Shader->needsResolve()) {
-                const auto shaderData = shader->getAs<D3D12>();
-                m_context->SetComputeRootSignature(shaderData->rootSignature);
-                m_context->SetPipelineState(shaderData->pipelineState);
-                // TODO: This is somewhat restrictive, but for now we only support a linear sampler in slot 0.
-                m_context->SetComputeRootDescriptorTable(m_currentRootSlot++,
-                                                         m_samplerHeap.getGPUHandle(m_samplers[to_integral(sampler)]));
-            } else {
-                d3d12Shader->registerSamplerParameter(0, m_samplerHeap.getGPUHandle(m_samplers[to_integral(sampler)]));
-            }
-
             m_currentComputeShader = shader;
+            m_currentSampler = sampler;
+            m_currentBindings.clear();
+            m_hasPreparedBindGroup = false;
         }
 
-        void setShaderInput(uint32_t slot, std::shared_ptr<ITexture> input, int32_t slice) override {
-            auto d3d12Shader = m_currentComputeShader ? dynamic_cast<D3D12Shader*>(m_currentComputeShader.get())
-                               : m_currentQuadShader  ? dynamic_cast<D3D12Shader*>(m_currentQuadShader.get())
-                                                      : nullptr;
-            if (d3d12Shader) {
-                const auto pView = input->getShaderResourceView(slice)->getAs<D3D12>();
-                const auto descriptorHandle = m_rvHeap.getGPUHandle(*pView);
-                if (!d3d12Shader->needsResolve()) {
-                    if (m_currentComputeShader) {
-                        m_context->SetComputeRootDescriptorTable(m_currentRootSlot++, descriptorHandle);
-                    } else {
-                        m_context->SetGraphicsRootDescriptorTable(m_currentRootSlot++, descriptorHandle);
-                    }
-                } else {
-                    d3d12Shader->registerSRVParameter(slot, descriptorHandle);
-                }
-            } else {
+        void setShaderInput(uint32_t slot, const std::shared_ptr<ITexture>& input, int32_t slice) override {
+            if (!m_currentComputeShader && !m_currentQuadShader) {
                 throw std::runtime_error("No shader is set");
             }
+            addShaderBinding({D3D12_DESCRIPTOR_RANGE_TYPE_SRV, slot, slice, input, nullptr});
         }
 
-        void setShaderInput(uint32_t slot, std::shared_ptr<IShaderBuffer> input) override {
-            auto d3d12Shader = m_currentComputeShader ? dynamic_cast<D3D12Shader*>(m_currentComputeShader.get())
-                               : m_currentQuadShader  ? dynamic_cast<D3D12Shader*>(m_currentQuadShader.get())
-                                                      : nullptr;
-            if (d3d12Shader) {
-                const auto pBuffer = dynamic_cast<D3D12Buffer*>(input.get());
-                const auto descriptorHandle = m_rvHeap.getGPUHandle(pBuffer->getConstantBufferView());
-                if (!d3d12Shader->needsResolve()) {
-                    if (m_currentComputeShader) {
-                        m_context->SetComputeRootDescriptorTable(m_currentRootSlot++, descriptorHandle);
-                    } else {
-                        m_context->SetGraphicsRootDescriptorTable(m_currentRootSlot++, descriptorHandle);
-                    }
-                } else {
-                    d3d12Shader->registerCBVParameter(slot, descriptorHandle);
-                }
-            } else {
+        void setShaderInput(uint32_t slot, const std::shared_ptr<IShaderBuffer>& input) override {
+            if (!m_currentComputeShader && !m_currentQuadShader) {
                 throw std::runtime_error("No shader is set");
             }
+            addShaderBinding({D3D12_DESCRIPTOR_RANGE_TYPE_CBV, slot, -1, nullptr, input});
         }
 
-        void setShaderOutput(uint32_t slot, std::shared_ptr<ITexture> output, int32_t slice) override {
+        void setShaderOutput(uint32_t slot, const std::shared_ptr<ITexture>& output, int32_t slice) override {
             if (m_currentQuadShader) {
                 if (!slot) {
                     setRenderTargets(1, &output, &slice);
@@ -1418,32 +1408,72 @@ namespace {
                     throw std::runtime_error("Only use slot 0 for IQuadShader");
                 }
             } else if (m_currentComputeShader) {
-                const auto pView = output->getUnorderedAccessView(slice)->getAs<D3D12>();
-                auto descriptorHandle = m_rvHeap.getGPUHandle(*pView);
-                auto d3d12Shader = dynamic_cast<D3D12Shader*>(m_currentComputeShader.get());
-                if (!d3d12Shader->needsResolve()) {
-                    m_context->SetComputeRootDescriptorTable(m_currentRootSlot++, descriptorHandle);
-                } else {
-                    d3d12Shader->registerUAVParameter(slot, descriptorHandle);
-                }
+                addShaderBinding({D3D12_DESCRIPTOR_RANGE_TYPE_UAV, slot, slice, output, nullptr});
             } else {
                 throw std::runtime_error("No shader is set");
             }
         }
 
-        void dispatchShader(bool doNotClear) const override {
-            auto d3d12Shader = m_currentComputeShader ? dynamic_cast<D3D12Shader*>(m_currentComputeShader.get())
-                               : m_currentQuadShader  ? dynamic_cast<D3D12Shader*>(m_currentQuadShader.get())
-                                                      : nullptr;
+        void dispatchShader(bool doNotClear) override {
+            auto d3d12Shader = getCurrentShader();
             if (d3d12Shader) {
                 // The first time, we need to resolve the root signature and create the pipeline state.
                 if (d3d12Shader->needsResolve()) {
-                    d3d12Shader->resolve();
+                    std::vector<CD3DX12_DESCRIPTOR_RANGE> resourceRanges;
+                    for (const auto& binding : m_currentBindings) {
+                        resourceRanges.push_back(CD3DX12_DESCRIPTOR_RANGE(binding.type, 1, binding.slot));
+                    }
+                    d3d12Shader->resolve(resourceRanges);
+                }
+
+                // The bind group is normally prepared by setShaderInput()/setShaderOutput(), but the number of bindings
+                // of the shader is only known once it is resolved.
+                if (!m_hasPreparedBindGroup) {
+                    prepareBindGroup(d3d12Shader);
                 }
+                if (!m_currentBindings.empty() && !m_currentBindGroup) {
+                    // Out of descriptors: skip this pass rather than failing the frame.
+                    if (!doNotClear) {
+                        clearShader();
+                    }
+                    return;
+                }
+
+                ID3D12DescriptorHeap* const heaps[] = {
+                    get(m_rvHeap.heap),
+                    get(m_samplerHeap.heap),
+                };
+                m_context->SetDescriptorHeaps(ARRAYSIZE(heaps), heaps);
+
+                const auto samplerHandle = m_samplerHeap.getGPUHandle(m_samplers[to_integral(m_currentSampler)]);
+                D3D12_GPU_DESCRIPTOR_HANDLE bindGroupHandle{};
+                if (m_currentBindGroup) {
+                    // The bind group may be dispatched again after the context was flushed.
+                    m_currentBindGroup->lastUsedFenceValue = m_fenceValue + 1;
+                    bindGroupHandle = m_rvHeap.getGPUHandle(getBindGroupDescriptors(m_currentBindGroup->slot));
+                }
+
                 if (m_currentQuadShader) {
+                    const auto shaderData = m_currentQuadShader->getAs<D3D12>();
+                    m_context->SetGraphicsRootSignature(shaderData->rootSignature);
+                    m_context->SetPipelineState(shaderData->pipelineState);
+                    m_context->IASetIndexBuffer(nullptr);
+                    m_context->IASetVertexBuffers(0, 0, nullptr);
+                    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+                    m_context->SetGraphicsRootDescriptorTable(0, samplerHandle);
+                    if (m_currentBindGroup) {
+                        m_context->SetGraphicsRootDescriptorTable(1, bindGroupHandle);
+                    }
                     m_context->DrawInstanced(3, 1, 0, 0);
 
                 } else if (m_currentComputeShader) {
+                    const auto shaderData = m_currentComputeShader->getAs<D3D12>();
+                    m_context->SetComputeRootSignature(shaderData->rootSignature);
+                    m_context->SetPipelineState(shaderData->pipelineState);
+                    m_context->SetComputeRootDescriptorTable(0, samplerHandle);
+                    if (m_currentBindGroup) {
+                        m_context->SetComputeRootDescriptorTable(1, bindGroupHandle);
+                    }
                     m_context->Dispatch(m_currentComputeShader->getThreadGroups()[0],
                                         m_currentComputeShader->getThreadGroups()[1],
                                         m_currentComputeShader->getThreadGroups()[2]);
@@ -1453,8 +1483,7 @@ namespace {
             }
 
             if (!doNotClear) {
-                m_currentQuadShader.reset();
-                m_currentComputeShader.reset();
+                clearShader();
             }
         }
 
@@ -1465,10 +1494,24 @@ namespace {
             m_currentMesh.reset();
         }
 
+        void setViewport(const XrRect2Di& viewport) override {
+            const auto d3dViewport = CD3DX12_VIEWPORT((float)viewport.offset.x,
+                                                      (float)viewport.offset.y,
+                                                      (float)viewport.extent.width,
+                                                      (float)viewport.extent.height);
+            m_context->RSSetViewports(1, &d3dViewport);
+
+            const auto scissorRect = CD3DX12_RECT(viewport.offset.x,
+                                                  viewport.offset.y,
+                                                  viewport.offset.x + viewport.extent.width,
+                                                  viewport.offset.y + viewport.extent.height);
+            m_context->RSSetScissorRects(1, &scissorRect);
+        }
+
         void setRenderTargets(size_t numRenderTargets,
                               const std::shared_ptr<ITexture>* renderTargets,
                               int32_t* renderSlices = nullptr,
-                              std::shared_ptr<ITexture> depthBuffer = nullptr,
+                              const std::shared_ptr<ITexture>& depthBuffer = nullptr,
                               int32_t depthSlice = -1) override {
             assert(renderTargets || !numRenderTargets);
             assert(depthBuffer || depthSlice < 0);
@@ -1507,7 +1550,7 @@ namespace {
             if (numRenderTargets) {
                 m_currentDrawRenderTarget = renderTargets[0];
                 m_currentDrawRenderTargetSlice = renderSlices ? renderSlices[0] : -1;
-                m_currentDrawDepthBuffer = std::move(depthBuffer);
+                m_currentDrawDepthBuffer = depthBuffer;
                 m_currentDrawDepthBufferSlice = depthSlice;
 
                 const auto viewport = CD3DX12_VIEWPORT(0.f,
@@ -1577,7 +1620,7 @@ namespace {
             m_currentDrawDepthBufferIsInverted = view.NearFar.Near > view.NearFar.Far;
         }
 
-        void draw(std::shared_ptr<ISimpleMesh> mesh, const XrPosef& pose, XrVector3f scaling) override {
+        void draw(const std::shared_ptr<ISimpleMesh>& mesh, const XrPosef& pose, XrVector3f scaling) override {
             auto meshData = mesh->getAs<D3D12>();
             if (!meshData)
                 return;
@@ -1756,6 +1799,10 @@ namespace {
             // TODO: Implement mip-map bias.
         }
 
+        void setMipMapBiasPassActive(const std::shared_ptr<IContext>& context, bool active) override {
+            // TODO: Implement mip-map bias.
+        }
+
         uint32_t getNumBiasedSamplersThisFrame() const override {
             // TODO: Implement mip-map bias.
             return 0;
@@ -1792,6 +1839,18 @@ namespace {
             m_copyTextureEvent = event;
         }
 
+        void registerCloseContextEvent(CloseContextEvent event) override {
+            m_closeContextEvent = event;
+        }
+
+        void registerExecuteContextsEvent(ExecuteContextsEvent event) override {
+            m_executeContextsEvent = event;
+        }
+
+        void registerSetShadingRateEvent(SetShadingRateEvent event) override {
+            m_setShadingRateEvent = event;
+        }
+
         bool isEventsSupported() const override {
             return m_allowInterceptor;
         }
@@ -1831,11 +1890,41 @@ namespace {
                                20,
                                hooked_ID3D12Device_CreateRenderTargetView,
                                g_original_ID3D12Device_CreateRenderTargetView);
+            DetourMethodAttach(get(m_device),
+                               // Method offset is 7 + method index (0-based) for ID3D12Device.
+                               14,
+                               hooked_ID3D12Device_CreateDescriptorHeap,
+                               g_original_ID3D12Device_CreateDescriptorHeap);
             DetourMethodAttach(get(m_context),
                                // Method offset is 10 + method index (0-based) for ID3D12GraphicsCommandList.
                                16,
                                hooked_ID3D12GraphicsCommandList_CopyTextureRegion,
                                g_original_ID3D12GraphicsCommandList_CopyTextureRegion);
+            DetourMethodAttach(get(m_context),
+                               // Method offset is 10 + method index (0-based) for ID3D12GraphicsCommandList.
+                               9,
+                               hooked_ID3D12GraphicsCommandList_Close,
+                               g_original_ID3D12GraphicsCommandList_Close);
+            DetourMethodAttach(get(m_queue),
+                               // Method offset is 8 + method index (0-based) for ID3D12CommandQueue.
+                               10,
+                               hooked_ID3D12CommandQueue_ExecuteCommandLists,
+                               g_original_ID3D12CommandQueue_ExecuteCommandLists);
+
+            // The shading rate commands only exist on Windows 10 1903 and later.
+            ComPtr<ID3D12GraphicsCommandList5> vrsCommandList;
+            if (SUCCEEDED(m_context->QueryInterface(set(vrsCommandList)))) {
+                DetourMethodAttach(get(vrsCommandList),
+                                   // Method offset is 77 + method index (0-based) for ID3D12GraphicsCommandList5.
+                                   77,
+                                   hooked_ID3D12GraphicsCommandList5_RSSetShadingRate,
+                                   g_original_ID3D12GraphicsCommandList5_RSSetShadingRate);
+                DetourMethodAttach(get(vrsCommandList),
+                                   // Method offset is 77 + method index (0-based) for ID3D12GraphicsCommandList5.
+                                   78,
+                                   hooked_ID3D12GraphicsCommandList5_RSSetShadingRateImage,
+                                   g_original_ID3D12GraphicsCommandList5_RSSetShadingRateImage);
+            }
         }
 
         void uninitializeInterceptor() {
@@ -1849,11 +1938,52 @@ namespace {
                                20,
                                hooked_ID3D12Device_CreateRenderTargetView,
                                g_original_ID3D12Device_CreateRenderTargetView);
+            DetourMethodDetach(get(m_device),
+                               // Method offset is 7 + method index (0-based) for ID3D12Device.
+                               14,
+                               hooked_ID3D12Device_CreateDescriptorHeap,
+                               g_original_ID3D12Device_CreateDescriptorHeap);
             DetourMethodDetach(get(m_context),
                                // Method offset is 10 + method index (0-based) for ID3D12GraphicsCommandList.
                                16,
                                hooked_ID3D12GraphicsCommandList_CopyTextureRegion,
                                g_original_ID3D12GraphicsCommandList_CopyTextureRegion);
+            DetourMethodDetach(get(m_context),
+                               // Method offset is 10 + method index (0-based) for ID3D12GraphicsCommandList.
+                               9,
+                               hooked_ID3D12GraphicsCommandList_Close,
+                               g_original_ID3D12GraphicsCommandList_Close);
+            DetourMethodDetach(get(m_queue),
+                               // Method offset is 8 + method index (0-based) for ID3D12CommandQueue.
+                               10,
+                               hooked_ID3D12CommandQueue_ExecuteCommandLists,
+                               g_original_ID3D12CommandQueue_ExecuteCommandLists);
+
+            ComPtr<ID3D12GraphicsCommandList5> vrsCommandList;
+            if (SUCCEEDED(m_context->QueryInterface(set(vrsCommandList)))) {
+                DetourMethodDetach(get(vrsCommandList),
+                                   // Method offset is 77 + method index (0-based) for ID3D12GraphicsCommandList5.
+                                   77,
+                                   hooked_ID3D12GraphicsCommandList5_RSSetShadingRate,
+                                   g_original_ID3D12GraphicsCommandList5_RSSetShadingRate);
+                DetourMethodDetach(get(vrsCommandList),
+                                   // Method offset is 77 + method index (0-based) for ID3D12GraphicsCommandList5.
+                                   78,
+                                   hooked_ID3D12GraphicsCommandList5_RSSetShadingRateImage,
+                                   g_original_ID3D12GraphicsCommandList5_RSSetShadingRateImage);
+            }
+
+            // The descriptor heaps of the application may outlive us.
+            {
+                std::unique_lock lock(m_renderTargetHeapsLock);
+                for (const auto& [start, slots] : m_renderTargetHeaps) {
+                    ComPtr<ID3DDestructionNotifier> notifier;
+                    if (slots->destructionCallbackId && SUCCEEDED(slots->heap->QueryInterface(set(notifier)))) {
+                        notifier->UnregisterDestructionCallback(slots->destructionCallbackId.value());
+                    }
+                }
+                m_renderTargetHeaps.clear();
+            }
 
             g_instance = nullptr;
         }
@@ -1902,6 +2032,109 @@ namespace {
             }
         }
 
+        // An input or output recorded by setShaderInput()/setShaderOutput(), to be written into a bind group.
+        struct ShaderBinding {
+            D3D12_DESCRIPTOR_RANGE_TYPE type;
+            uint32_t slot;
+            int32_t slice;
+            std::shared_ptr<ITexture> texture;
+            std::shared_ptr<IShaderBuffer> buffer;
+        };
+
+        D3D12Shader* getCurrentShader() const {
+            return m_currentComputeShader ? dynamic_cast<D3D12Shader*>(m_currentComputeShader.get())
+                   : m_currentQuadShader  ? dynamic_cast<D3D12Shader*>(m_currentQuadShader.get())
+                                          : nullptr;
+        }
+
+        void clearShader() {
+            m_currentQuadShader.reset();
+            m_currentComputeShader.reset();
+            m_currentBindings.clear();
+            m_hasPreparedBindGroup = false;
+        }
+
+        void addShaderBinding(ShaderBinding binding) {
+            m_currentBindings.push_back(std::move(binding));
+            m_hasPreparedBindGroup = false;
+
+            // Once all the inputs/outputs of a resolved shader are set, prepare its bind group so that
+            // dispatchShader() only needs to record the commands.
+            const auto d3d12Shader = getCurrentShader();
+            if (!d3d12Shader->needsResolve() && m_currentBindings.size() == d3d12Shader->getNumResourceRanges()) {
+                prepareBindGroup(d3d12Shader);
+            }
+        }
+
+        // Look up or create the bind group for the current shader and bindings.
+        void prepareBindGroup(const D3D12Shader* shader) {
+            m_hasPreparedBindGroup = true;
+            m_currentBindGroup = nullptr;
+            if (m_currentBindings.empty()) {
+                return;
+            }
+
+            if (m_currentBindings.size() > BindGroupSlotSize) {
+                throw std::runtime_error("Too many bindings for a bind group");
+            }
+
+            // The key is the identity of the shader and each input/output, in the order they were set.
+            m_bindGroupKey.clear();
+            m_bindGroupKey.push_back(reinterpret_cast<uintptr_t>(shader));
+            for (const auto& binding : m_currentBindings) {
+                m_bindGroupKey.push_back(binding.type);
+                m_bindGroupKey.push_back(binding.slot);
+                m_bindGroupKey.push_back(static_cast<uintptr_t>(binding.slice));
+                m_bindGroupKey.push_back(binding.texture ? reinterpret_cast<uintptr_t>(binding.texture.get())
+                                                         : reinterpret_cast<uintptr_t>(binding.buffer.get()));
+            }
+
+            // The current command list completes with the next fence value.
+            m_currentBindGroup = m_bindGroups.getOrCreate(m_bindGroupKey, m_fenceValue + 1, [&](uint32_t slot) {
+                std::vector<std::weak_ptr<void>> objects;
+
+                // Write the descriptors contiguously, in the same order as the ranges of the root signature.
+                const auto descriptors = getBindGroupDescriptors(slot);
+                for (UINT i = 0; i < m_currentBindings.size(); i++) {
+                    const auto& binding = m_currentBindings[i];
+                    const auto handle = m_rvHeap.offset(descriptors, i);
+                    if (binding.type == D3D12_DESCRIPTOR_RANGE_TYPE_CBV) {
+                        dynamic_cast<D3D12Buffer*>(binding.buffer.get())->createConstantBufferView(handle);
+                        objects.push_back(binding.buffer);
+                    } else {
+                        auto texture = dynamic_cast<D3D12Texture*>(binding.texture.get());
+                        if (binding.type == D3D12_DESCRIPTOR_RANGE_TYPE_SRV) {
+                            texture->createShaderResourceView(binding.slice, handle);
+                        } else {
+                            texture->createUnorderedAccessView(binding.slice, handle);
+                        }
+                        objects.push_back(binding.texture);
+                    }
+                }
+                objects.push_back(m_currentComputeShader ? std::weak_ptr<void>(m_currentComputeShader)
+                                                         : std::weak_ptr<void>(m_currentQuadShader));
+                return objects;
+            });
+
+            if (!m_currentBindGroup && !m_hasLoggedOutOfBindGroups) {
+                Log("Out of descriptors for bind groups, skipping shader passes\n");
+                m_hasLoggedOutOfBindGroups = true;
+            }
+        }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE getBindGroupDescriptors(uint32_t slot) const {
+            return m_rvHeap.offset(m_bindGroupDescriptors, slot * BindGroupSlotSize);
+        }
+
+        void waitForFence(UINT64 value) const {
+            if (m_fence->GetCompletedValue() < value) {
+                HANDLE eventHandle = CreateEventEx(nullptr, L"Fence", 0, EVENT_ALL_ACCESS);
+                CHECK_HRCMD(m_fence->SetEventOnCompletion(value, eventHandle));
+                WaitForSingleObject(eventHandle, INFINITE);
+                CloseHandle(eventHandle);
+            }
+        }
+
         // Initialize the calls needed for draw() and related calls.
         void initializeMeshResources() {
             {
@@ -1985,32 +2218,117 @@ namespace {
             return ((m_queryBuffer[stopIndex] - m_queryBuffer[startIndex]) * 1000000) / m_gpuTickFrequency;
         }
 
-        void registerRenderTargetView(ID3D12Resource* resource,
+        void releaseTimestamps(UINT startIndex) {
+            // The queries may still be written by the work submitted so far.
+            deferRelease(std::shared_ptr<void>(nullptr, [this, startIndex](void*) {
+                std::unique_lock lock(m_gpuTimersLock);
+                m_freeGpuTimestampIndices.push_back(startIndex);
+            }));
+        }
+
+        void registerRenderTargetHeap(ID3D12Device* device, ID3D12DescriptorHeap* heap) {
+            if (device != get(m_device)) {
+                return;
+            }
+
+            const auto& heapDesc = heap->GetDesc();
+            if (heapDesc.Type != D3D12_DESCRIPTOR_HEAP_TYPE_RTV) {
+                return;
+            }
+
+            auto slots = std::make_shared<RenderTargetHeapSlots>();
+            slots->heap = heap;
+            slots->start = heap->GetCPUDescriptorHandleForHeapStart().ptr;
+            slots->descSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+            slots->resources.resize(heapDesc.NumDescriptors, nullptr);
+
+            std::unique_lock lock(m_renderTargetHeapsLock);
+
+            // We forget about the heap once the application releases it. The callback runs before the address range
+            // can be reused, so the start of the heap identifies it.
+            ComPtr<ID3DDestructionNotifier> notifier;
+            UINT destructionCallbackId;
+            if (SUCCEEDED(heap->QueryInterface(set(notifier))) &&
+                SUCCEEDED(notifier->RegisterDestructionCallback(
+                    onRenderTargetHeapDestroyed, reinterpret_cast<void*>(slots->start), &destructionCallbackId))) {
+                slots->destructionCallbackId = destructionCallbackId;
+            }
+
+            // Otherwise, any heap overlapping the new one has been released: forget it.
+            auto it = m_renderTargetHeaps.lower_bound(slots->start);
+            if (it != m_renderTargetHeaps.begin() && std::prev(it)->second->end() > slots->start) {
+                --it;
+            }
+            while (it != m_renderTargetHeaps.end() && it->first < slots->end()) {
+                it = m_renderTargetHeaps.erase(it);
+            }
+
+            m_renderTargetHeaps.insert_or_assign(slots->start, slots);
+        }
+
+        static void __stdcall onRenderTargetHeapDestroyed(void* heapStart) {
+            if (g_instance) {
+                std::unique_lock lock(g_instance->m_renderTargetHeapsLock);
+                g_instance->m_renderTargetHeaps.erase(reinterpret_cast<SIZE_T>(heapStart));
+            }
+        }
+
+        // Return the slot holding the resource for a descriptor, or nullptr if the heap is not tracked. Must be called
+        // with the heaps lock held.
+        ID3D12Resource** findRenderTargetSlot(D3D12_CPU_DESCRIPTOR_HANDLE handle) const {
+            auto it = m_renderTargetHeaps.upper_bound(handle.ptr);
+            if (it == m_renderTargetHeaps.begin()) {
+                return nullptr;
+            }
+            return std::prev(it)->second->find(handle);
+        }
+
+        void registerRenderTargetView(ID3D12Device* device,
+                                      ID3D12Resource* resource,
                                       const D3D12_RENDER_TARGET_VIEW_DESC* desc,
                                       D3D12_CPU_DESCRIPTOR_HANDLE handle) {
-            if (!resource) {
+            if (device != get(m_device)) {
                 return;
             }
 
-            ComPtr<ID3D12Device> device;
-            CHECK_HRCMD(resource->GetDevice(IID_PPV_ARGS(set(device))));
-            if (device != m_device) {
+            if (resource && resource->GetDesc().Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D) {
+                resource = nullptr;
+            }
+
+            std::unique_lock lock(m_renderTargetHeapsLock);
+
+            // Heaps we have seen being created resolve by slot and are overwritten in place.
+            if (auto slot = findRenderTargetSlot(handle)) {
+                *slot = resource;
                 return;
             }
 
-            D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
-            if (resourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D) {
+            // Heaps created before we hooked the device fall back to a dictionary.
+            if (resource) {
                 const size_t sizeBefore = m_renderTargetResourceDescriptors.size();
                 m_renderTargetResourceDescriptors.insert_or_assign(handle, resource);
                 if (sizeBefore && !(sizeBefore % 100) && m_renderTargetResourceDescriptors.size() != sizeBefore) {
                     Log("Dictionary of render target resource descriptor now at %zu elements\n", sizeBefore + 1);
                 }
+            } else {
+                m_renderTargetResourceDescriptors.erase(handle);
             }
         }
 
+        // The commands we record from within the events must not be mistaken for the application's.
+        struct EventScope {
+            EventScope() {
+                g_isInEvent = true;
+            }
+            ~EventScope() {
+                g_isInEvent = false;
+            }
+        };
+
 #define INVOKE_EVENT(event, ...)                                                                                       \
     do {                                                                                                               \
         if (!m_blockEvents && m_##event) {                                                                             \
+            EventScope scope;                                                                                          \
             m_##event(##__VA_ARGS__);                                                                                  \
         }                                                                                                              \
     } while (0);
@@ -2020,26 +2338,37 @@ namespace {
                                 const D3D12_CPU_DESCRIPTOR_HANDLE* renderTargetHandles,
                                 BOOL singleHandleToDescriptorRange,
                                 const D3D12_CPU_DESCRIPTOR_HANDLE* depthStencilHandle) {
-            ComPtr<ID3D12Device> device;
-            CHECK_HRCMD(context->GetDevice(IID_PPV_ARGS(set(device))));
-            if (device != m_device) {
-                return;
+            // A descriptor from one of our tracked heaps implies the command list belongs to our device.
+            ID3D12Resource* resource = nullptr;
+            bool isTracked = false;
+            if (numRenderTargetDescriptors) {
+                std::shared_lock lock(m_renderTargetHeapsLock);
+                if (auto slot = findRenderTargetSlot(renderTargetHandles[0])) {
+                    resource = *slot;
+                    isTracked = true;
+                } else {
+                    auto it = m_renderTargetResourceDescriptors.find(renderTargetHandles[0]);
+                    if (it != m_renderTargetResourceDescriptors.cend()) {
+                        resource = it->second;
+                    }
+                }
             }
 
-            auto wrappedContext = std::make_shared<D3D12Context>(shared_from_this(), context);
-
-            if (!numRenderTargetDescriptors) {
-                INVOKE_EVENT(unsetRenderTargetEvent, wrappedContext);
-                return;
+            if (!isTracked) {
+                ComPtr<ID3D12Device> device;
+                CHECK_HRCMD(context->GetDevice(IID_PPV_ARGS(set(device))));
+                if (device != m_device) {
+                    return;
+                }
             }
 
-            auto it = m_renderTargetResourceDescriptors.find(renderTargetHandles[0]);
-            if (it == m_renderTargetResourceDescriptors.cend()) {
+            auto wrappedContext = std::make_shared<D3D12Context>(shared_from_this(), context);
+
+            if (!resource) {
                 INVOKE_EVENT(unsetRenderTargetEvent, wrappedContext);
                 return;
             }
 
-            ID3D12Resource* const resource = it->second;
             const D3D12_RESOURCE_DESC& resourceDesc = resource->GetDesc();
 
             auto renderTarget = std::make_shared<D3D12Texture>(shared_from_this(),
@@ -2049,7 +2378,7 @@ namespace {
                                                                m_rtvHeap,
                                                                m_dsvHeap,
                                                                m_rvHeap);
-            INVOKE_EVENT(setRenderTargetEvent, wrappedContext, renderTarget);
+            INVOKE_EVENT(setRenderTargetEvent, wrappedContext, renderTarget, depthStencilHandle != nullptr);
         }
 
         void onCopyTexture(ID3D12GraphicsCommandList* context,
@@ -2086,11 +2415,66 @@ namespace {
             INVOKE_EVENT(copyTextureEvent, wrappedContext, source, destination, SrcSubresource, DstSubresource);
         }
 
+        void onCloseCommandList(ID3D12GraphicsCommandList* context) {
+            if (!m_closeContextEvent) {
+                return;
+            }
+
+            ComPtr<ID3D12Device> device;
+            CHECK_HRCMD(context->GetDevice(IID_PPV_ARGS(set(device))));
+            if (device != m_device) {
+                return;
+            }
+
+            // Not subject to blocking: the state recorded into the command list must always be closed.
+            EventScope scope;
+            m_closeContextEvent(std::make_shared<D3D12Context>(shared_from_this(), context));
+        }
+
+        void onSetShadingRate(ID3D12GraphicsCommandList5* context, const ShadingRateCommand& command) {
+            if (!m_setShadingRateEvent || g_isInEvent || context == get(m_context)) {
+                return;
+            }
+
+            ComPtr<ID3D12Device> device;
+            CHECK_HRCMD(context->GetDevice(IID_PPV_ARGS(set(device))));
+            if (device != m_device) {
+                return;
+            }
+
+            // Not subject to blocking: the state of the application must always be tracked.
+            EventScope scope;
+            m_setShadingRateEvent(std::make_shared<D3D12Context>(shared_from_this(), context), command);
+        }
+
+        void onExecuteCommandLists(ID3D12CommandQueue* queue, UINT numCommandLists, ID3D12CommandList* const* lists) {
+            if (!m_executeContextsEvent) {
+                return;
+            }
+
+            ComPtr<ID3D12Device> device;
+            CHECK_HRCMD(queue->GetDevice(IID_PPV_ARGS(set(device))));
+            if (device != m_device) {
+                return;
+            }
+
+            // Our wrapped contexts use the ID3D12GraphicsCommandList pointer, which is the same object.
+            std::vector<const void*> contexts;
+            contexts.reserve(numCommandLists);
+            for (UINT i = 0; i < numCommandLists; i++) {
+                if (lists[i]->GetType() != D3D12_COMMAND_LIST_TYPE_BUNDLE) {
+                    contexts.push_back(lists[i]);
+                }
+            }
+            m_executeContextsEvent(contexts);
+        }
+
 #undef INVOKE_EVENT
 
         const ComPtr<ID3D12Device> m_device;
         ComPtr<ID3D12CommandQueue> m_queue;
         std::string m_deviceName;
+        std::string m_driverIdentifier;
         GpuArchitecture m_gpuArchitecture;
         const bool m_allowInterceptor;
 
@@ -2117,12 +2501,18 @@ namespace {
         ComPtr<ID3D12RootSignature> m_meshRendererRootSignature;
         ComPtr<ID3D12PipelineState> m_meshRendererPipelineState;
         ComPtr<ID3D12Fence> m_fence;
-        UINT64 m_fenceValue{0};
+        std::atomic<UINT64> m_fenceValue{0};
 
+        std::mutex m_gpuTimersLock;
         UINT m_nextGpuTimestampIndex{0};
+        std::vector<UINT> m_freeGpuTimestampIndices; // start index of each pair
         uint64_t m_queryBuffer[MaxGpuTimers * 2];
         uint64_t m_gpuTickFrequency{0};
 
+        // Declared after the pools that the deferred releases return objects to.
+        std::mutex m_deferredReleasesLock;
+        std::deque<std::pair<UINT64, std::shared_ptr<void>>> m_deferredReleases; // fence value, object
+
         std::shared_ptr<IDevice> m_textDevice;
         ComPtr<ID3D11On12Device> m_textInteropDevice;
         bool m_isRenderingText{false};
@@ -2135,17 +2525,31 @@ namespace {
         bool m_currentDrawDepthBufferIsInverted;
 
         std::shared_ptr<ISimpleMesh> m_currentMesh;
-        mutable std::shared_ptr<IQuadShader> m_currentQuadShader;
-        mutable std::shared_ptr<IComputeShader> m_currentComputeShader;
-        uint32_t m_currentRootSlot;
+        std::shared_ptr<IQuadShader> m_currentQuadShader;
+        std::shared_ptr<IComputeShader> m_currentComputeShader;
+        SamplerType m_currentSampler;
+        std::vector<ShaderBinding> m_currentBindings;
+        bool m_hasPreparedBindGroup{false};
+        BindGroupCache::BindGroup* m_currentBindGroup{nullptr};
+        BindGroupCache::Key m_bindGroupKey;
+        BindGroupCache m_bindGroups{MaxBindGroupDescriptors / BindGroupSlotSize,
+                                    [this]() { return m_fence->GetCompletedValue(); },
+                                    [this](uint64_t value) { waitForFence(value); }};
+        D3D12_CPU_DESCRIPTOR_HANDLE m_bindGroupDescriptors;
+        bool m_hasLoggedOutOfBindGroups{false};
 
         ComPtr<ID3D12InfoQueue> m_infoQueue;
 
         SetRenderTargetEvent m_setRenderTargetEvent;
         UnsetRenderTargetEvent m_unsetRenderTargetEvent;
         CopyTextureEvent m_copyTextureEvent;
+        CloseContextEvent m_closeContextEvent;
+        ExecuteContextsEvent m_executeContextsEvent;
+        SetShadingRateEvent m_setShadingRateEvent;
         std::atomic<bool> m_blockEvents{false};
 
+        std::shared_mutex m_renderTargetHeapsLock;
+        std::map<SIZE_T, std::shared_ptr<RenderTargetHeapSlots>> m_renderTargetHeaps;
         std::map<D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource*, decltype(descriptorCompare)>
             m_renderTargetResourceDescriptors{descriptorCompare};
 
@@ -2194,6 +2598,7 @@ namespace {
         }
 
         static inline D3D12Device* g_instance = nullptr;
+        static inline thread_local bool g_isInEvent = false;
 
         DECLARE_DETOUR_FUNCTION(static void,
                                 STDMETHODCALLTYPE,
@@ -2206,7 +2611,7 @@ namespace {
             TraceLoggingWriteStart(local, "ID3D12Device_CreateRenderTargetView", TLPArg(Device), TLPArg(pResource));
 
             assert(g_instance);
-            g_instance->registerRenderTargetView(pResource, pDesc, DestDescriptor);
+            g_instance->registerRenderTargetView(Device, pResource, pDesc, DestDescriptor);
 
             assert(g_original_ID3D12Device_CreateRenderTargetView);
             g_original_ID3D12Device_CreateRenderTargetView(Device, pResource, pDesc, DestDescriptor);
@@ -2214,6 +2619,36 @@ namespace {
             TraceLoggingWriteStop(local, "ID3D12Device_CreateRenderTargetView");
         }
 
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D12Device_CreateDescriptorHeap,
+                                ID3D12Device* Device,
+                                const D3D12_DESCRIPTOR_HEAP_DESC* pDescriptorHeapDesc,
+                                REFIID riid,
+                                void** ppvHeap) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "ID3D12Device_CreateDescriptorHeap",
+                                   TLPArg(Device),
+                                   TLArg((int)pDescriptorHeapDesc->Type, "Type"),
+                                   TLArg(pDescriptorHeapDesc->NumDescriptors, "NumDescriptors"));
+
+            assert(g_original_ID3D12Device_CreateDescriptorHeap);
+            const HRESULT result =
+                g_original_ID3D12Device_CreateDescriptorHeap(Device, pDescriptorHeapDesc, riid, ppvHeap);
+            if (SUCCEEDED(result) && ppvHeap && pDescriptorHeapDesc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_RTV) {
+                ComPtr<ID3D12DescriptorHeap> heap;
+                if (SUCCEEDED(static_cast<IUnknown*>(*ppvHeap)->QueryInterface(IID_PPV_ARGS(set(heap))))) {
+                    assert(g_instance);
+                    g_instance->registerRenderTargetHeap(Device, get(heap));
+                }
+            }
+
+            TraceLoggingWriteStop(local, "ID3D12Device_CreateDescriptorHeap", TLArg(result));
+
+            return result;
+        }
+
         DECLARE_DETOUR_FUNCTION(static void,
                                 STDMETHODCALLTYPE,
                                 ID3D12GraphicsCommandList_OMSetRenderTargets,
@@ -2271,6 +2706,94 @@ namespace {
 
             TraceLoggingWriteStop(local, "ID3D12GraphicsCommandList_CopyTextureRegion");
         }
+
+        DECLARE_DETOUR_FUNCTION(static HRESULT,
+                                STDMETHODCALLTYPE,
+                                ID3D12GraphicsCommandList_Close,
+                                ID3D12GraphicsCommandList* Context) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local, "ID3D12GraphicsCommandList_Close", TLPArg(Context));
+
+            assert(g_instance);
+            g_instance->onCloseCommandList(Context);
+
+            assert(g_original_ID3D12GraphicsCommandList_Close);
+            const HRESULT result = g_original_ID3D12GraphicsCommandList_Close(Context);
+
+            TraceLoggingWriteStop(local, "ID3D12GraphicsCommandList_Close", TLArg(result));
+
+            return result;
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D12CommandQueue_ExecuteCommandLists,
+                                ID3D12CommandQueue* Queue,
+                                UINT NumCommandLists,
+                                ID3D12CommandList* const* ppCommandLists) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(
+                local, "ID3D12CommandQueue_ExecuteCommandLists", TLPArg(Queue), TLArg(NumCommandLists));
+
+            assert(g_instance);
+            g_instance->onExecuteCommandLists(Queue, NumCommandLists, ppCommandLists);
+
+            assert(g_original_ID3D12CommandQueue_ExecuteCommandLists);
+            g_original_ID3D12CommandQueue_ExecuteCommandLists(Queue, NumCommandLists, ppCommandLists);
+
+            TraceLoggingWriteStop(local, "ID3D12CommandQueue_ExecuteCommandLists");
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D12GraphicsCommandList5_RSSetShadingRate,
+                                ID3D12GraphicsCommandList5* Context,
+                                D3D12_SHADING_RATE baseShadingRate,
+                                const D3D12_SHADING_RATE_COMBINER* combiners) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "ID3D12GraphicsCommandList5_RSSetShadingRate",
+                                   TLPArg(Context),
+                                   TLArg((int)baseShadingRate, "BaseShadingRate"));
+
+            assert(g_original_ID3D12GraphicsCommandList5_RSSetShadingRate);
+            g_original_ID3D12GraphicsCommandList5_RSSetShadingRate(Context, baseShadingRate, combiners);
+
+            ShadingRateCommand command;
+            command.baseRate = baseShadingRate;
+            if (combiners) {
+                std::copy_n(combiners, std::size(command.combiners), command.combiners);
+            }
+
+            assert(g_instance);
+            g_instance->onSetShadingRate(Context, command);
+
+            TraceLoggingWriteStop(local, "ID3D12GraphicsCommandList5_RSSetShadingRate");
+        }
+
+        DECLARE_DETOUR_FUNCTION(static void,
+                                STDMETHODCALLTYPE,
+                                ID3D12GraphicsCommandList5_RSSetShadingRateImage,
+                                ID3D12GraphicsCommandList5* Context,
+                                ID3D12Resource* shadingRateImage) {
+            TraceLocalActivity(local);
+            TraceLoggingWriteStart(local,
+                                   "ID3D12GraphicsCommandList5_RSSetShadingRateImage",
+                                   TLPArg(Context),
+                                   TLPArg(shadingRateImage));
+
+            assert(g_original_ID3D12GraphicsCommandList5_RSSetShadingRateImage);
+            g_original_ID3D12GraphicsCommandList5_RSSetShadingRateImage(Context, shadingRateImage);
+
+            ShadingRateCommand command;
+            command.isImage = true;
+            command.image = shadingRateImage;
+
+            assert(g_instance);
+            g_instance->onSetShadingRate(Context, command);
+
+            TraceLoggingWriteStop(local, "ID3D12GraphicsCommandList5_RSSetShadingRateImage");
+        }
     };
 
 } // namespace
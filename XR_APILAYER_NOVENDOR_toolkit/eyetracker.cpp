@@ -39,10 +39,82 @@ namespace {
 
     using namespace xr::math;
 
+    // Classifies the eye movements from the angular velocity of the gaze and the validity of the samples. The vision
+    // is suppressed during saccades and blinks, which lets the foveated rendering hold its state until the next
+    // fixation. The detector only depends on its input samples, so it can be replayed over recorded gaze traces.
+    class EyeMovementDetector {
+      public:
+        // Velocities are in degrees per second, durations in seconds.
+        static constexpr float SaccadeOnsetVelocity = 100.f;
+        static constexpr float SaccadeEndVelocity = 50.f;
+        static constexpr double SaccadeMaxDuration = 0.15;
+        static constexpr double BlinkMaxDuration = 0.5;
+
+        EyeMovement update(bool isValid, const XrVector3f& gazeDirection, double time) {
+            if (!isValid) {
+                if (!m_invalidSince) {
+                    m_invalidSince = time;
+                }
+                m_hasLastSample = false;
+                m_velocity = 0.f;
+
+                // A longer loss of tracking is not a blink.
+                m_movement =
+                    time - m_invalidSince.value() < BlinkMaxDuration ? EyeMovement::Blink : EyeMovement::Fixation;
+                return m_movement;
+            }
+            m_invalidSince.reset();
+
+            // Some trackers are slower than the frame rate.
+            if (m_hasLastSample && time <= m_lastTime) {
+                return m_movement;
+            }
+
+            m_velocity = 0.f;
+            if (m_hasLastSample) {
+                const auto cosAngle =
+                    std::clamp(DirectX::XMVectorGetX(DirectX::XMVector3Dot(LoadXrVector3(gazeDirection),
+                                                                             LoadXrVector3(m_lastDirection))),
+                               -1.f,
+                               1.f);
+                m_velocity = DirectX::XMConvertToDegrees(std::acos(cosAngle)) / static_cast<float>(time - m_lastTime);
+            }
+            m_lastDirection = gazeDirection;
+            m_lastTime = time;
+            m_hasLastSample = true;
+
+            if (m_movement != EyeMovement::Saccade) {
+                m_movement = m_velocity > SaccadeOnsetVelocity ? EyeMovement::Saccade : EyeMovement::Fixation;
+                m_saccadeStart = time;
+            } else if (m_velocity < SaccadeEndVelocity || time - m_saccadeStart > SaccadeMaxDuration) {
+                m_movement = EyeMovement::Fixation;
+            }
+
+            return m_movement;
+        }
+
+        float getVelocity() const {
+            return m_velocity;
+        }
+
+      private:
+        EyeMovement m_movement{EyeMovement::Fixation};
+        float m_velocity{0.f};
+
+        bool m_hasLastSample{false};
+        XrVector3f m_lastDirection{};
+        double m_lastTime{0};
+        double m_saccadeStart{0};
+        std::optional<double> m_invalidSince;
+    };
+
     class EyeTrackerBase : public IEyeTracker {
       public:
         EyeTrackerBase(OpenXrApi& openXR, std::shared_ptr<IConfigManager> configManager, EyeTrackerType trackerType)
             : m_openXR(openXR), m_configManager(configManager), m_trackerType(trackerType) {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            m_performanceFrequency = static_cast<double>(frequency.QuadPart);
         }
 
         ~EyeTrackerBase() override {
@@ -52,6 +124,13 @@ namespace {
         // Derived classes implement tracker specific eye gaze retrieval here.
         virtual bool getEyeGaze(XrVector3f& projectedPoint) const = 0;
 
+        // Derived classes receiving their samples asynchronously return the time of the last sample here.
+        virtual LARGE_INTEGER getEyeGazeTime() const {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            return now;
+        }
+
         // Because it requires creating a few tracker specific resources in order to detect which are available,
         // we auto-detect their availability by creation but defer initialization only when needed.
         bool initialize() override {
@@ -65,6 +144,7 @@ namespace {
             referenceSpaceCreateInfo.poseInReferenceSpace = Pose::Identity();
             CHECK_XRCMD(m_openXR.xrCreateReferenceSpace(session, &referenceSpaceCreateInfo, &m_viewSpace));
             m_session = session;
+            m_eyeMovementDetector = {};
         }
 
         void endSession() override {
@@ -126,8 +206,10 @@ namespace {
                 }
 
                 if (!getEyeGaze(m_eyeGazeState.gazeRay)) {
+                    updateEyeMovement(false);
                     return false;
                 }
+                updateEyeMovement(true);
 
                 // Project the pose onto the screen.
 
@@ -176,7 +258,34 @@ namespace {
             return m_eyeGazeState;
         }
 
+        bool getGazeSample(XrVector3f& gazeDirection, LARGE_INTEGER& sampleTime) const override {
+            XrVector3f projectedPoint;
+            if (!getEyeGaze(projectedPoint)) {
+                return false;
+            }
+
+            StoreXrVector3(&gazeDirection, DirectX::XMVector3Normalize(LoadXrVector3(projectedPoint)));
+            sampleTime = getEyeGazeTime();
+
+            return true;
+        }
+
       protected:
+        void updateEyeMovement(bool isValid) const {
+            LARGE_INTEGER time;
+            XrVector3f gazeDirection{};
+            if (isValid) {
+                time = getEyeGazeTime();
+                StoreXrVector3(&gazeDirection, DirectX::XMVector3Normalize(LoadXrVector3(m_eyeGazeState.gazeRay)));
+            } else {
+                QueryPerformanceCounter(&time);
+            }
+
+            m_eyeGazeState.movement =
+                m_eyeMovementDetector.update(isValid, gazeDirection, time.QuadPart / m_performanceFrequency);
+            m_eyeGazeState.angularVelocity = m_eyeMovementDetector.getVelocity();
+        }
+
         OpenXrApi& m_openXR;
         const std::shared_ptr<IConfigManager> m_configManager;
         float m_projectionDistance{2.f};
@@ -191,6 +300,9 @@ namespace {
 
         mutable XrVector2f m_gaze[ViewCount];
         mutable EyeGazeState m_eyeGazeState{};
+
+        double m_performanceFrequency;
+        mutable EyeMovementDetector m_eyeMovementDetector;
     };
 
     class OpenXrEyeTracker : public EyeTrackerBase {
@@ -416,7 +528,13 @@ namespace {
                 return false;
             }
 
-            // TODO: Use timestamp to implement a timeout.
+            // Discard stale samples, eg: when the eyes cannot be tracked.
+            LARGE_INTEGER now, frequency;
+            QueryPerformanceCounter(&now);
+            QueryPerformanceFrequency(&frequency);
+            if ((now.QuadPart - m_lastSampleTime.QuadPart) * 1000 > frequency.QuadPart * kSampleTimeoutMs) {
+                return false;
+            }
 
             // We assume the point is projected onto a screen at Z=-1
             projectedPoint.x = m_recommendedGaze.x - 0.5f;
@@ -430,6 +548,10 @@ namespace {
             return true;
         }
 
+        LARGE_INTEGER getEyeGazeTime() const override {
+            return m_lastSampleTime;
+        }
+
       private:
         void setCoefficients(const aSeeVRCoefficient& coefficients) {
             m_coefficients = coefficients;
@@ -444,6 +566,7 @@ namespace {
         void setEyeData(int64_t timestamp, float recommendedGazeX, float recommendedGazeY) {
             m_recommendedGaze = {recommendedGazeX, recommendedGazeY};
             m_lastTimestamp = timestamp;
+            QueryPerformanceCounter(&m_lastSampleTime);
         }
 
         void shutdown() {
@@ -455,6 +578,9 @@ namespace {
         bool m_isDeviceReady{false};
         XrVector2f m_recommendedGaze{0, 0};
         int64_t m_lastTimestamp{0};
+        LARGE_INTEGER m_lastSampleTime{};
+
+        static constexpr LONGLONG kSampleTimeoutMs = 100;
 
         static void _7INVENSUN_CALL stateCallback(const aSeeVRState* state, void* context) {
             switch (state->code) {
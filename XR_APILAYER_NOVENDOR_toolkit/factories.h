@@ -39,6 +39,20 @@ namespace toolkit {
 
         uint32_t GetScaledInputSize(uint32_t outputSize, int scalePercent, uint32_t blockSize);
 
+        // Shader tuning helper: index of the variant with the lowest median timing. The default variant is kept unless
+        // another one is faster by at least minGainPercent.
+        size_t SelectFastestVariant(const std::vector<std::vector<uint64_t>>& timings,
+                                    size_t defaultVariant,
+                                    float minGainPercent);
+
+        // Quad views helpers: size is the fraction of the tangent-space extent covered by the focus view.
+        XrFovf GetFocusFov(const XrFovf& fullFov, const XrVector2f& centerNdc, float size);
+        XrVector4f GetFocusArea(const XrFovf& fullFov, const XrFovf& focusFov);
+
+        // XR_FB_foveation helper: VRS rings and rates for a foveation level (none when the level is NONE).
+        std::optional<graphics::VariableRateShaderFoveation>
+        GetFoveationForLevel(XrFoveationLevelFB level, float verticalOffsetDegrees, const XrFovf& fov, bool eyeTracked);
+
         bool UpdateKeyState(bool& keyState, const std::vector<int>& vkModifiers, int vkKey, bool isRepeat);
 
         void ToggleWindowsMixedRealityReprojection(config::MotionReprojection enable);
@@ -46,6 +60,17 @@ namespace toolkit {
 
         bool IsServiceRunning(const std::string& name);
 
+        std::shared_ptr<ISystemUsageProvider> CreatePdhSystemUsageProvider();
+        std::shared_ptr<ISystemMonitor> CreateSystemMonitor(std::shared_ptr<ISystemUsageProvider> provider,
+                                                            std::chrono::milliseconds period);
+
+        std::shared_ptr<IPerformanceHistory> CreatePerformanceHistory(const std::filesystem::path& path,
+                                                                      const SessionSummary& environment);
+        PerformanceRegression ComparePerformance(const std::vector<SessionSummary>& history,
+                                                 const SessionSummary& current);
+
+        std::shared_ptr<ICircuitBreaker> CreateCircuitBreaker();
+
         // A CPU synchronous timer.
         struct CpuTimer {
           public:
@@ -63,6 +88,8 @@ namespace toolkit {
 
         std::shared_ptr<IConfigManager> CreateConfigManager(const std::string& appName);
 
+        std::shared_ptr<IProfileComparator> CreateProfileComparator(std::shared_ptr<IConfigManager> configManager);
+
         std::pair<uint32_t, uint32_t> GetScaledDimensions(const IConfigManager* configManager,
                                                           uint32_t outputWidth,
                                                           uint32_t outputHeight,
@@ -102,8 +129,15 @@ namespace toolkit {
                                                                      XrSwapchain swapchain,
                                                                      std::string_view debugName);
 
-        std::shared_ptr<IFrameAnalyzer> CreateFrameAnalyzer(
-            std::shared_ptr<toolkit::config::IConfigManager> configManager, std::shared_ptr<IDevice> graphicsDevice);
+        std::shared_ptr<IShaderTuner> CreateShaderTuner(std::shared_ptr<IDevice> graphicsDevice,
+                                                        const std::string& name,
+                                                        size_t numVariants,
+                                                        size_t defaultVariant);
+
+        std::shared_ptr<IFrameAnalyzer> CreateFrameAnalyzer(std::shared_ptr<toolkit::config::IConfigManager> configManager,
+                                                            std::shared_ptr<IDevice> graphicsDevice,
+                                                            uint32_t renderWidth,
+                                                            uint32_t renderHeight);
 
         std::shared_ptr<IImageProcessor>
         CreateImageProcessor(std::shared_ptr<toolkit::config::IConfigManager> configManager,
@@ -114,6 +148,8 @@ namespace toolkit {
                              uint32_t displayWidth,
                              uint32_t displayHeight);
 
+        std::shared_ptr<IImageProcessor> CreatePassThroughScaler(std::shared_ptr<IDevice> graphicsDevice);
+
         std::shared_ptr<IImageProcessor>
         CreateNISUpscaler(std::shared_ptr<toolkit::config::IConfigManager> configManager,
                           std::shared_ptr<IDevice> graphicsDevice,
@@ -130,6 +166,12 @@ namespace toolkit {
                           uint32_t displayWidth,
                           uint32_t displayHeight);
 
+        std::shared_ptr<ICenterWeightedUpscaler>
+        CreateCenterWeightedUpscaler(std::shared_ptr<toolkit::config::IConfigManager> configManager,
+                                     std::shared_ptr<IDevice> graphicsDevice,
+                                     uint32_t renderWidth,
+                                     uint32_t renderHeight);
+
         std::shared_ptr<IVariableRateShader>
         CreateVariableRateShader(std::shared_ptr<toolkit::config::IConfigManager> configManager,
                                  std::shared_ptr<IDevice> graphicsDevice,
@@ -140,6 +182,10 @@ namespace toolkit {
                                  uint32_t displayHeight,
                                  bool isPimaxFovHackSupported);
 
+        std::shared_ptr<IQuadViewsCompositor>
+        CreateQuadViewsCompositor(std::shared_ptr<toolkit::config::IConfigManager> configManager,
+                                  std::shared_ptr<IDevice> graphicsDevice);
+
         bool IsDeviceSupportingFP16(std::shared_ptr<IDevice> device);
 
         GpuArchitecture GetGpuArchitecture(UINT VendorId);
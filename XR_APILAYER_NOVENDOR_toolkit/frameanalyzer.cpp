@@ -36,8 +36,12 @@ namespace {
 
     class FrameAnalyzer : public IFrameAnalyzer {
       public:
-        FrameAnalyzer(std::shared_ptr<IConfigManager> configManager, std::shared_ptr<IDevice> graphicsDevice)
-            : m_configManager(configManager), m_device(graphicsDevice) {
+        FrameAnalyzer(std::shared_ptr<IConfigManager> configManager,
+                      std::shared_ptr<IDevice> graphicsDevice,
+                      uint32_t renderWidth,
+                      uint32_t renderHeight)
+            : m_configManager(configManager), m_device(graphicsDevice), m_renderWidth(renderWidth),
+              m_renderRatio(static_cast<float>(renderWidth) / std::max(renderHeight, 1u)) {
         }
 
         void registerColorSwapchainImage(std::shared_ptr<ITexture> source, Eye eye) override {
@@ -46,42 +50,60 @@ namespace {
 
         void resetForFrame() override {
             // Assumes left eye is first in case we won't be able to tell for sure.
+            std::unique_lock lock(m_contextsLock);
             m_eyePrediction = Eye::Left;
             m_isPredictionValid = m_shouldPredictEye;
+            for (auto& context : m_contexts) {
+                context.second.eyePrediction = m_eyePrediction;
+            }
         }
 
         void prepareForEndFrame() override {
         }
 
-        void onSetRenderTarget(std::shared_ptr<graphics::IContext> context,
-                               std::shared_ptr<ITexture> renderTarget) override {
-            if (renderTarget->getInfo().arraySize != 1) {
-                return;
-            }
+        void onSetRenderTarget(const std::shared_ptr<graphics::IContext>& context,
+                               const std::shared_ptr<ITexture>& renderTarget) override {
+            const auto& info = renderTarget->getInfo();
 
-            const void* const nativePtr = renderTarget->getNativePtr();
+            // Same heuristic as the VRS: the eye views are proportional to the render resolution, and not under 50%
+            // of it. This excludes the shadow maps and most of the post-processing and UI passes.
+            const bool isEyePass = info.arraySize <= 2 && info.width >= (m_renderWidth * 0.51f) &&
+                                   std::abs(static_cast<float>(info.width) / info.height - m_renderRatio) <= 0.01f;
 
             // Handle when the application uses the swapchain image directly.
-            if (m_eyeSwapchainImages[0].find(nativePtr) != m_eyeSwapchainImages[0].cend()) {
-                DebugLog("Detected setting RTV to left eye\n");
-                m_eyePrediction = Eye::Left;
+            std::optional<Eye> detectedEye;
+            if (info.arraySize == 1) {
+                const void* const nativePtr = renderTarget->getNativePtr();
+                if (m_eyeSwapchainImages[0].find(nativePtr) != m_eyeSwapchainImages[0].cend()) {
+                    DebugLog("Detected setting RTV to left eye\n");
+                    detectedEye = Eye::Left;
+                } else if (m_eyeSwapchainImages[1].find(nativePtr) != m_eyeSwapchainImages[1].cend()) {
+                    DebugLog("Detected setting RTV to right eye\n");
+                    detectedEye = Eye::Right;
+                }
+            }
 
-                // We are confident our prediction is accurate.
-                m_shouldPredictEye = true;
-            } else if (m_eyeSwapchainImages[1].find(nativePtr) != m_eyeSwapchainImages[1].cend()) {
-                DebugLog("Detected setting RTV to right eye\n");
-                m_eyePrediction = Eye::Right;
+            updateContextState(context, [&](ContextState& state) {
+                state.isEyePass = isEyePass;
+                if (detectedEye) {
+                    state.eyePrediction = *detectedEye;
+                    state.hasDetectedEye = true;
+                }
+            });
 
+            if (detectedEye) {
                 // We are confident our prediction is accurate.
                 m_shouldPredictEye = true;
             }
         }
 
-        void onUnsetRenderTarget(std::shared_ptr<graphics::IContext> context) override {
+        void onUnsetRenderTarget(const std::shared_ptr<graphics::IContext>& context) override {
+            updateContextState(context, [](ContextState& state) { state.isEyePass = false; });
         }
 
-        void onCopyTexture(std::shared_ptr<ITexture> src,
-                           std::shared_ptr<ITexture> dst,
+        void onCopyTexture(const std::shared_ptr<graphics::IContext>& context,
+                           const std::shared_ptr<ITexture>& src,
+                           const std::shared_ptr<ITexture>& dst,
                            int srcSlice = -1,
                            int dstSlice = -1) override {
             if (dst->getInfo().arraySize != 1) {
@@ -96,7 +118,10 @@ namespace {
                 DebugLog("Detected copy-out to left eye\n");
 
                 // Switch to right eye now.
-                m_eyePrediction = Eye::Right;
+                updateContextState(context, [](ContextState& state) {
+                    state.eyePrediction = Eye::Right;
+                    state.hasDetectedEye = true;
+                });
 
                 // We are confident our prediction is accurate.
                 m_shouldPredictEye = true;
@@ -108,27 +133,80 @@ namespace {
 #endif
         }
 
-        Eye getEyeHint() const override {
-            return m_isPredictionValid ? m_eyePrediction : Eye::Both;
+        void onExecuteContexts(const std::vector<const void*>& contexts) override {
+            // Replay the eye detected by each command list in submission order, so that the lists recorded next
+            // start from the eye following the last one submitted.
+            std::unique_lock lock(m_contextsLock);
+            for (const auto context : contexts) {
+                auto it = m_contexts.find(context);
+                if (it == m_contexts.end()) {
+                    continue;
+                }
+                if (it->second.hasDetectedEye) {
+                    m_eyePrediction = it->second.eyePrediction;
+                }
+                m_contexts.erase(it);
+            }
+        }
+
+        Eye getEyeHint(const std::shared_ptr<graphics::IContext>& context) const override {
+            std::unique_lock lock(m_contextsLock);
+            if (!m_isPredictionValid) {
+                return Eye::Both;
+            }
+            const auto it = m_contexts.find(context->getNativePtr());
+            return it != m_contexts.cend() ? it->second.eyePrediction : m_eyePrediction;
+        }
+
+        bool isEyePass(const std::shared_ptr<graphics::IContext>& context) const override {
+            std::unique_lock lock(m_contextsLock);
+            const auto it = m_contexts.find(context->getNativePtr());
+            return it != m_contexts.cend() && it->second.isEyePass;
         }
 
       private:
+        // The state of a context (or command list) while it is being recorded. Multithreaded engines record their
+        // command lists concurrently, so each one makes its own predictions until it is submitted.
+        struct ContextState {
+            Eye eyePrediction{Eye::Left};
+            bool hasDetectedEye{false};
+            bool isEyePass{false};
+        };
+
+        // The entries may be reset or erased concurrently: only access them while holding the lock.
+        template <typename Update>
+        void updateContextState(const std::shared_ptr<graphics::IContext>& context, Update&& update) {
+            std::unique_lock lock(m_contextsLock);
+            auto it = m_contexts.find(context->getNativePtr());
+            if (it == m_contexts.end()) {
+                it = m_contexts.insert_or_assign(context->getNativePtr(), ContextState{m_eyePrediction}).first;
+            }
+            update(it->second);
+        }
+
         const std::shared_ptr<IConfigManager> m_configManager;
         const std::shared_ptr<IDevice> m_device;
+        const uint32_t m_renderWidth;
+        const float m_renderRatio;
 
         std::set<const void*> m_eyeSwapchainImages[ViewCount];
 
-        bool m_shouldPredictEye{false};
+        std::atomic<bool> m_shouldPredictEye{false};
         bool m_isPredictionValid{false};
-        Eye m_eyePrediction;
+        Eye m_eyePrediction{Eye::Left};
+
+        mutable std::mutex m_contextsLock;
+        std::map<const void*, ContextState> m_contexts;
     };
 
 } // namespace
 
 namespace toolkit::graphics {
     std::shared_ptr<IFrameAnalyzer> CreateFrameAnalyzer(std::shared_ptr<IConfigManager> configManager,
-                                                        std::shared_ptr<IDevice> graphicsDevice) {
-        return std::make_shared<FrameAnalyzer>(configManager, graphicsDevice);
+                                                        std::shared_ptr<IDevice> graphicsDevice,
+                                                        uint32_t renderWidth,
+                                                        uint32_t renderHeight) {
+        return std::make_shared<FrameAnalyzer>(configManager, graphicsDevice, renderWidth, renderHeight);
     }
 
 } // namespace toolkit::graphics
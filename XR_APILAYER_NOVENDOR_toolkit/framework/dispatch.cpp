@@ -38,6 +38,101 @@ namespace LAYER_NAMESPACE {
 
     PFN_xrGetInstanceProcAddr g_bypass = nullptr;
 
+    namespace {
+
+        // The extensions advertised by our manifest and emulated by the layer when the OpenXR runtime or an upstream
+        // API layer does not implement them.
+        const std::set<std::string> EmulatedExtensions = {"XR_VARJO_quad_views",
+                                                          "XR_VARJO_foveated_rendering",
+                                                          "XR_FB_foveation",
+                                                          "XR_FB_foveation_configuration",
+                                                          "XR_FB_swapchain_update_state",
+                                                          "XR_META_foveation_eye_tracked",
+                                                          "XR_EXT_eye_gaze_interaction"};
+
+        bool requestsEmulatedExtensions(const XrInstanceCreateInfo& createInfo) {
+            for (uint32_t i = 0; i < createInfo.enabledExtensionCount; i++) {
+                if (EmulatedExtensions.count(createInfo.enabledExtensionNames[i])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Query the extensions supported by the runtime and/or an upstream API layer.
+        //
+        // Workaround: per specification, we should be able to retrive the pointer to
+        // xrEnumerateInstanceExtensionProperties() without an XrInstance. However, some API layers (eg: Ultraleap) do
+        // not seem to properly handle this case. So we create a dummy instance.
+        std::optional<std::set<std::string>> queryRuntimeExtensions(const XrInstanceCreateInfo& createInfo,
+                                                                    const XrApiLayerCreateInfo& apiLayerInfo) {
+            XrInstance dummyInstance = XR_NULL_HANDLE;
+            PFN_xrEnumerateInstanceExtensionProperties xrEnumerateInstanceExtensionProperties = nullptr;
+            PFN_xrDestroyInstance xrDestroyInstance = nullptr;
+
+            // Try to speed things up by requesting no extentions.
+            XrInstanceCreateInfo dummyCreateInfo = createInfo;
+            dummyCreateInfo.enabledExtensionCount = dummyCreateInfo.enabledApiLayerCount = 0;
+
+            // Call the chain to create the dummy instance.
+            XrApiLayerCreateInfo chainApiLayerInfo = apiLayerInfo;
+            chainApiLayerInfo.nextInfo = apiLayerInfo.nextInfo->next;
+
+            const XrResult result = apiLayerInfo.nextInfo->nextCreateApiLayerInstance(
+                &dummyCreateInfo, &chainApiLayerInfo, &dummyInstance);
+            if (result != XR_SUCCESS) {
+                TraceLoggingWrite(
+                    g_traceProvider, "xrCreateApiLayerInstance_Error_CreateInstance", TLArg((int)result, "Result"));
+                Log("Failed to create bootstrap instance: %d\n", result);
+                return {};
+            }
+
+            CHECK_XRCMD(apiLayerInfo.nextInfo->nextGetInstanceProcAddr(
+                dummyInstance,
+                "xrEnumerateInstanceExtensionProperties",
+                reinterpret_cast<PFN_xrVoidFunction*>(&xrEnumerateInstanceExtensionProperties)));
+            CHECK_XRCMD(apiLayerInfo.nextInfo->nextGetInstanceProcAddr(
+                dummyInstance, "xrDestroyInstance", reinterpret_cast<PFN_xrVoidFunction*>(&xrDestroyInstance)));
+
+            uint32_t extensionsCount = 0;
+            CHECK_XRCMD(xrEnumerateInstanceExtensionProperties(nullptr, 0, &extensionsCount, nullptr));
+            std::vector<XrExtensionProperties> extensions(extensionsCount, {XR_TYPE_EXTENSION_PROPERTIES});
+            CHECK_XRCMD(
+                xrEnumerateInstanceExtensionProperties(nullptr, extensionsCount, &extensionsCount, extensions.data()));
+
+            xrDestroyInstance(dummyInstance);
+
+            std::set<std::string> extensionNames;
+            for (const auto& extension : extensions) {
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrCreateApiLayerInstance_HasExtension",
+                                  TLArg(extension.extensionName, "Extension"));
+                Log("Runtime supports extension: %s\n", extension.extensionName);
+                extensionNames.insert(extension.extensionName);
+            }
+            return extensionNames;
+        }
+
+        // Do not forward the emulated extensions that the OpenXR runtime or an upstream API layer does not implement.
+        // When the runtime extensions could not be queried, none of them is forwarded.
+        std::vector<const char*>
+        filterEmulatedExtensions(const XrInstanceCreateInfo& createInfo,
+                                 const std::optional<std::set<std::string>>& runtimeExtensions) {
+            std::vector<const char*> extensionNames;
+            for (uint32_t i = 0; i < createInfo.enabledExtensionCount; i++) {
+                const std::string extensionName(createInfo.enabledExtensionNames[i]);
+                if (EmulatedExtensions.count(extensionName) &&
+                    (!runtimeExtensions || !runtimeExtensions->count(extensionName))) {
+                    Log("%s is not forwarded to the OpenXR runtime\n", createInfo.enabledExtensionNames[i]);
+                    continue;
+                }
+                extensionNames.push_back(createInfo.enabledExtensionNames[i]);
+            }
+            return extensionNames;
+        }
+
+    } // namespace
+
     // Entry point for creating the layer.
     XrResult xrCreateApiLayerInstance(const XrInstanceCreateInfo* const instanceCreateInfo,
                                       const struct XrApiLayerCreateInfo* const apiLayerInfo,
@@ -87,11 +182,23 @@ namespace LAYER_NAMESPACE {
                 // TODO: What if an application creates multiple instances with different names.
                 g_bypass = apiLayerInfo->nextInfo->nextGetInstanceProcAddr;
 
+                // Our manifest advertises the emulated extensions, but we will not emulate them. Only forward those
+                // that the OpenXR runtime implements.
+                XrInstanceCreateInfo chainInstanceCreateInfo = *instanceCreateInfo;
+                std::vector<const char*> newEnabledExtensionNames;
+                if (requestsEmulatedExtensions(*instanceCreateInfo)) {
+                    newEnabledExtensionNames = filterEmulatedExtensions(
+                        *instanceCreateInfo, queryRuntimeExtensions(*instanceCreateInfo, *apiLayerInfo));
+                    chainInstanceCreateInfo.enabledExtensionCount =
+                        static_cast<uint32_t>(newEnabledExtensionNames.size());
+                    chainInstanceCreateInfo.enabledExtensionNames = newEnabledExtensionNames.data();
+                }
+
                 // Call the chain to create the instance, and nothing else.
                 XrApiLayerCreateInfo chainApiLayerInfo = *apiLayerInfo;
                 chainApiLayerInfo.nextInfo = apiLayerInfo->nextInfo->next;
                 return apiLayerInfo->nextInfo->nextCreateApiLayerInstance(
-                    instanceCreateInfo, &chainApiLayerInfo, instance);
+                    &chainInstanceCreateInfo, &chainApiLayerInfo, instance);
             }
         }
 
@@ -101,22 +208,8 @@ namespace LAYER_NAMESPACE {
             std::string(instanceCreateInfo->applicationInfo.engineName) == "OpenXRDeveloperTools";
 
         // Check that the extensions we need are supported by the runtime and/or an upstream API layer.
-        //
-        // Workaround: per specification, we should be able to retrive the pointer to
-        // xrEnumerateInstanceExtensionProperties() without an XrInstance. However, some API layers (eg: Ultraleap) do
-        // not seem to properly handle this case. So we create a dummy instance.
-        bool hasHandTrackingExt = false;
-        bool hasEyeTrackingExt = false;
-        bool hasConvertPerformanceCounterTimeExt = false;
+        std::optional<std::set<std::string>> runtimeExtensions;
         if (!fastInitialization) {
-            XrInstance dummyInstance = XR_NULL_HANDLE;
-            PFN_xrEnumerateInstanceExtensionProperties xrEnumerateInstanceExtensionProperties = nullptr;
-            PFN_xrDestroyInstance xrDestroyInstance = nullptr;
-
-            // Try to speed things up by requesting no extentions.
-            XrInstanceCreateInfo dummyCreateInfo = *instanceCreateInfo;
-            dummyCreateInfo.enabledExtensionCount = dummyCreateInfo.enabledApiLayerCount = 0;
-
             {
                 // Workaround: the Vive API layers are not compliant with xrEnumerateInstanceExtensionProperties()
                 // specification and the ability to pass NULL in the first argument.
@@ -140,93 +233,48 @@ namespace LAYER_NAMESPACE {
                 }
             }
 
-            // Call the chain to create the dummy instance.
-            XrApiLayerCreateInfo chainApiLayerInfo = *apiLayerInfo;
-            chainApiLayerInfo.nextInfo = apiLayerInfo->nextInfo->next;
-
-            const XrResult result = apiLayerInfo->nextInfo->nextCreateApiLayerInstance(
-                &dummyCreateInfo, &chainApiLayerInfo, &dummyInstance);
-            if (result == XR_SUCCESS) {
-                CHECK_XRCMD(apiLayerInfo->nextInfo->nextGetInstanceProcAddr(
-                    dummyInstance,
-                    "xrEnumerateInstanceExtensionProperties",
-                    reinterpret_cast<PFN_xrVoidFunction*>(&xrEnumerateInstanceExtensionProperties)));
-                CHECK_XRCMD(apiLayerInfo->nextInfo->nextGetInstanceProcAddr(
-                    dummyInstance, "xrDestroyInstance", reinterpret_cast<PFN_xrVoidFunction*>(&xrDestroyInstance)));
-            } else {
-                TraceLoggingWriteTagged(
-                    local, "xrCreateApiLayerInstance_Error_CreateInstance", TLArg((int)result, "Result"));
-                Log("Failed to create bootstrap instance: %d\n", result);
-            }
-
-            if (xrEnumerateInstanceExtensionProperties) {
-                uint32_t extensionsCount = 0;
-                CHECK_XRCMD(xrEnumerateInstanceExtensionProperties(nullptr, 0, &extensionsCount, nullptr));
-                std::vector<XrExtensionProperties> extensions(extensionsCount, {XR_TYPE_EXTENSION_PROPERTIES});
-                CHECK_XRCMD(xrEnumerateInstanceExtensionProperties(
-                    nullptr, extensionsCount, &extensionsCount, extensions.data()));
-                for (auto extension : extensions) {
-                    const std::string extensionName(extension.extensionName);
-
-                    TraceLoggingWriteTagged(
-                        local, "xrCreateApiLayerInstance_HasExtension", TLArg(extension.extensionName, "Extension"));
-                    Log("Runtime supports extension: %s\n", extension.extensionName);
-                    if (extensionName == "XR_EXT_hand_tracking") {
-                        hasHandTrackingExt = true;
-                    } else if (extensionName == "XR_EXT_eye_gaze_interaction") {
-                        hasEyeTrackingExt = true;
-                    } else if (extensionName == "XR_KHR_win32_convert_performance_counter_time") {
-                        hasConvertPerformanceCounterTimeExt = true;
-                    }
-                }
-            } else {
+            runtimeExtensions = queryRuntimeExtensions(*instanceCreateInfo, *apiLayerInfo);
+            if (!runtimeExtensions) {
                 Log("Failed to query extensions\n");
             }
+        }
+        const auto hasRuntimeExtension = [&](const char* extensionName) {
+            return runtimeExtensions && runtimeExtensions->count(extensionName);
+        };
 
-            if (xrDestroyInstance) {
-                xrDestroyInstance(dummyInstance);
+        // Strip the emulated extensions in all cases, including when the runtime extensions are unknown.
+        XrInstanceCreateInfo chainInstanceCreateInfo = *instanceCreateInfo;
+        std::vector<const char*> newEnabledExtensionNames =
+            filterEmulatedExtensions(*instanceCreateInfo, runtimeExtensions);
+        const auto enableExtension = [&](const char* extensionName) {
+            if (std::find_if(newEnabledExtensionNames.cbegin(),
+                             newEnabledExtensionNames.cend(),
+                             [&](const char* name) { return std::string_view(name) == extensionName; }) ==
+                newEnabledExtensionNames.cend()) {
+                newEnabledExtensionNames.push_back(extensionName);
             }
-        }
+        };
 
         // Add the extra extensions to the list of requested extensions when available.
-        XrInstanceCreateInfo chainInstanceCreateInfo = *instanceCreateInfo;
-        std::vector<const char*> newEnabledExtensionNames;
         if (!fastInitialization) {
-            if (hasHandTrackingExt || hasEyeTrackingExt || hasConvertPerformanceCounterTimeExt) {
-                if (hasHandTrackingExt) {
-                    chainInstanceCreateInfo.enabledExtensionCount++;
-                }
-                if (hasEyeTrackingExt) {
-                    chainInstanceCreateInfo.enabledExtensionCount++;
-                }
-                if (hasConvertPerformanceCounterTimeExt) {
-                    chainInstanceCreateInfo.enabledExtensionCount++;
-                }
-
-                newEnabledExtensionNames.resize(chainInstanceCreateInfo.enabledExtensionCount);
-                chainInstanceCreateInfo.enabledExtensionNames = newEnabledExtensionNames.data();
-                memcpy(newEnabledExtensionNames.data(),
-                       instanceCreateInfo->enabledExtensionNames,
-                       instanceCreateInfo->enabledExtensionCount * sizeof(const char*));
-                uint32_t nextExtensionSlot = instanceCreateInfo->enabledExtensionCount;
-
-                if (hasHandTrackingExt) {
-                    newEnabledExtensionNames[nextExtensionSlot++] = "XR_EXT_hand_tracking";
-                } else {
-                    Log("XR_EXT_hand_tracking is not available from the OpenXR runtime or any upsteam API "
-                        "layer.\n");
-                }
-                if (hasEyeTrackingExt) {
-                    newEnabledExtensionNames[nextExtensionSlot++] = "XR_EXT_eye_gaze_interaction";
-                } else {
-                    Log("XR_EXT_eye_gaze_interaction is not available from the OpenXR runtime or any upsteam API "
-                        "layer.\n");
-                }
-                if (hasConvertPerformanceCounterTimeExt) {
-                    newEnabledExtensionNames[nextExtensionSlot++] = "XR_KHR_win32_convert_performance_counter_time";
-                }
+            if (hasRuntimeExtension("XR_EXT_hand_tracking")) {
+                enableExtension("XR_EXT_hand_tracking");
+            } else {
+                Log("XR_EXT_hand_tracking is not available from the OpenXR runtime or any upsteam API "
+                    "layer.\n");
+            }
+            if (hasRuntimeExtension("XR_EXT_eye_gaze_interaction")) {
+                enableExtension("XR_EXT_eye_gaze_interaction");
+            } else {
+                Log("XR_EXT_eye_gaze_interaction is not available from the OpenXR runtime or any upsteam API "
+                    "layer.\n");
+            }
+            if (hasRuntimeExtension("XR_KHR_win32_convert_performance_counter_time")) {
+                enableExtension("XR_KHR_win32_convert_performance_counter_time");
             }
         }
+        chainInstanceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(newEnabledExtensionNames.size());
+        chainInstanceCreateInfo.enabledExtensionNames = newEnabledExtensionNames.data();
 
         for (uint32_t i = 0; i < chainInstanceCreateInfo.enabledExtensionCount; i++) {
             TraceLoggingWriteTagged(local,
@@ -256,6 +304,10 @@ namespace LAYER_NAMESPACE {
 
             LAYER_NAMESPACE::GetInstance()->SetUpstreamLayers(upstreamLayers);
 
+            std::vector<std::string> grantedExtensions(newEnabledExtensionNames.cbegin(),
+                                                       newEnabledExtensionNames.cend());
+            LAYER_NAMESPACE::GetInstance()->SetGrantedExtensions(grantedExtensions);
+
             result = XR_ERROR_RUNTIME_FAILURE;
 
             // Forward the xrCreateInstance() call to the layer.
@@ -83,6 +83,50 @@ namespace LAYER_NAMESPACE
 		return result;
 	}
 
+	XrResult xrGetSystemProperties(XrInstance instance, XrSystemId systemId, XrSystemProperties* properties)
+	{
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetSystemProperties");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrGetSystemProperties(instance, systemId, properties);
+		}
+		catch (std::exception& exc)
+		{
+			TraceLoggingWriteTagged(local, "xrGetSystemProperties_Error", TLArg(exc.what(), "Error"));
+			Log("xrGetSystemProperties: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetSystemProperties", TLArg((int)result, "Result"));
+
+		return result;
+	}
+
+	XrResult xrEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t environmentBlendModeCapacityInput, uint32_t* environmentBlendModeCountOutput, XrEnvironmentBlendMode* environmentBlendModes)
+	{
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrEnumerateEnvironmentBlendModes");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrEnumerateEnvironmentBlendModes(instance, systemId, viewConfigurationType, environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes);
+		}
+		catch (std::exception& exc)
+		{
+			TraceLoggingWriteTagged(local, "xrEnumerateEnvironmentBlendModes_Error", TLArg(exc.what(), "Error"));
+			Log("xrEnumerateEnvironmentBlendModes: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrEnumerateEnvironmentBlendModes", TLArg((int)result, "Result"));
+
+		return result;
+	}
+
 	XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session)
 	{
 		TraceLocalActivity(local);
@@ -193,6 +237,50 @@ namespace LAYER_NAMESPACE
 		return result;
 	}
 
+	XrResult xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId, uint32_t viewConfigurationTypeCapacityInput, uint32_t* viewConfigurationTypeCountOutput, XrViewConfigurationType* viewConfigurationTypes)
+	{
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrEnumerateViewConfigurations");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrEnumerateViewConfigurations(instance, systemId, viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, viewConfigurationTypes);
+		}
+		catch (std::exception& exc)
+		{
+			TraceLoggingWriteTagged(local, "xrEnumerateViewConfigurations_Error", TLArg(exc.what(), "Error"));
+			Log("xrEnumerateViewConfigurations: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrEnumerateViewConfigurations", TLArg((int)result, "Result"));
+
+		return result;
+	}
+
+	XrResult xrGetViewConfigurationProperties(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, XrViewConfigurationProperties* configurationProperties)
+	{
+		TraceLocalActivity(local);
+		TraceLoggingWriteStart(local, "xrGetViewConfigurationProperties");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrGetViewConfigurationProperties(instance, systemId, viewConfigurationType, configurationProperties);
+		}
+		catch (std::exception& exc)
+		{
+			TraceLoggingWriteTagged(local, "xrGetViewConfigurationProperties_Error", TLArg(exc.what(), "Error"));
+			Log("xrGetViewConfigurationProperties: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWriteStop(local, "xrGetViewConfigurationProperties", TLArg((int)result, "Result"));
+
+		return result;
+	}
+
 	XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrViewConfigurationView* views)
 	{
 		TraceLocalActivity(local);
@@ -746,6 +834,16 @@ namespace LAYER_NAMESPACE
 				m_xrGetSystem = reinterpret_cast<PFN_xrGetSystem>(*function);
 				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetSystem);
 			}
+			else if (apiName == "xrGetSystemProperties")
+			{
+				m_xrGetSystemProperties = reinterpret_cast<PFN_xrGetSystemProperties>(*function);
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetSystemProperties);
+			}
+			else if (apiName == "xrEnumerateEnvironmentBlendModes")
+			{
+				m_xrEnumerateEnvironmentBlendModes = reinterpret_cast<PFN_xrEnumerateEnvironmentBlendModes>(*function);
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEnumerateEnvironmentBlendModes);
+			}
 			else if (apiName == "xrCreateSession")
 			{
 				m_xrCreateSession = reinterpret_cast<PFN_xrCreateSession>(*function);
@@ -771,6 +869,16 @@ namespace LAYER_NAMESPACE
 				m_xrDestroySpace = reinterpret_cast<PFN_xrDestroySpace>(*function);
 				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySpace);
 			}
+			else if (apiName == "xrEnumerateViewConfigurations")
+			{
+				m_xrEnumerateViewConfigurations = reinterpret_cast<PFN_xrEnumerateViewConfigurations>(*function);
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEnumerateViewConfigurations);
+			}
+			else if (apiName == "xrGetViewConfigurationProperties")
+			{
+				m_xrGetViewConfigurationProperties = reinterpret_cast<PFN_xrGetViewConfigurationProperties>(*function);
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetViewConfigurationProperties);
+			}
 			else if (apiName == "xrEnumerateViewConfigurationViews")
 			{
 				m_xrEnumerateViewConfigurationViews = reinterpret_cast<PFN_xrEnumerateViewConfigurationViews>(*function);
@@ -928,6 +1036,10 @@ namespace LAYER_NAMESPACE
 		{
 			throw std::runtime_error("Failed to resolve xrDestroySpace");
 		}
+		if (XR_FAILED(m_xrGetInstanceProcAddr(m_instance, "xrEnumerateViewConfigurations", reinterpret_cast<PFN_xrVoidFunction*>(&m_xrEnumerateViewConfigurations))))
+		{
+			throw std::runtime_error("Failed to resolve xrEnumerateViewConfigurations");
+		}
 		if (XR_FAILED(m_xrGetInstanceProcAddr(m_instance, "xrEnumerateViewConfigurationViews", reinterpret_cast<PFN_xrVoidFunction*>(&m_xrEnumerateViewConfigurationViews))))
 		{
 			throw std::runtime_error("Failed to resolve xrEnumerateViewConfigurationViews");
@@ -36,6 +36,7 @@ namespace LAYER_NAMESPACE
 		XrInstance m_instance{ XR_NULL_HANDLE };
 		std::string m_applicationName;
 		std::vector<std::string> m_upstreamLayers;
+		std::vector<std::string> m_grantedExtensions;
 
 	protected:
 		OpenXrApi() = default;
@@ -71,6 +72,17 @@ namespace LAYER_NAMESPACE
 			return m_upstreamLayers;
 		}
 
+		void SetGrantedExtensions(std::vector<std::string>& grantedExtensions)
+		{
+			m_grantedExtensions = grantedExtensions;
+		}
+
+		// The extensions enabled on the instance of the OpenXR runtime (which exclude the ones we emulate).
+		const std::vector<std::string>& GetGrantedExtensions() const
+		{
+			return m_grantedExtensions;
+		}
+
 		// Specially-handled by the auto-generated code.
 		virtual XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
 		virtual XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo);
@@ -118,6 +130,14 @@ namespace LAYER_NAMESPACE
 	private:
 		PFN_xrGetSystemProperties m_xrGetSystemProperties{ nullptr };
 
+	public:
+		virtual XrResult xrEnumerateEnvironmentBlendModes(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t environmentBlendModeCapacityInput, uint32_t* environmentBlendModeCountOutput, XrEnvironmentBlendMode* environmentBlendModes)
+		{
+			return m_xrEnumerateEnvironmentBlendModes(instance, systemId, viewConfigurationType, environmentBlendModeCapacityInput, environmentBlendModeCountOutput, environmentBlendModes);
+		}
+	private:
+		PFN_xrEnumerateEnvironmentBlendModes m_xrEnumerateEnvironmentBlendModes{ nullptr };
+
 	public:
 		virtual XrResult xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session)
 		{
@@ -166,6 +186,22 @@ namespace LAYER_NAMESPACE
 	private:
 		PFN_xrDestroySpace m_xrDestroySpace{ nullptr };
 
+	public:
+		virtual XrResult xrEnumerateViewConfigurations(XrInstance instance, XrSystemId systemId, uint32_t viewConfigurationTypeCapacityInput, uint32_t* viewConfigurationTypeCountOutput, XrViewConfigurationType* viewConfigurationTypes)
+		{
+			return m_xrEnumerateViewConfigurations(instance, systemId, viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, viewConfigurationTypes);
+		}
+	private:
+		PFN_xrEnumerateViewConfigurations m_xrEnumerateViewConfigurations{ nullptr };
+
+	public:
+		virtual XrResult xrGetViewConfigurationProperties(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, XrViewConfigurationProperties* configurationProperties)
+		{
+			return m_xrGetViewConfigurationProperties(instance, systemId, viewConfigurationType, configurationProperties);
+		}
+	private:
+		PFN_xrGetViewConfigurationProperties m_xrGetViewConfigurationProperties{ nullptr };
+
 	public:
 		virtual XrResult xrEnumerateViewConfigurationViews(XrInstance instance, XrSystemId systemId, XrViewConfigurationType viewConfigurationType, uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrViewConfigurationView* views)
 		{
@@ -285,6 +285,7 @@ namespace LAYER_NAMESPACE
 		XrInstance m_instance{ XR_NULL_HANDLE };
 		std::string m_applicationName;
 		std::vector<std::string> m_upstreamLayers;
+		std::vector<std::string> m_grantedExtensions;
 
 	protected:
 		OpenXrApi() = default;
@@ -320,6 +321,17 @@ namespace LAYER_NAMESPACE
 			return m_upstreamLayers;
 		}
 
+		void SetGrantedExtensions(std::vector<std::string>& grantedExtensions)
+		{
+			m_grantedExtensions = grantedExtensions;
+		}
+
+		// The extensions enabled on the instance of the OpenXR runtime (which exclude the ones we emulate).
+		const std::vector<std::string>& GetGrantedExtensions() const
+		{
+			return m_grantedExtensions;
+		}
+
 		// Specially-handled by the auto-generated code.
 		virtual XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
 		virtual XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo);
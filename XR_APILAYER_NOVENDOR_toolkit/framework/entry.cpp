@@ -78,6 +78,7 @@ XrResult __declspec(dllexport) XRAPI_CALL
     CreateDirectoryA((localAppData / "logs").string().c_str(), nullptr);
     CreateDirectoryA((localAppData / "screenshots").string().c_str(), nullptr);
     CreateDirectoryA((localAppData / "configs").string().c_str(), nullptr);
+    CreateDirectoryA((localAppData / "history").string().c_str(), nullptr);
 
     // Start logging to file.
     if (!logStream.is_open()) {
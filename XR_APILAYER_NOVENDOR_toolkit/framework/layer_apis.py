@@ -1,6 +1,10 @@
 # The list of OpenXR functions our layer will override.
 override_functions = [
     "xrGetSystem",
+    "xrGetSystemProperties",
+    "xrEnumerateEnvironmentBlendModes",
+    "xrEnumerateViewConfigurations",
+    "xrGetViewConfigurationProperties",
     "xrEnumerateViewConfigurationViews",
     "xrCreateSession",
     "xrBeginSession",
@@ -39,6 +43,7 @@ requested_functions = [
     "xrGetSystem",
     "xrGetInstanceProperties",
     "xrGetSystemProperties",
+    "xrEnumerateViewConfigurations",
     "xrEnumerateViewConfigurationViews",
     "xrEnumerateSwapchainFormats",
     "xrCreateSwapchain",
@@ -45,8 +45,16 @@ namespace {
         uint32_t Const2[4];
         uint32_t Const3[4];
         uint32_t Const4[4];
+        uint32_t Const5[4]; // EASU input offset (normalized), output offset
+        uint32_t Const6[4]; // output size, RCAS input offset
     };
 
+    // This value is the image region dimension that each thread group of the FSR shader operates on
+    constexpr uint32_t kThreadGroupWorkRegionDim = 16u;
+
+    // The thread group sizes supported by the FSR shader for a region, that we may pick from when tuning.
+    constexpr uint32_t kThreadGroupSizes[] = {64, 128, 256};
+
     class FSRUpscaler : public IImageProcessor {
       public:
         FSRUpscaler(std::shared_ptr<IConfigManager> configManager,
@@ -71,46 +79,124 @@ namespace {
 
         void update() override {
             if (m_configManager->hasChanged(SettingSharpness)) {
-                updateScaler(m_configManager->getValue(SettingSharpness) / 100.f);
+                m_sharpness = m_configManager->getValue(SettingSharpness) / 100.f;
+                std::fill_n(m_configUpdated, std::size(m_configUpdated), true);
             }
         }
 
-        void process(std::shared_ptr<ITexture> input, std::shared_ptr<ITexture> output, int32_t slice = -1) override {
-            if (!m_intermediary) {
-                const auto& infos = output->getInfo();
+        void process(const std::shared_ptr<ITexture>& input,
+                     const std::shared_ptr<ITexture>& output,
+                     const ProcessingRegion& region) override {
+            const auto& infos = output->getInfo();
+            if (!m_intermediary || m_intermediary->getInfo().width < infos.width ||
+                m_intermediary->getInfo().height < infos.height) {
                 initializeIntermediary(infos.width, infos.height, 0 /* infos.format */);
             }
 
+            const auto eye = std::min(to_integral(region.eye), ViewCount - 1);
+            updateViewport(eye, *input, region);
+
+            // Only dispatch the regions covering the pixels to produce.
+            const std::array<unsigned int, 3> threadGroups = {
+                (static_cast<uint32_t>(region.outputRect.extent.width) + (kThreadGroupWorkRegionDim - 1)) /
+                    kThreadGroupWorkRegionDim,
+                (static_cast<uint32_t>(region.outputRect.extent.height) + (kThreadGroupWorkRegionDim - 1)) /
+                    kThreadGroupWorkRegionDim,
+                1};
+
+            const auto variant = m_tuner ? m_tuner->beginDispatch() : m_selectedVariant;
+            const auto& shaders = m_shaders[variant];
+
             if (!m_isSharpenOnly) {
-                m_device->setShader(m_shaderEASU, SamplerType::LinearClamp);
-                m_device->setShaderInput(0, m_configBuffer);
-                m_device->setShaderInput(0, input, slice);
+                shaders.easu->updateThreadGroups(threadGroups);
+                m_device->setShader(shaders.easu, SamplerType::LinearClamp);
+                m_device->setShaderInput(0, m_configBuffers[eye]);
+                m_device->setShaderInput(0, input, region.slice);
                 m_device->setShaderOutput(0, m_intermediary);
                 m_device->dispatchShader();
             }
 
-            m_device->setShader(m_shaderRCAS, SamplerType::LinearClamp);
-            m_device->setShaderInput(0, m_configBuffer);
-            m_device->setShaderInput(0, m_isSharpenOnly ? input : m_intermediary);
-            m_device->setShaderOutput(0, output, slice);
+            shaders.rcas->updateThreadGroups(threadGroups);
+            m_device->setShader(shaders.rcas, SamplerType::LinearClamp);
+            m_device->setShaderInput(0, m_configBuffers[eye]);
+            if (m_isSharpenOnly) {
+                m_device->setShaderInput(0, input, region.slice);
+            } else {
+                m_device->setShaderInput(0, m_intermediary);
+            }
+            m_device->setShaderOutput(0, output, region.slice);
             m_device->dispatchShader();
+
+            if (m_tuner) {
+                m_tuner->endDispatch();
+                if (!m_tuner->isTuning()) {
+                    // Release the variants we will not use anymore, once the GPU is done with the tuning dispatches.
+                    m_selectedVariant = m_tuner->getSelectedVariant();
+                    for (size_t i = 0; i < m_shaders.size(); i++) {
+                        if (i != m_selectedVariant) {
+                            m_device->deferRelease(std::make_shared<Shaders>(std::move(m_shaders[i])));
+                            m_shaders[i] = {};
+                        }
+                    }
+                    m_tuner.reset();
+                }
+            }
         }
 
       private:
+        struct Shaders {
+            std::shared_ptr<IComputeShader> easu;
+            std::shared_ptr<IComputeShader> rcas;
+        };
+
+        // The rectangles to process for a view and the dimensions of the texture read by EASU.
+        struct Viewport {
+            XrRect2Di input;
+            XrRect2Di output;
+            XrExtent2Di inputSize;
+        };
+
         void initializeScaler() {
+            // When requested, time the thread group sizes on this GPU the first time (or reuse the previous results).
+            m_selectedVariant = 0;
+            if (!m_tuner && m_configManager->getValue(SettingShaderTuning)) {
+                m_tuner = CreateShaderTuner(
+                    m_device, m_isSharpenOnly ? "fsr_sharpen" : "fsr_scaler", std::size(kThreadGroupSizes), 0);
+            }
+            if (m_tuner && !m_tuner->isTuning()) {
+                m_selectedVariant = m_tuner->getSelectedVariant();
+                m_tuner.reset();
+            }
+
+            m_shaders.clear();
+            m_shaders.resize(std::size(kThreadGroupSizes));
+            for (size_t i = 0; i < std::size(kThreadGroupSizes); i++) {
+                if (m_tuner || i == m_selectedVariant) {
+                    m_shaders[i] = createShaders(kThreadGroupSizes[i]);
+                }
+            }
+
+            // TODO: Consider making immutable and create a new buffer in update(). For now, our D3D12 implementation
+            // does not do heap descriptor recycling.
+            for (auto& it : m_configBuffers) {
+                it = m_device->createBuffer(sizeof(FSRConstants), "FSR Constants CB");
+            }
+            m_sharpness = m_configManager->getValue(SettingSharpness) / 100.f;
+            std::fill_n(m_configUpdated, std::size(m_configUpdated), true);
+        }
+
+        Shaders createShaders(uint32_t threadGroupSize) const {
             const auto shadersDir = dllHome / "shaders";
             const auto shaderFile = shadersDir / "FSR.hlsl";
 
-            // This value is the image region dimension that each thread group of the FSR shader operates on
-            const auto threadGroupWorkRegionDim = 16u;
             const std::array<unsigned int, 3> threadGroups = {
-                (m_outputWidth + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim,  // dispatchX
-                (m_outputHeight + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim, // dispatchY
+                (m_outputWidth + (kThreadGroupWorkRegionDim - 1)) / kThreadGroupWorkRegionDim,  // dispatchX
+                (m_outputHeight + (kThreadGroupWorkRegionDim - 1)) / kThreadGroupWorkRegionDim, // dispatchY
                 1};
 
             // EASU/RCAS common
             utilities::shader::Defines defines;
-            defines.add("FSR_THREAD_GROUP_SIZE", 64);
+            defines.add("FSR_THREAD_GROUP_SIZE", threadGroupSize);
             defines.add("SAMPLE_SLOW_FALLBACK", 1);
             defines.add("SAMPLE_BILINEAR", 0);
 
@@ -118,20 +204,20 @@ namespace {
             defines.add("SAMPLE_RCAS", 0);
             defines.add("SAMPLE_EASU", 1);
             defines.add("SAMPLE_HDR_OUTPUT", 0);
-            m_shaderEASU = m_device->createComputeShader(
-                shaderFile, "mainCS", "FSR EASU CS", threadGroups, defines.get() /*,  shadersDir*/);
+            Shaders shaders;
+            if (!m_isSharpenOnly) {
+                shaders.easu = m_device->createComputeShader(
+                    shaderFile, "mainCS", "FSR EASU CS", threadGroups, defines.get() /*,  shadersDir*/);
+            }
 
             // RCAS specific
             defines.set("SAMPLE_EASU", 0);
             defines.set("SAMPLE_RCAS", 1);
             defines.add("SAMPLE_HDR_OUTPUT", 1);
-            m_shaderRCAS = m_device->createComputeShader(
+            shaders.rcas = m_device->createComputeShader(
                 shaderFile, "mainCS", "FSR RCAS CS", threadGroups, defines.get() /*,  shadersDir*/);
 
-            // TODO: Consider making immutable and create a new buffer in update(). For now, our D3D12 implementation
-            // does not do heap descriptor recycling.
-            m_configBuffer = m_device->createBuffer(sizeof(FSRConstants), "FSR Constants CB");
-            updateScaler(m_configManager->getValue(SettingSharpness) / 100.f);
+            return shaders;
         }
 
         void initializeIntermediary(uint32_t width, uint32_t height, int64_t format) {
@@ -160,8 +246,22 @@ namespace {
             m_intermediary = m_device->createTexture(info, "FSR Intermediary TEX2D");
         }
 
-        void updateScaler(float sharpness) {
-            const auto attenuation = 1.f - AClampF1(sharpness, 0, 1);
+        void updateViewport(size_t eye, const ITexture& input, const ProcessingRegion& region) {
+            const Viewport viewport{
+                region.inputRect,
+                region.outputRect,
+                {static_cast<int32_t>(input.getInfo().width), static_cast<int32_t>(input.getInfo().height)}};
+
+            if (m_configUpdated[eye] || memcmp(&viewport, &m_viewports[eye], sizeof(viewport))) {
+                m_viewports[eye] = viewport;
+                updateScaler(eye);
+                m_configUpdated[eye] = false;
+            }
+        }
+
+        void updateScaler(size_t eye) {
+            const auto& viewport = m_viewports[eye];
+            const auto attenuation = 1.f - AClampF1(m_sharpness, 0, 1);
 
             FSRConstants config = {};
             if (!m_isSharpenOnly) {
@@ -169,16 +269,27 @@ namespace {
                            config.Const1,
                            config.Const2,
                            config.Const3,
-                           static_cast<AF1>(m_inputWidth),
-                           static_cast<AF1>(m_inputHeight),
-                           static_cast<AF1>(m_inputWidth),
-                           static_cast<AF1>(m_inputHeight),
-                           static_cast<AF1>(m_outputWidth),
-                           static_cast<AF1>(m_outputHeight));
+                           static_cast<AF1>(viewport.input.extent.width),
+                           static_cast<AF1>(viewport.input.extent.height),
+                           static_cast<AF1>(viewport.inputSize.width),
+                           static_cast<AF1>(viewport.inputSize.height),
+                           static_cast<AF1>(viewport.output.extent.width),
+                           static_cast<AF1>(viewport.output.extent.height));
             }
 
             FsrRcasCon(config.Const4, static_cast<AF1>(attenuation));
 
+            // EASU samples the application rectangle and writes the intermediary at the output location, which RCAS
+            // reads back. When only sharpening, RCAS reads the application rectangle directly.
+            config.Const5[0] = AU1_AF1(static_cast<AF1>(viewport.input.offset.x) / viewport.inputSize.width);
+            config.Const5[1] = AU1_AF1(static_cast<AF1>(viewport.input.offset.y) / viewport.inputSize.height);
+            config.Const5[2] = viewport.output.offset.x;
+            config.Const5[3] = viewport.output.offset.y;
+            config.Const6[0] = viewport.output.extent.width;
+            config.Const6[1] = viewport.output.extent.height;
+            config.Const6[2] = m_isSharpenOnly ? viewport.input.offset.x : viewport.output.offset.x;
+            config.Const6[3] = m_isSharpenOnly ? viewport.input.offset.y : viewport.output.offset.y;
+
             // TODO:
             // The AMD FSR sample is using a value in the constant buffer to correct the output color accordingly.
             // We're replacing the constant with a shader compilation define because the project code is not HDR
@@ -187,7 +298,7 @@ namespace {
             //
             // config.Const4[3] = hdr ? 1 : 0;
 
-            m_configBuffer->uploadData(&config, sizeof(config));
+            m_configBuffers[eye]->uploadData(&config, sizeof(config));
         }
 
         const std::shared_ptr<IConfigManager> m_configManager;
@@ -199,10 +310,15 @@ namespace {
         uint32_t m_inputHeight;
         bool m_isSharpenOnly{false};
 
-        std::shared_ptr<IComputeShader> m_shaderEASU;
-        std::shared_ptr<IComputeShader> m_shaderRCAS;
-        std::shared_ptr<IShaderBuffer> m_configBuffer;
+        std::vector<Shaders> m_shaders;
+        size_t m_selectedVariant{0};
+        std::shared_ptr<IShaderTuner> m_tuner;
+        std::shared_ptr<IShaderBuffer> m_configBuffers[ViewCount];
         std::shared_ptr<ITexture> m_intermediary;
+
+        Viewport m_viewports[ViewCount]{};
+        bool m_configUpdated[ViewCount]{true, true};
+        float m_sharpness{0.f};
     };
 
 } // namespace
@@ -26,6 +26,7 @@
 #include "interfaces.h"
 #include "layer.h"
 #include "log.h"
+#include "posefilter.h"
 
 namespace {
 
@@ -110,6 +111,12 @@ namespace {
         bool boolValue{false};
         XrTime timeBoolValueChanged{0};
         bool boolValueChanged{false};
+
+        // The state at the previous sync, to implement hysteresis and predict clicks.
+        XrTime timeValueRecorded{0};
+        float previousFloatValue{0.0f};
+        XrTime timePreviousFloatValue{0};
+        bool previousBoolValue{false};
     };
 
     struct Action {
@@ -139,9 +146,28 @@ namespace {
         // true.
         float clickThreshold;
 
+        // The threshold (between 0 and 1) when converting a float action into a boolean action and the action goes
+        // back to false. Must be lower than clickThreshold to prevent chatter (NAN to use a default margin).
+        float releaseThreshold;
+
+        // How far ahead (in milliseconds) to extrapolate the gesture when the fingers are closing, in order to trigger
+        // the click earlier (0 to disable).
+        float clickPredictionMs;
+
         // The transformation to apply to the aim and grip poses.
         XrPosef transform[HandCount];
 
+        // The cutoff frequency (in Hz) of the aim and grip poses filter when the hand is still (0 to disable).
+        float poseFilterMinCutoff;
+
+        // How much the cutoff frequency increases with the linear (per m/s) and angular (per rad/s) speed of the hand.
+        float poseFilterBeta;
+        float poseFilterRotationBeta;
+
+        // The maximum time (in milliseconds) to extrapolate the filtered aim and grip poses, from the time the hand
+        // joints were located to the time requested by the application (0 to disable).
+        float posePredictionMs;
+
         // The frequency to respond to haptics (NAN for any frequency).
         float hapticsResponseFrequency;
 
@@ -266,6 +292,11 @@ namespace {
 
         void unregisterActionSpace(XrSpace space) override {
             m_actionSpaces.erase(space);
+
+            // The space might also have been used as a base space.
+            std::unique_lock lock(m_cacheLock);
+            m_cachedHandJointsPoses.erase(space);
+            m_poseFilters.erase(space);
         }
 
         void registerBindings(const XrInteractionProfileSuggestedBinding& bindings) override {
@@ -432,7 +463,7 @@ namespace {
                 for (auto& spaceCache : m_cachedHandJointsPoses) {
                     auto& cache = spaceCache.second;
                     for (uint32_t side = 0; side < HandCount; side++) {
-                        while (cache[side].size() > 0 && cache[side].front().first + GracePeriod < now) {
+                        while (cache[side].size() > 0 && cache[side].front().time + GracePeriod < now) {
                             cache[side].pop_front();
                         }
 
@@ -451,6 +482,27 @@ namespace {
                                                              handTrackingEnabled == HandTrackingEnabled::Left);
             m_rightHandEnabled = m_config.rightHandEnabled && (handTrackingEnabled == HandTrackingEnabled::Both ||
                                                                handTrackingEnabled == HandTrackingEnabled::Right);
+            if (m_isSuspended) {
+                m_leftHandEnabled = m_rightHandEnabled = false;
+
+                // Release all the inputs, so none remains stuck.
+                for (auto& action : m_actions) {
+                    for (auto& subAction : action.second.subActions) {
+                        subAction.second.floatValueChanged = subAction.second.floatValue != 0.f;
+                        subAction.second.boolValueChanged = subAction.second.boolValue;
+                        if (subAction.second.floatValueChanged) {
+                            subAction.second.floatValue = 0.f;
+                            subAction.second.timeFloatValueChanged = now;
+                        }
+                        if (subAction.second.boolValueChanged) {
+                            subAction.second.boolValue = false;
+                            subAction.second.timeBoolValueChanged = now;
+                        }
+                    }
+                }
+                m_trackedRecently[0] = m_trackedRecently[1] = false;
+                return;
+            }
 
             // Get joints poses.
             const XrHandJointLocationEXT* leftHandJointsPoses = nullptr;
@@ -494,6 +546,11 @@ namespace {
 
                 for (auto& subAction : action.second.subActions) {
                     subAction.second.synced = false;
+                    subAction.second.previousBoolValue = subAction.second.boolValue;
+                    if (subAction.second.timeValueRecorded != subAction.second.timePreviousFloatValue) {
+                        subAction.second.previousFloatValue = subAction.second.floatValue;
+                        subAction.second.timePreviousFloatValue = subAction.second.timeValueRecorded;
+                    }
                 }
             }
 
@@ -581,7 +638,8 @@ namespace {
                 return false;
             }
 
-            const auto& jointsPoses = getCachedHandJointsPoses(actionSpace.hand, time, now, baseSpace);
+            XrTime sampleTime;
+            const auto& jointsPoses = getCachedHandJointsPoses(actionSpace.hand, time, now, baseSpace, &sampleTime);
 
             const uint32_t side = actionSpace.hand == Hand::Left ? 0 : 1;
             const uint32_t joint =
@@ -594,8 +652,20 @@ namespace {
                 location.locationFlags |=
                     XR_SPACE_LOCATION_POSITION_TRACKED_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
             }
-            location.pose = Pose::Multiply(actionSpace.poseInActionSpace,
-                                           Pose::Multiply(m_config.transform[side], jointsPoses[joint].pose));
+            XrPosef pose = Pose::Multiply(m_config.transform[side], jointsPoses[joint].pose);
+            if (m_config.poseFilterMinCutoff > 0.f && Pose::IsPoseValid(location.locationFlags)) {
+                std::unique_lock lock(m_cacheLock);
+
+                auto& filter = m_poseFilters[baseSpace][side][actionSpace.poseType == PoseType::Grip ? 0 : 1];
+                pose = filter.update(pose,
+                                     sampleTime,
+                                     time,
+                                     {m_config.poseFilterMinCutoff,
+                                      m_config.poseFilterBeta,
+                                      m_config.poseFilterRotationBeta,
+                                      m_config.posePredictionMs});
+            }
+            location.pose = Pose::Multiply(actionSpace.poseInActionSpace, pose);
 
             m_gesturesState.handposeAgeUs[side] = std::max(m_gesturesState.handposeAgeUs[side], time - now);
 
@@ -704,6 +774,10 @@ namespace {
             return m_gesturesState;
         }
 
+        void suspend() override {
+            m_isSuspended = true;
+        }
+
       private:
         const std::string getPath(XrPath path) {
             char buf[XR_MAX_PATH_LENGTH];
@@ -714,8 +788,13 @@ namespace {
             return str;
         }
 
-        const XrHandJointLocationEXT*
-        getCachedHandJointsPoses(Hand hand, XrTime time, XrTime now, std::optional<XrSpace> baseSpace) const {
+        // Optionally return the time the hand joints were located at, which differs from the requested time for a
+        // cache hit or a time in the past.
+        const XrHandJointLocationEXT* getCachedHandJointsPoses(Hand hand,
+                                                               XrTime time,
+                                                               XrTime now,
+                                                               std::optional<XrSpace> baseSpace,
+                                                               XrTime* sampleTime = nullptr) const {
             const uint32_t side = hand == Hand::Left ? 0 : 1;
 
             std::unique_lock lock(m_cacheLock);
@@ -727,7 +806,7 @@ namespace {
             auto insertIt = cache.begin();
             XrTime closestTimeDelta = INT64_MAX;
             for (uint32_t i = 0; i < cache.size(); i++) {
-                const auto t = cache[i].first;
+                const auto t = cache[i].time;
                 const XrTime delta = std::abs(t - time);
                 if (t < time) {
                     insertIt++;
@@ -742,7 +821,10 @@ namespace {
             }
 
             if (closestIndex != -1 && closestTimeDelta < GracePeriod) {
-                return cache[closestIndex].second;
+                if (sampleTime) {
+                    *sampleTime = cache[closestIndex].sampleTime;
+                }
+                return cache[closestIndex].joints;
             }
 
             // Create a new entry.
@@ -755,8 +837,9 @@ namespace {
                 CacheEntry entry;
                 XrHandJointLocationsEXT locations{XR_TYPE_HAND_JOINT_LOCATIONS_EXT, nullptr};
                 locations.jointCount = XR_HAND_JOINT_COUNT_EXT;
-                locations.jointLocations = entry.second;
-                entry.first = time;
+                locations.jointLocations = entry.joints;
+                entry.time = time;
+                entry.sampleTime = locateInfo.time;
 
                 CHECK_HRCMD(m_openXR.xrLocateHandJointsEXT(m_handTracker[side], &locateInfo, &locations));
                 if (Pose::IsPoseTracked(locations.jointLocations[XR_HAND_JOINT_PALM_EXT].locationFlags)) {
@@ -764,7 +847,10 @@ namespace {
                 } else {
                     m_gesturesState.numTrackingLosses[side]++;
                 }
-                return cache.emplace(insertIt, entry)->second;
+                if (sampleTime) {
+                    *sampleTime = entry.sampleTime;
+                }
+                return cache.emplace(insertIt, entry)->joints;
             }
         }
 
@@ -939,7 +1025,7 @@ namespace {
                 if (path.rfind(actionPath) == path.length() - actionPath.length()) {
                     // If multiple gestures are bound to the same action, pick the highest value.
                     const float newFloatValue = subAction.synced ? std::max(subAction.floatValue, value) : value;
-                    const bool newBoolValue = newFloatValue >= m_config.clickThreshold;
+                    const bool newBoolValue = computeClickState(subAction, newFloatValue, now);
 
                     if (std::abs(subAction.floatValue - newFloatValue) > FLT_EPSILON) {
                         subAction.floatValue = newFloatValue;
@@ -951,11 +1037,43 @@ namespace {
                         subAction.timeBoolValueChanged = now;
                         subAction.boolValueChanged = true;
                     }
+                    subAction.timeValueRecorded = now;
                     subAction.synced = true;
                 }
             }
         }
 
+        // Convert the float action into a boolean action. We use 2 thresholds (hysteresis) to avoid chatter when the
+        // value hovers around the click threshold, and we use the closing velocity of the fingers to fire the click a
+        // little early when the gesture is clearly going to complete.
+        bool computeClickState(const SubAction& subAction, float value, XrTime now) const {
+            const float releaseThreshold =
+                std::min(!isnan(m_config.releaseThreshold) ? m_config.releaseThreshold : m_config.clickThreshold - 0.1f,
+                         m_config.clickThreshold);
+
+            if (subAction.previousBoolValue) {
+                return value > releaseThreshold;
+            }
+
+            if (value >= m_config.clickThreshold) {
+                return true;
+            }
+
+            if (m_config.clickPredictionMs > 0.f && subAction.timePreviousFloatValue &&
+                now > subAction.timePreviousFloatValue && value >= releaseThreshold) {
+                const float velocity = (value - subAction.previousFloatValue) /
+                                       ((now - subAction.timePreviousFloatValue) / 1000000.f); // per ms
+
+                // Only predict when the fingers are closing, and not faster than what a hand can physically do
+                // (this filters out tracking glitches).
+                if (velocity > 0.f && velocity < 0.1f) {
+                    return value + velocity * m_config.clickPredictionMs >= m_config.clickThreshold;
+                }
+            }
+
+            return false;
+        }
+
         OpenXrApi& m_openXR;
         const std::shared_ptr<IConfigManager> m_configManager;
 
@@ -984,10 +1102,16 @@ namespace {
 
         bool m_trackedRecently[2]{false, false};
         bool m_evaluateHapticsGesture{false};
+        std::atomic<bool> m_isSuspended{false};
 
-        using CacheEntry = std::pair<XrTime, XrHandJointLocationEXT[XR_HAND_JOINT_COUNT_EXT]>;
+        struct CacheEntry {
+            XrTime time;
+            XrTime sampleTime;
+            XrHandJointLocationEXT joints[XR_HAND_JOINT_COUNT_EXT];
+        };
         mutable std::map<XrSpace, std::deque<CacheEntry>[HandCount]> m_cachedHandJointsPoses;
         mutable std::mutex m_cacheLock;
+        mutable std::map<XrSpace, PoseFilter[HandCount][2]> m_poseFilters;
         mutable std::optional<XrSpace> m_preferredBaseSpace;
         mutable XrTime m_lastTimestampWithPoseTracked[HandCount]{0, 0};
         mutable GesturesState m_gesturesState{};
@@ -1000,7 +1124,13 @@ namespace {
         aimJointIndex = XR_HAND_JOINT_INDEX_INTERMEDIATE_EXT;
         gripJointIndex = XR_HAND_JOINT_PALM_EXT;
         clickThreshold = 0.75f;
+        releaseThreshold = NAN;
+        clickPredictionMs = 0.f;
         transform[0] = transform[1] = Pose::Identity();
+        poseFilterMinCutoff = 0.f;
+        poseFilterBeta = 10.f;
+        poseFilterRotationBeta = 1.f;
+        posePredictionMs = 0.f;
         hapticsResponseFrequency = NAN;
         hapticsResponseGesture = Gesture::FingerGun;
         hapticsAction = "";
@@ -1067,6 +1197,18 @@ namespace {
                     custom1Joint2Index = std::stoi(value);
                 } else if (name == "click_threshold") {
                     clickThreshold = std::stof(value);
+                } else if (name == "release_threshold") {
+                    releaseThreshold = std::stof(value);
+                } else if (name == "click_prediction_ms") {
+                    clickPredictionMs = std::stof(value);
+                } else if (name == "pose_filter_min_cutoff") {
+                    poseFilterMinCutoff = std::stof(value);
+                } else if (name == "pose_filter_beta") {
+                    poseFilterBeta = std::stof(value);
+                } else if (name == "pose_filter_rotation_beta") {
+                    poseFilterRotationBeta = std::stof(value);
+                } else if (name == "pose_prediction_ms") {
+                    posePredictionMs = std::stof(value);
                 } else if (name == "haptics_frequency") {
                     hapticsResponseFrequency = std::stof(value);
                 } else if (name == "haptics_gesture") {
@@ -1190,6 +1332,19 @@ namespace {
             Log("Grip pose uses joint: %d\n", gripJointIndex);
             Log("Aim pose uses joint: %d\n", aimJointIndex);
             Log("Click threshold: %.3f\n", clickThreshold);
+            if (!isnan(releaseThreshold)) {
+                Log("Release threshold: %.3f\n", releaseThreshold);
+            }
+            if (clickPredictionMs > 0.f) {
+                Log("Click prediction: %.1fms\n", clickPredictionMs);
+            }
+            if (poseFilterMinCutoff > 0.f) {
+                Log("Pose filter: min cutoff %.2fHz, beta %.2f, rotation beta %.2f, max prediction %.1fms\n",
+                    poseFilterMinCutoff,
+                    poseFilterBeta,
+                    poseFilterRotationBeta,
+                    posePredictionMs);
+            }
         }
         if (!hapticsAction.empty()) {
             if (!isnan(hapticsResponseFrequency)) {
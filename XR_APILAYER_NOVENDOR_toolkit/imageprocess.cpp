@@ -45,6 +45,7 @@ namespace {
         XrVector4f Params4;  // Gaze, Ring (anti-flicker)
         XrVector2f Rings[4]; // 1/(a1^2), 1/(b1^2)
         XrVector4f Dims2;
+        XrVector4f InputRect; // offset.xy, scale.zw (normalized)
     };
 
     class ImageProcessor : public IImageProcessor {
@@ -85,9 +86,24 @@ namespace {
             }
         }
 
-        void process(std::shared_ptr<ITexture> input, std::shared_ptr<ITexture> output, int32_t slice) override {
+        void process(const std::shared_ptr<ITexture>& input,
+                     const std::shared_ptr<ITexture>& output,
+                     const ProcessingRegion& region) override {
             using namespace xr::math;
 
+            const auto gazeIdx = std::min(to_integral(region.eye), ViewCount - 1);
+
+            // Only read the rectangle rendered by the application.
+            const auto& inputInfo = input->getInfo();
+            const XrVector4f inputRect = {static_cast<float>(region.inputRect.offset.x) / inputInfo.width,
+                                          static_cast<float>(region.inputRect.offset.y) / inputInfo.height,
+                                          static_cast<float>(region.inputRect.extent.width) / inputInfo.width,
+                                          static_cast<float>(region.inputRect.extent.height) / inputInfo.height};
+            if (memcmp(&inputRect, &m_inputRects[gazeIdx], sizeof(inputRect))) {
+                m_inputRects[gazeIdx] = inputRect;
+                m_configUpdated = true;
+            }
+
             // TODO: check whether we can use a structured array buffer for left/right/both instead.
             // TODO: Evaluate whether using 2 distinct buffers.
             // For now use both and share all constants in a single buffer.
@@ -98,22 +114,20 @@ namespace {
                 for (size_t i = 0; i < std::size(m_cbParams); i++) {
                     m_config.Params4.x = m_vrsState.gazeXY[i].x + center.x;
                     m_config.Params4.y = m_vrsState.gazeXY[i].y - center.y;
+                    m_config.InputRect = m_inputRects[i];
                     m_cbParams[i]->uploadData(&m_config, sizeof(m_config));
                 }
                 m_configUpdated = false;
                 m_configVrsUpdated = false;
             }
 
-            // NB: xrEndFrame calls with:
-            //   slice == useVPRT ? eye : -int32_t(eye + 1)
-
             const auto usePostProcess = m_mode != PostProcessType::Off;
-            const auto gazeIdx = abs(slice) - (slice < 0); // slice < 0 ? -(slice + 1) : slice;
 
             m_device->setShader(m_shaders[input->isArray()][usePostProcess], SamplerType::LinearClamp);
             m_device->setShaderInput(0, m_cbParams[gazeIdx]);
-            m_device->setShaderInput(0, input, slice);
-            m_device->setShaderOutput(0, output, slice);
+            m_device->setShaderInput(0, input, region.slice);
+            m_device->setShaderOutput(0, output, region.slice);
+            m_device->setViewport(region.outputRect);
             m_device->dispatchShader();
         }
 
@@ -345,6 +359,7 @@ namespace {
 
         std::shared_ptr<IQuadShader> m_shaders[2][2]; // off, on, vprt
         std::shared_ptr<IShaderBuffer> m_cbParams[ViewCount + 1];
+        XrVector4f m_inputRects[ViewCount + 1]{{0, 0, 1, 1}, {0, 0, 1, 1}, {0, 0, 1, 1}};
 
         bool m_configUpdated{false};
         bool m_configVrsUpdated{false};
@@ -359,6 +374,76 @@ namespace {
         ImageProcessorConfig m_config{};
     };
 
+    // A bilinear scale of the rectangle rendered by the application, to replace a faulty upscaler.
+    class PassThroughScaler : public IImageProcessor {
+      public:
+        PassThroughScaler(std::shared_ptr<IDevice> graphicsDevice) : m_device(graphicsDevice) {
+            createRenderResources();
+        }
+
+        void reload() override {
+            createRenderResources();
+        }
+
+        void update() override {
+        }
+
+        void process(const std::shared_ptr<ITexture>& input,
+                     const std::shared_ptr<ITexture>& output,
+                     const ProcessingRegion& region) override {
+            const auto viewIdx = std::min(to_integral(region.eye), ViewCount - 1);
+
+            // Stretch the input rectangle over the output rectangle (the viewport).
+            const auto& inputInfo = input->getInfo();
+            const XrVector4f inputRect = {static_cast<float>(region.inputRect.offset.x) / inputInfo.width,
+                                          static_cast<float>(region.inputRect.offset.y) / inputInfo.height,
+                                          static_cast<float>(region.inputRect.extent.width) / inputInfo.width,
+                                          static_cast<float>(region.inputRect.extent.height) / inputInfo.height};
+            if (memcmp(&inputRect, &m_inputRects[viewIdx], sizeof(inputRect))) {
+                m_inputRects[viewIdx] = inputRect;
+
+                // Without gains, rings or anti-flicker, the pass-through shader only samples the input.
+                ImageProcessorConfig config{};
+                config.InputRect = inputRect;
+                m_cbParams[viewIdx]->uploadData(&config, sizeof(config));
+            }
+
+            m_device->setShader(m_shaders[input->isArray()], SamplerType::LinearClamp);
+            m_device->setShaderInput(0, m_cbParams[viewIdx]);
+            m_device->setShaderInput(0, input, region.slice);
+            m_device->setShaderOutput(0, output, region.slice);
+            m_device->setViewport(region.outputRect);
+            m_device->dispatchShader();
+        }
+
+      private:
+        void createRenderResources() {
+            const auto shadersDir = dllHome / "shaders";
+            const auto shaderFile = shadersDir / "postprocess.hlsl";
+
+            shader::Defines defines;
+            m_shaders[0] = m_device->createQuadShader(
+                shaderFile, "mainPassThrough", "Scale Passthrough PS", defines.get() /*,  shadersDir*/);
+
+            defines.add("VPRT", true);
+            m_shaders[1] = m_device->createQuadShader(
+                shaderFile, "mainPassThrough", "Scale Passthrough PS (VPRT)", defines.get() /*,  shadersDir*/);
+
+            for (auto& it : m_cbParams) {
+                it = m_device->createBuffer(sizeof(ImageProcessorConfig), "Scale Passthrough CB");
+            }
+
+            // Upload the constants upon the next use.
+            std::fill_n(m_inputRects, std::size(m_inputRects), XrVector4f{0, 0, 0, 0});
+        }
+
+        const std::shared_ptr<IDevice> m_device;
+
+        std::shared_ptr<IQuadShader> m_shaders[2]; // non-vprt, vprt
+        std::shared_ptr<IShaderBuffer> m_cbParams[ViewCount + 1];
+        XrVector4f m_inputRects[ViewCount + 1]{};
+    };
+
 } // namespace
 
 namespace toolkit::graphics {
@@ -422,4 +507,8 @@ namespace toolkit::graphics {
             configManager, graphicsDevice, variableRateShader, renderWidth, renderHeight, displayWidth, displayHeight);
     }
 
+    std::shared_ptr<IImageProcessor> CreatePassThroughScaler(std::shared_ptr<IDevice> graphicsDevice) {
+        return std::make_shared<PassThroughScaler>(graphicsDevice);
+    }
+
 } // namespace toolkit::graphics
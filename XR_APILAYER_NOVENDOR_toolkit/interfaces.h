@@ -96,6 +96,93 @@ namespace toolkit {
             return {(v.x * 2.f) - 1.f, (v.y * -2.f) + 1.f};
         }
 
+        // System-wide resource usage (not limited to the work measured by the layer).
+        constexpr uint32_t MaxCpuCores = 64;
+        struct SystemUsage {
+            float gpuBusyPercent{0.f};
+            uint64_t processVideoMemoryBytes{0};
+            uint32_t numCpuCores{0};
+            float cpuCoreLoadPercent[MaxCpuCores]{};
+        };
+
+        // A source of system counters (eg: PDH on Windows).
+        struct ISystemUsageProvider {
+            virtual ~ISystemUsageProvider() = default;
+
+            virtual bool sample(SystemUsage& usage) = 0;
+        };
+
+        // A low-rate background sampler of the system usage.
+        struct ISystemMonitor {
+            virtual ~ISystemMonitor() = default;
+
+            virtual void setEnabled(bool enabled) = 0;
+            virtual SystemUsage getUsage() const = 0;
+        };
+
+        // The summary of a session, as recorded in the per-application history.
+        struct SessionSummary {
+            // The environment of the session.
+            std::string applicationVersion;
+            std::string runtime;
+            std::string driver;
+            std::string device;
+            // The settings that affect performance (upscaling, foveated rendering...) and the resolution.
+            std::string features;
+
+            uint32_t numFrames{0};
+            float frameTimeP50Us{0.f};
+            float frameTimeP95Us{0.f};
+            float frameTimeP99Us{0.f};
+            float appCpuTimeUs{0.f};
+            float appGpuTimeUs{0.f};
+        };
+
+        // A performance regression following an update of the application, the runtime or the driver.
+        struct PerformanceRegression {
+            bool detected{false};
+            float frameTimePercent{0.f};
+            float appCpuTimePercent{0.f};
+            float appGpuTimePercent{0.f};
+            bool isApplicationUpdated{false};
+            bool isRuntimeUpdated{false};
+            bool isDriverUpdated{false};
+        };
+
+        // Records the performance of the sessions of an application, and compares the current session to the previous
+        // ones with the same features.
+        struct IPerformanceHistory {
+            virtual ~IPerformanceHistory() = default;
+
+            // Changing the features restarts the measurements of the session.
+            virtual void setFeatures(const std::string& features) = 0;
+            virtual void addFrame(uint64_t frameTimeUs) = 0;
+            // Averages over the last second.
+            virtual void addTimings(uint64_t appCpuTimeUs, uint64_t appGpuTimeUs) = 0;
+
+            virtual PerformanceRegression getRegression() const = 0;
+            // Append the summary of the session to the history.
+            virtual void commit() = 0;
+        };
+
+        // The features that can be degraded when they misbehave.
+        enum class GuardedFeature { Upscaling = 0, PostProcess, VariableRateShading, HandTracking, MaxValue };
+
+        // Trips a feature that repeatedly exceeds its share of the frame time or faults, so that the layer can degrade
+        // it instead of tanking the frame rate or terminating the application.
+        struct ICircuitBreaker {
+            virtual ~ICircuitBreaker() = default;
+
+            // Report the average cost of a feature over the last second. Returns true when the feature trips.
+            virtual bool reportCost(GuardedFeature feature, uint64_t costUs, uint64_t frameTimeUs) = 0;
+            // Report an exception thrown by a feature. Returns true when the feature trips.
+            virtual bool reportFault(GuardedFeature feature, const char* what) = 0;
+
+            virtual bool isTripped(GuardedFeature feature) const = 0;
+            // A bitmask of the tripped features.
+            virtual uint32_t getTrippedFeatures() const = 0;
+        };
+
     } // namespace utilities
 
     namespace config {
@@ -113,6 +200,8 @@ namespace toolkit {
         const std::string SettingMenuKeyDown = "key_menu";
         const std::string SettingMenuKeyLeft = "key_left";
         const std::string SettingMenuKeyRight = "key_right";
+        const std::string SettingProfileKey = "key_profile";
+        const std::string SettingProfileCadence = "profile_cadence";
         const std::string SettingMenuEyeVisibility = "menu_eye";
         const std::string SettingMenuEyeOffset = "menu_eye_offset";
         const std::string SettingMenuDistance = "menu_distance";
@@ -128,6 +217,7 @@ namespace toolkit {
         const std::string SettingScaling = "scaling";
         const std::string SettingAnamorphic = "anamorphic";
         const std::string SettingSharpness = "sharpness";
+        const std::string SettingCenterWeightedRadius = "center_weighted_radius";
         const std::string SettingMipMapBias = "mipmap_bias";
         const std::string SettingICD = "world_scale";
         const std::string SettingFOVType = "fov_type";
@@ -162,6 +252,9 @@ namespace toolkit {
         const std::string SettingVRSYOffset = "vrs_y_offset";
         const std::string SettingVRSPreferHorizontal = "vrs_prefer_horizontal";
         const std::string SettingVRSLeftRightBias = "vrs_lr_bias";
+        const std::string SettingVRSFullRateWithoutDepth = "vrs_full_rate_without_depth";
+        const std::string SettingQuadViewsFocusSize = "quad_views_focus_size";
+        const std::string SettingQuadViewsPeripheralScale = "quad_views_peripheral";
         const std::string SettingPostProcess = "post_process";
         const std::string SettingPostSunGlasses = "post_sunglasses";
         const std::string SettingPostContrast = "post_contrast";
@@ -180,16 +273,18 @@ namespace toolkit {
         const std::string SettingEyeProjectionDistance = "eye_projection";
         const std::string SettingEyeDebug = "eye_debug";
         const std::string SettingEyeDebugWithController = "eye_controller_debug";
+        const std::string SettingEyeSaccadeHold = "eye_saccade_hold";
         const std::string SettingResolutionOverride = "override_resolution";
         const std::string SettingResolutionWidth = "resolution_width";
         const std::string SettingDisableInterceptor = "disable_interceptor";
+        const std::string SettingShaderTuning = "shader_tuning";
 
         enum class OffOnType { Off = 0, On, MaxValue };
         enum class NoYesType { No = 0, Yes, MaxValue };
         enum class OverlayType { None = 0, FPS, Advanced, Developer, MaxValue };
         enum class MenuFontSize { Small = 0, Medium, Large, MaxValue };
         enum class MenuTimeout { Small = 0, Medium, Large, None, MaxValue };
-        enum class ScalingType { None = 0, NIS, FSR, MaxValue };
+        enum class ScalingType { None = 0, NIS, FSR, CenterWeighted, MaxValue };
         enum class MipMapBias { Off = 0, Anisotropic, All, MaxValue };
         enum class HandTrackingEnabled { Off = 0, Both, Left, Right, MaxValue };
         enum class HandTrackingVisibility { Hidden = 0, Bright, Medium, Dark, Darker, MaxValue };
@@ -231,6 +326,13 @@ namespace toolkit {
 
             virtual bool isSafeMode() const = 0;
 
+            // Named snapshots of the settings (eg: for A/B comparisons).
+            virtual void saveProfile(const std::string& profile) = 0;
+            virtual bool hasProfile(const std::string& profile) const = 0;
+            // Profiles are applied in memory only, and return the names of the settings they changed.
+            virtual std::vector<std::string> applyProfile(const std::string& profile) = 0;
+            virtual void revertProfile() = 0;
+
             template <typename T, std::enable_if_t<std::is_enum<T>::value, bool> = true>
             void setEnumDefault(const std::string& name, T value) {
                 setDefault(name, static_cast<int>(to_integral(value)));
@@ -249,6 +351,40 @@ namespace toolkit {
             }
         };
 
+        // The names of the profiles compared by the A/B hotkey.
+        const std::string ProfileA = "A";
+        const std::string ProfileB = "B";
+
+        struct ProfileStatistics {
+            uint32_t numFrames{0};
+            float meanUs{0.f};
+            float medianUs{0.f};
+            float p95Us{0.f};
+        };
+
+        // GPU frame time statistics of the A/B comparison. Each period of profile B is paired with the preceding period
+        // of profile A, and the significance comes from a paired t-test over these periods.
+        struct ProfileComparison {
+            bool active{false};
+            bool isProfileB{false};
+            ProfileStatistics profiles[2];
+            uint32_t numPairs{0};
+            float meanDifferenceUs{0.f}; // B - A
+            float tStatistic{0.f};
+            bool isSignificant{false};
+            // Some settings (eg: the upscaling) cannot change without restarting the session.
+            bool hasRestartBoundSettings{false};
+        };
+
+        // Alternates between the A and B profiles at a fixed cadence, collecting the frame times of each.
+        struct IProfileComparator {
+            virtual ~IProfileComparator() = default;
+
+            virtual bool toggle() = 0;
+            virtual void onFrame(uint64_t gpuFrameTimeUs) = 0;
+            virtual ProfileComparison getComparison() const = 0;
+        };
+
     } // namespace config
 
     namespace graphics {
@@ -456,7 +592,7 @@ namespace toolkit {
             virtual std::shared_ptr<IDepthStencilView> getDepthStencilView(int32_t slice = -1) const = 0;
 
             virtual void uploadData(const void* buffer, uint32_t rowPitch, int32_t slice = -1) = 0;
-            virtual void copyTo(std::shared_ptr<ITexture> destination) const = 0;
+            virtual void copyTo(const std::shared_ptr<ITexture>& destination) const = 0;
             virtual void saveToFile(const std::filesystem::path& path) const = 0;
 
             virtual void* getNativePtr() const = 0;
@@ -527,6 +663,8 @@ namespace toolkit {
             virtual Api getApi() const = 0;
 
             virtual const std::string& getDeviceName() const = 0;
+            // Identifies both the adapter and its driver version, eg: to persist per-GPU choices.
+            virtual const std::string& getDriverIdentifier() const = 0;
             virtual GpuArchitecture GetGpuArchitecture() const = 0;
 
             virtual int64_t getTextureFormat(TextureFormat format) const = 0;
@@ -567,22 +705,34 @@ namespace toolkit {
 
             virtual std::shared_ptr<IGpuTimer> createTimer() = 0;
 
+            // Keep an object alive until the GPU has completed the work submitted so far, including the work recorded
+            // in the current context.
+            virtual void deferRelease(std::shared_ptr<void> object) = 0;
+
             // Must be invoked prior to setting the input/output.
-            virtual void setShader(std::shared_ptr<IQuadShader> shader, SamplerType sampler) = 0;
+            virtual void setShader(const std::shared_ptr<IQuadShader>& shader, SamplerType sampler) = 0;
 
             // Must be invoked prior to setting the input/output.
-            virtual void setShader(std::shared_ptr<IComputeShader> shader, SamplerType sampler) = 0;
+            virtual void setShader(const std::shared_ptr<IComputeShader>& shader, SamplerType sampler) = 0;
 
-            virtual void setShaderInput(uint32_t slot, std::shared_ptr<IShaderBuffer> input) = 0;
-            virtual void setShaderInput(uint32_t slot, std::shared_ptr<ITexture> input, int32_t slice = -1) = 0;
-            virtual void setShaderOutput(uint32_t slot, std::shared_ptr<ITexture> output, int32_t slice = -1) = 0;
+            virtual void setShaderInput(uint32_t slot, const std::shared_ptr<IShaderBuffer>& input) = 0;
+            virtual void setShaderInput(uint32_t slot,
+                                        const std::shared_ptr<ITexture>& input,
+                                        int32_t slice = -1) = 0;
+            virtual void setShaderOutput(uint32_t slot,
+                                         const std::shared_ptr<ITexture>& output,
+                                         int32_t slice = -1) = 0;
 
-            virtual void dispatchShader(bool doNotClear = false) const = 0;
+            virtual void dispatchShader(bool doNotClear = false) = 0;
+
+            // Restrict the next quad shader dispatch to a region of its output. Must be invoked after setting the
+            // output.
+            virtual void setViewport(const XrRect2Di& viewport) = 0;
 
             virtual void setRenderTargets(size_t numRenderTargets,
                                           const std::shared_ptr<ITexture>* renderTargets,
                                           int32_t* renderSlices = nullptr,
-                                          std::shared_ptr<ITexture> depthBuffer = nullptr,
+                                          const std::shared_ptr<ITexture>& depthBuffer = nullptr,
                                           int32_t depthSlice = -1) = 0;
             virtual void unsetRenderTargets() = 0;
 
@@ -619,6 +769,8 @@ namespace toolkit {
             virtual void flushText() = 0;
 
             virtual void setMipMapBias(config::MipMapBias biasing, float bias = 0.f) = 0;
+            // Restrict the mip-map biasing to the passes rendering the eye views.
+            virtual void setMipMapBiasPassActive(const std::shared_ptr<IContext>& context, bool active) = 0;
             virtual uint32_t getNumBiasedSamplersThisFrame() const = 0;
 
             virtual void resolveQueries() = 0;
@@ -626,20 +778,44 @@ namespace toolkit {
             virtual void blockCallbacks() = 0;
             virtual void unblockCallbacks() = 0;
 
-            using SetRenderTargetEvent =
-                std::function<void(std::shared_ptr<IContext>, std::shared_ptr<ITexture> renderTarget)>;
+            // Events are fired from the hot path of the application's rendering: the objects are only borrowed for the
+            // duration of the callback.
+            using SetRenderTargetEvent = std::function<void(const std::shared_ptr<IContext>&,
+                                                            const std::shared_ptr<ITexture>& renderTarget,
+                                                            bool hasDepthBuffer)>;
             virtual void registerSetRenderTargetEvent(SetRenderTargetEvent event) = 0;
 
-            using UnsetRenderTargetEvent = std::function<void(std::shared_ptr<IContext>)>;
+            using UnsetRenderTargetEvent = std::function<void(const std::shared_ptr<IContext>&)>;
             virtual void registerUnsetRenderTargetEvent(UnsetRenderTargetEvent event) = 0;
 
-            using CopyTextureEvent = std::function<void(std::shared_ptr<IContext> /* context */,
-                                                        std::shared_ptr<ITexture> /* source */,
-                                                        std::shared_ptr<ITexture> /* destination */,
+            using CopyTextureEvent = std::function<void(const std::shared_ptr<IContext>& /* context */,
+                                                        const std::shared_ptr<ITexture>& /* source */,
+                                                        const std::shared_ptr<ITexture>& /* destination */,
                                                         int /* sourceSlice */,
                                                         int /* destinationSlice */)>;
             virtual void registerCopyTextureEvent(CopyTextureEvent event) = 0;
 
+            // Command lists may be recorded concurrently from many threads: these events let the callers keep their
+            // state per context, and merge it in submission order.
+            using CloseContextEvent = std::function<void(const std::shared_ptr<IContext>&)>;
+            virtual void registerCloseContextEvent(CloseContextEvent event) = 0;
+
+            using ExecuteContextsEvent = std::function<void(const std::vector<const void*>& /* contexts */)>;
+            virtual void registerExecuteContextsEvent(ExecuteContextsEvent event) = 0;
+
+            // The shading rate commands recorded by the application on a D3D12 command list. The event is fired after
+            // the command reached the command list, and the handler may record its own commands to amend the state.
+            struct ShadingRateCommand {
+                bool isImage{false};
+                D3D12_SHADING_RATE baseRate{D3D12_SHADING_RATE_1X1};
+                D3D12_SHADING_RATE_COMBINER combiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT]{
+                    D3D12_SHADING_RATE_COMBINER_PASSTHROUGH, D3D12_SHADING_RATE_COMBINER_PASSTHROUGH};
+                ID3D12Resource* image{nullptr};
+            };
+            using SetShadingRateEvent =
+                std::function<void(const std::shared_ptr<IContext>&, const ShadingRateCommand& /* command */)>;
+            virtual void registerSetShadingRateEvent(SetShadingRateEvent event) = 0;
+
             virtual void shutdown() = 0;
 
             virtual bool isEventsSupported() const = 0;
@@ -662,15 +838,41 @@ namespace toolkit {
             }
         };
 
+        // Picks the fastest of several variants of a compute shader (eg: thread group shapes), by timing each variant
+        // during the first dispatches and remembering the choice for the GPU and driver.
+        struct IShaderTuner {
+            virtual ~IShaderTuner() = default;
+
+            // Returns the variant to use for the upcoming dispatch.
+            virtual size_t beginDispatch() = 0;
+            virtual void endDispatch() = 0;
+
+            virtual bool isTuning() const = 0;
+            virtual size_t getSelectedVariant() const = 0;
+        };
+
+        // The portion of the textures of the processing chain to process for a view.
+        struct ProcessingRegion {
+            utilities::Eye eye{utilities::Eye::Left};
+            int32_t slice{-1};      // Array slice of the input and output, -1 for non-array textures.
+            XrRect2Di inputRect{};  // Pixels rendered by the application.
+            XrRect2Di outputRect{}; // Pixels to produce.
+        };
+
         // A texture post-processor.
         struct IImageProcessor {
             virtual ~IImageProcessor() = default;
 
             virtual void reload() = 0;
             virtual void update() = 0;
-            virtual void process(std::shared_ptr<ITexture> input,
-                                 std::shared_ptr<ITexture> output,
-                                 int32_t slice = -1) = 0;
+            virtual void process(const std::shared_ptr<ITexture>& input,
+                                 const std::shared_ptr<ITexture>& output,
+                                 const ProcessingRegion& region) = 0;
+        };
+
+        // A bilinear upscaler that only applies a sharper (Catmull-Rom) reconstruction near the projection centers.
+        struct ICenterWeightedUpscaler : IImageProcessor {
+            virtual void setViewProjectionCenters(XrVector2f left, XrVector2f right) = 0;
         };
 
         struct IFrameAnalyzer {
@@ -681,16 +883,20 @@ namespace toolkit {
             virtual void resetForFrame() = 0;
             virtual void prepareForEndFrame() = 0;
 
-            virtual void onSetRenderTarget(std::shared_ptr<IContext> context,
-                                           std::shared_ptr<ITexture> renderTarget) = 0;
-            virtual void onUnsetRenderTarget(std::shared_ptr<graphics::IContext> context) = 0;
+            virtual void onSetRenderTarget(const std::shared_ptr<IContext>& context,
+                                           const std::shared_ptr<ITexture>& renderTarget) = 0;
+            virtual void onUnsetRenderTarget(const std::shared_ptr<graphics::IContext>& context) = 0;
 
-            virtual void onCopyTexture(std::shared_ptr<ITexture> source,
-                                       std::shared_ptr<ITexture> destination,
+            virtual void onCopyTexture(const std::shared_ptr<IContext>& context,
+                                       const std::shared_ptr<ITexture>& source,
+                                       const std::shared_ptr<ITexture>& destination,
                                        int sourceSlice = -1,
                                        int destinationSlice = -1) = 0;
 
-            virtual utilities::Eye getEyeHint() const = 0;
+            virtual void onExecuteContexts(const std::vector<const void*>& contexts) = 0;
+
+            virtual utilities::Eye getEyeHint(const std::shared_ptr<IContext>& context) const = 0;
+            virtual bool isEyePass(const std::shared_ptr<IContext>& context) const = 0;
         };
 
         // A Variable Rate Shader (VRS) control implementation.
@@ -702,6 +908,15 @@ namespace toolkit {
             int8_t mode;          // 0: off, 1: active 2: with eye tracking (swap gaze if < 0)
         };
 
+        // The foveation requested by the application (eg: via XR_FB_foveation), in the units of the VRS settings.
+        struct VariableRateShaderFoveation {
+            int innerRadius{0};        // like SettingVRSInnerRadius
+            int outerRadius{0};        // like SettingVRSOuterRadius
+            int rates[3]{0, 0, 0};     // config::VariableShadingRateVal for the inner, middle and outer regions
+            float verticalOffset{0.f}; // ndc
+            bool isEyeTracked{false};
+        };
+
         struct IVariableRateShader {
             virtual ~IVariableRateShader() = default;
 
@@ -709,13 +924,21 @@ namespace toolkit {
             virtual void endFrame() = 0;
             virtual void update() = 0;
 
-            virtual bool onSetRenderTarget(std::shared_ptr<IContext> context,
-                                           std::shared_ptr<ITexture> renderTarget,
+            virtual bool onSetRenderTarget(const std::shared_ptr<IContext>& context,
+                                           const std::shared_ptr<ITexture>& renderTarget,
+                                           bool hasDepthBuffer,
                                            utilities::Eye eyeHint) = 0;
-            virtual void onUnsetRenderTarget(std::shared_ptr<graphics::IContext> context) = 0;
+            virtual void onUnsetRenderTarget(const std::shared_ptr<graphics::IContext>& context) = 0;
+            virtual void onCloseContext(const std::shared_ptr<graphics::IContext>& context) = 0;
+            virtual void onExecuteContexts(const std::vector<const void*>& contexts) = 0;
+            virtual void onSetShadingRate(const std::shared_ptr<graphics::IContext>& context,
+                                          const IDevice::ShadingRateCommand& command) = 0;
 
             virtual void setViewProjectionCenters(XrVector2f left, XrVector2f right) = 0;
 
+            // Used when the user did not enable VRS from the menu.
+            virtual void setApplicationFoveation(const std::optional<VariableRateShaderFoveation>& foveation) = 0;
+
             virtual uint8_t getMaxRate() const = 0;
             virtual float getTotalRate() const = 0;
             virtual uint64_t getCurrentGen() const = 0;
@@ -723,6 +946,29 @@ namespace toolkit {
 
             virtual void startCapture() = 0;
             virtual void stopCapture() = 0;
+
+            // Stop applying VRS for the remainder of the session.
+            virtual void suspend() = 0;
+        };
+
+        // A compositor merging the peripheral and focus views of an emulated quad views layer.
+        struct IQuadViewsCompositor {
+            virtual ~IQuadViewsCompositor() = default;
+
+            virtual void reload() = 0;
+
+            // focusArea is the {u0, v0, u1, v1} region of the output covered by the focus view. layerIndex identifies
+            // the quad views layer when several of them are composited in the same frame.
+            virtual void composite(const std::shared_ptr<ITexture>& peripheral,
+                                   int32_t peripheralSlice,
+                                   const XrRect2Di& peripheralRect,
+                                   const std::shared_ptr<ITexture>& focus,
+                                   int32_t focusSlice,
+                                   const XrRect2Di& focusRect,
+                                   const XrVector4f& focusArea,
+                                   const std::shared_ptr<ITexture>& output,
+                                   utilities::Eye eye,
+                                   uint32_t layerIndex) = 0;
         };
 
     } // namespace graphics
@@ -782,11 +1028,18 @@ namespace toolkit {
             virtual void handleOutput(Hand hand, float frequency, XrDuration duration) = 0;
 
             virtual const GesturesState& getGesturesState() const = 0;
+
+            // Stop emulating the controllers for the remainder of the session.
+            virtual void suspend() = 0;
         };
 
+        enum class EyeMovement { Fixation, Saccade, Blink };
+
         struct EyeGazeState {
             XrVector3f gazeRay{};
             XrVector2f gazeNdc[2];
+            EyeMovement movement{EyeMovement::Fixation};
+            float angularVelocity{0.f}; // degrees per second
         };
 
         struct IEyeTracker {
@@ -807,6 +1060,10 @@ namespace toolkit {
 
             virtual const EyeGazeState& getEyeGazeState() const = 0;
             virtual bool getProjectedGaze(XrVector2f gaze[utilities::ViewCount]) const = 0;
+
+            // Latest sample from the tracker as a unit direction in view space (forward is -Z), and the performance
+            // counter time when it was acquired.
+            virtual bool getGazeSample(XrVector3f& gazeDirection, LARGE_INTEGER& sampleTime) const = 0;
         };
 
     } // namespace input
@@ -823,6 +1080,9 @@ namespace toolkit {
             uint64_t overlayGpuTimeUs{0};
             uint64_t handTrackingCpuTimeUs{0};
             uint64_t predictionTimeUs{0};
+            uint64_t poseAgeUs{0};
+            uint64_t motionToPhotonUs{0};
+            uint64_t dampenedPredictionUs{0};
 
             float fps{0.0f};
             float icd{0.0f};
@@ -833,6 +1093,12 @@ namespace toolkit {
 
             bool hasColorBuffer[utilities::ViewCount + 1]{false, false, false};
             bool hasDepthBuffer[utilities::ViewCount + 1]{false, false, false};
+
+            utilities::SystemUsage systemUsage{};
+
+            config::ProfileComparison profileComparison{};
+            utilities::PerformanceRegression performanceRegression{};
+            uint32_t trippedFeatures{0};
         };
 
         // A menu handler.
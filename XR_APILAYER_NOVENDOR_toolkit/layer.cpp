@@ -45,9 +45,37 @@ namespace {
     static std::vector<XrCompositionLayerProjectionView> gLayerProjectionsViews;
     static XrCompositionLayerQuad gLayerQuadForMenu;
 
+    // Each emulated quad views layer is composited into a stereo projection layer.
+    constexpr uint32_t QuadViewCount = 4;
+    static std::vector<XrCompositionLayerProjection> gLayerProjectionsForQuadViews;
+    static std::vector<XrCompositionLayerProjectionView> gLayerProjectionsViewsForQuadViews;
+
     // Up to 3 image processing stages are supported.
     enum ImgProc { Pre, Scale, Post, MaxValue };
 
+    // Entry points of the foveation extensions emulated by the layer. The OpenXR runtime does not know them, so they
+    // are not handled by the generated dispatcher.
+    namespace emulated {
+        XrResult XRAPI_CALL xrCreateFoveationProfileFB(XrSession session,
+                                                       const XrFoveationProfileCreateInfoFB* createInfo,
+                                                       XrFoveationProfileFB* profile);
+        XrResult XRAPI_CALL xrDestroyFoveationProfileFB(XrFoveationProfileFB profile);
+        XrResult XRAPI_CALL xrUpdateSwapchainFB(XrSwapchain swapchain, const XrSwapchainStateBaseHeaderFB* state);
+        XrResult XRAPI_CALL xrGetSwapchainStateFB(XrSwapchain swapchain, XrSwapchainStateBaseHeaderFB* state);
+#ifdef XR_META_foveation_eye_tracked
+        XrResult XRAPI_CALL xrGetFoveationEyeTrackedStateMETA(XrSession session,
+                                                              XrFoveationEyeTrackedStateMETA* foveationState);
+#endif
+    } // namespace emulated
+
+    // A foveation profile created through XR_FB_foveation.
+    struct FoveationProfile {
+        XrFoveationLevelFB level{XR_FOVEATION_LEVEL_NONE_FB};
+        float verticalOffset{0.f};
+        XrFoveationDynamicFB dynamic{XR_FOVEATION_DYNAMIC_DISABLED_FB};
+        bool isEyeTracked{false};
+    };
+
     struct SwapchainImages {
         std::vector<std::shared_ptr<graphics::ITexture>> chain;
         std::shared_ptr<graphics::IGpuTimer> gpuTimers[ImgProc::MaxValue][utilities::ViewCount];
@@ -84,6 +112,8 @@ namespace {
             m_configManager->setDefault(config::SettingMenuKeyDown, VK_F2);
             m_configManager->setDefault(config::SettingMenuKeyUp, 0);
             m_configManager->setDefault(config::SettingScreenshotKey, VK_F12);
+            m_configManager->setDefault(config::SettingProfileKey, VK_F10);
+            m_configManager->setDefault(config::SettingProfileCadence, 5); // 5s
             m_configManager->setDefault(config::SettingMenuEyeVisibility, XR_EYE_VISIBILITY_BOTH); // Both
             m_configManager->setDefault(config::SettingMenuEyeOffset, 0);
             m_configManager->setDefault(config::SettingMenuDistance, 100); // 1m
@@ -112,12 +142,14 @@ namespace {
             m_configManager->setDefault(config::SettingEyeDebugWithController, 0);
             m_configManager->setDefault(config::SettingEyeProjectionDistance, 200); // 2m
             m_configManager->setDefault(config::SettingEyeDebug, 0);
+            m_configManager->setEnumDefault(config::SettingEyeSaccadeHold, config::OffOnType::On);
 
             // Upscaling feature.
             m_configManager->setEnumDefault(config::SettingScalingType, config::ScalingType::None);
             m_configManager->setDefault(config::SettingScaling, 100);
             m_configManager->setDefault(config::SettingAnamorphic, -100);
             m_configManager->setDefault(config::SettingSharpness, 20);
+            m_configManager->setDefault(config::SettingCenterWeightedRadius, 50);
             // We default mip-map biasing to Off with OpenComposite since it's causing issues with certain apps. Users
             // have the (Expert) option to turn it back on.
             m_configManager->setEnumDefault(config::SettingMipMapBias,
@@ -139,6 +171,11 @@ namespace {
             m_configManager->setDefault(config::SettingVRSYOffset, 0);
             m_configManager->setDefault(config::SettingVRSPreferHorizontal, 0);
             m_configManager->setDefault(config::SettingVRSLeftRightBias, 0);
+            m_configManager->setEnumDefault(config::SettingVRSFullRateWithoutDepth, config::NoYesType::No);
+
+            // Quad views emulation.
+            m_configManager->setDefault(config::SettingQuadViewsFocusSize, 40);       // 40% of the FOV
+            m_configManager->setDefault(config::SettingQuadViewsPeripheralScale, 50); // 50% of the resolution
 
             // Appearance.
             m_configManager->setDefault(config::SettingPostProcess, 0);
@@ -206,6 +243,7 @@ namespace {
             m_configManager->setDefault("disable_frame_analyzer", m_isOpenComposite);
             m_configManager->setDefault("canting", 0);
             m_configManager->setDefault("vrs_capture", 0);
+            m_configManager->setDefault(config::SettingShaderTuning, 0);
 
             // Workaround: the first versions of the toolkit used a different representation for the world scale.
             // Migrate the value upon first run.
@@ -230,6 +268,10 @@ namespace {
                     xrGetInstanceProcAddr(GetXrInstance(), "xrConvertWin32PerformanceCounterToTimeKHR", &unused));
             }
             m_applicationName = createInfo->applicationInfo.applicationName;
+            m_applicationVersion = fmt::format("{} ({} {})",
+                                               createInfo->applicationInfo.applicationVersion,
+                                               createInfo->applicationInfo.engineName,
+                                               createInfo->applicationInfo.engineVersion);
             m_isOpenComposite = contains_string(m_applicationName, "OpenComposite_");
 
             Log("Application name: '%s', Engine name: '%s'%s\n",
@@ -237,6 +279,42 @@ namespace {
                 createInfo->applicationInfo.engineName,
                 m_isOpenComposite ? "\nDetected OpenComposite" : "");
 
+            // Remember which of the extensions we may emulate were requested by the application.
+            for (uint32_t i = 0; i < createInfo->enabledExtensionCount; i++) {
+                const std::string_view ext(createInfo->enabledExtensionNames[i]);
+                if (ext == "XR_KHR_D3D11_enable" || ext == "XR_KHR_D3D12_enable") {
+                    m_requestedDirect3D = true;
+                } else if (ext == "XR_VARJO_quad_views") {
+                    m_requestedQuadViews = true;
+                } else if (ext == "XR_VARJO_foveated_rendering") {
+                    m_requestedFoveatedRendering = true;
+                } else if (ext == "XR_FB_foveation") {
+                    m_requestedFoveationFB = true;
+                } else if (ext == "XR_META_foveation_eye_tracked") {
+                    m_requestedFoveationEyeTracked = true;
+                } else if (ext == "XR_EXT_eye_gaze_interaction") {
+                    m_requestedEyeGazeInteraction = true;
+                }
+            }
+
+            // The processing chain only has Direct3D backends. Applications using another graphics API (eg: Vulkan or
+            // OpenGL) must keep the native resolution, since we cannot upscale their images afterwards.
+            if (!m_requestedDirect3D) {
+                Log("Application does not use Direct3D: upscaling, post-processing and foveated rendering are "
+                    "unavailable\n");
+            }
+
+            // Emulate XR_FB_foveation with our VRS when the OpenXR runtime does not implement it.
+            if (m_requestedFoveationFB) {
+                PFN_xrVoidFunction unused;
+                m_emulateFoveationFB = XR_FAILED(
+                    OpenXrApi::xrGetInstanceProcAddr(GetXrInstance(), "xrCreateFoveationProfileFB", &unused));
+                if (m_emulateFoveationFB) {
+                    Log("Emulating foveation profiles%s\n",
+                        m_requestedFoveationEyeTracked ? " with eye tracking" : "");
+                }
+            }
+
             // Dump the OpenXR runtime information to help debugging customer issues.
             auto instanceProperties = XrInstanceProperties{XR_TYPE_INSTANCE_PROPERTIES};
             CHECK_XRCMD(xrGetInstanceProperties(GetXrInstance(), &instanceProperties));
@@ -270,6 +348,7 @@ namespace {
                 m_keyModifiers.push_back(VK_MENU);
             }
             m_keyScreenshot = m_configManager->getValue(config::SettingScreenshotKey);
+            m_keyProfile = m_configManager->getValue(config::SettingProfileKey);
 
             // We must initialize hand and eye tracking early on, because the application can start creating actions etc
             // before creating the session.
@@ -284,7 +363,7 @@ namespace {
             m_eyeTrackerAvail = m_eyeTracker ? m_eyeTracker->getEyeTrackerType() : input::EyeTrackerType::None;
 
             // TODO: If Foveated Rendering is disabled, maybe do not initialize the eye tracker?
-            if (m_configManager->getValue(config::SettingEyeTrackingEnabled)) {
+            if (m_configManager->getValue(config::SettingEyeTrackingEnabled) || m_requestedEyeGazeInteraction) {
                 if (m_eyeTracker && !m_eyeTracker->initialize()) {
                     DebugLog("Failed to initialize eye tracker\n");
                     m_eyeTracker = nullptr;
@@ -398,6 +477,150 @@ namespace {
                     m_eyeTrackerAvail = input::EyeTrackerType::None;
                     m_eyeTracker.reset();
                 }
+
+                // Expose the eye trackers that the OpenXR runtime does not know about to the application. When the
+                // OpenXR runtime does not implement the extension, we must handle the interaction profile even without
+                // an eye tracker, since the application believes the extension is enabled.
+                const bool hasEmulatedEyeTracker =
+                    m_eyeTracker && (m_eyeTrackerAvail == input::EyeTrackerType::Omnicept ||
+                                     m_eyeTrackerAvail == input::EyeTrackerType::Pimax);
+                m_emulateEyeGazeInteraction =
+                    m_requestedEyeGazeInteraction &&
+                    (hasEmulatedEyeTracker || !contains(GetGrantedExtensions(), "XR_EXT_eye_gaze_interaction"));
+                if (m_emulateEyeGazeInteraction) {
+                    Log("Emulating eye gaze interaction with %s\n",
+                        !hasEmulatedEyeTracker                                 ? "no eye tracker"
+                        : m_eyeTrackerAvail == input::EyeTrackerType::Omnicept ? "HP Omnicept"
+                                                                               : "Pimax Droolon");
+                }
+
+                // Emulate the quad views when the application asks for them but the OpenXR runtime does not support
+                // them. The composition requires our Direct3D processing chain.
+                if (m_requestedQuadViews && m_requestedDirect3D) {
+                    uint32_t count = 0;
+                    CHECK_XRCMD(OpenXrApi::xrEnumerateViewConfigurations(instance, *systemId, 0, &count, nullptr));
+                    std::vector<XrViewConfigurationType> viewConfigurations(count);
+                    CHECK_XRCMD(OpenXrApi::xrEnumerateViewConfigurations(
+                        instance, *systemId, count, &count, viewConfigurations.data()));
+
+                    m_emulateQuadViews =
+                        !contains(viewConfigurations, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+                    if (m_emulateQuadViews) {
+                        Log("Emulating quad views%s\n",
+                            m_requestedFoveatedRendering && m_eyeTracker ? " with eye-tracked foveated rendering" : "");
+                    }
+                } else if (m_requestedQuadViews) {
+                    // The application only sees the view configurations of the OpenXR runtime.
+                    Log("Quad views are not emulated without Direct3D\n");
+                }
+            }
+
+            return result;
+        }
+
+        XrResult xrGetSystemProperties(XrInstance instance,
+                                       XrSystemId systemId,
+                                       XrSystemProperties* properties) override {
+            const XrResult result = OpenXrApi::xrGetSystemProperties(instance, systemId, properties);
+            if (XR_SUCCEEDED(result) && isVrSystem(systemId) && m_emulateQuadViews) {
+                for (auto it = reinterpret_cast<XrBaseOutStructure*>(properties->next); it; it = it->next) {
+                    if (it->type == XR_TYPE_SYSTEM_FOVEATED_RENDERING_PROPERTIES_VARJO) {
+                        // Dynamic foveation follows the eye gaze.
+                        reinterpret_cast<XrSystemFoveatedRenderingPropertiesVARJO*>(it)->supportsFoveatedRendering =
+                            isFoveatedRenderingAvailable() ? XR_TRUE : XR_FALSE;
+                    }
+                }
+            }
+            if (XR_SUCCEEDED(result) && isVrSystem(systemId) && m_emulateEyeGazeInteraction) {
+                for (auto it = reinterpret_cast<XrBaseOutStructure*>(properties->next); it; it = it->next) {
+                    if (it->type == XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT) {
+                        reinterpret_cast<XrSystemEyeGazeInteractionPropertiesEXT*>(it)->supportsEyeGazeInteraction =
+                            m_eyeTracker ? XR_TRUE : XR_FALSE;
+                    }
+                }
+            }
+#ifdef XR_META_foveation_eye_tracked
+            if (XR_SUCCEEDED(result) && isVrSystem(systemId) && m_emulateFoveationFB &&
+                m_requestedFoveationEyeTracked) {
+                for (auto it = reinterpret_cast<XrBaseOutStructure*>(properties->next); it; it = it->next) {
+                    if (it->type == XR_TYPE_SYSTEM_FOVEATION_EYE_TRACKED_PROPERTIES_META) {
+                        reinterpret_cast<XrSystemFoveationEyeTrackedPropertiesMETA*>(it)->supportsFoveationEyeTracked =
+                            m_eyeTracker ? XR_TRUE : XR_FALSE;
+                    }
+                }
+            }
+#endif
+
+            return result;
+        }
+
+        XrResult xrEnumerateEnvironmentBlendModes(XrInstance instance,
+                                                  XrSystemId systemId,
+                                                  XrViewConfigurationType viewConfigurationType,
+                                                  uint32_t environmentBlendModeCapacityInput,
+                                                  uint32_t* environmentBlendModeCountOutput,
+                                                  XrEnvironmentBlendMode* environmentBlendModes) override {
+            if (isVrSystem(systemId) && m_emulateQuadViews &&
+                viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            }
+
+            return OpenXrApi::xrEnumerateEnvironmentBlendModes(instance,
+                                                               systemId,
+                                                               viewConfigurationType,
+                                                               environmentBlendModeCapacityInput,
+                                                               environmentBlendModeCountOutput,
+                                                               environmentBlendModes);
+        }
+
+        XrResult xrEnumerateViewConfigurations(XrInstance instance,
+                                               XrSystemId systemId,
+                                               uint32_t viewConfigurationTypeCapacityInput,
+                                               uint32_t* viewConfigurationTypeCountOutput,
+                                               XrViewConfigurationType* viewConfigurationTypes) override {
+            if (!isVrSystem(systemId) || !m_emulateQuadViews) {
+                return OpenXrApi::xrEnumerateViewConfigurations(instance,
+                                                                systemId,
+                                                                viewConfigurationTypeCapacityInput,
+                                                                viewConfigurationTypeCountOutput,
+                                                                viewConfigurationTypes);
+            }
+
+            uint32_t count = 0;
+            CHECK_XRCMD(OpenXrApi::xrEnumerateViewConfigurations(instance, systemId, 0, &count, nullptr));
+            std::vector<XrViewConfigurationType> viewConfigurations(count);
+            CHECK_XRCMD(
+                OpenXrApi::xrEnumerateViewConfigurations(instance, systemId, count, &count, viewConfigurations.data()));
+
+            // Advertise the quad views first, like a runtime supporting them natively would.
+            viewConfigurations.insert(viewConfigurations.begin(), XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO);
+
+            *viewConfigurationTypeCountOutput = static_cast<uint32_t>(viewConfigurations.size());
+            if (viewConfigurationTypeCapacityInput == 0) {
+                return XR_SUCCESS;
+            }
+            if (viewConfigurationTypeCapacityInput < viewConfigurations.size()) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+            std::copy(viewConfigurations.cbegin(), viewConfigurations.cend(), viewConfigurationTypes);
+
+            return XR_SUCCESS;
+        }
+
+        XrResult xrGetViewConfigurationProperties(XrInstance instance,
+                                                  XrSystemId systemId,
+                                                  XrViewConfigurationType viewConfigurationType,
+                                                  XrViewConfigurationProperties* configurationProperties) override {
+            if (!isVrSystem(systemId) || !m_emulateQuadViews ||
+                viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                return OpenXrApi::xrGetViewConfigurationProperties(
+                    instance, systemId, viewConfigurationType, configurationProperties);
+            }
+
+            const XrResult result = OpenXrApi::xrGetViewConfigurationProperties(
+                instance, systemId, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, configurationProperties);
+            if (XR_SUCCEEDED(result)) {
+                configurationProperties->viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO;
             }
 
             return result;
@@ -409,20 +632,19 @@ namespace {
                                                    uint32_t viewCapacityInput,
                                                    uint32_t* viewCountOutput,
                                                    XrViewConfigurationView* views) override {
+            if (isVrSystem(systemId) && m_emulateQuadViews &&
+                viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                return enumerateQuadViewConfigurationViews(
+                    instance, systemId, viewCapacityInput, viewCountOutput, views);
+            }
+
             const XrResult result = OpenXrApi::xrEnumerateViewConfigurationViews(
                 instance, systemId, viewConfigurationType, viewCapacityInput, viewCountOutput, views);
 
             if (XR_SUCCEEDED(result) && isVrSystem(systemId) && views) {
-                using namespace toolkit::config;
-
                 // Determine the application resolution.
-                auto inputWidth = m_displayWidth;
-                auto inputHeight = m_displayHeight;
-
-                if (m_configManager->getEnumValue<ScalingType>(SettingScalingType) != ScalingType::None) {
-                    std::tie(inputWidth, inputHeight) =
-                        GetScaledDimensions(m_configManager.get(), m_displayWidth, m_displayHeight, 2);
-                }
+                uint32_t inputWidth, inputHeight;
+                std::tie(inputWidth, inputHeight) = getInputResolution();
 
                 // Override the recommended image size to account for scaling.
                 std::for_each_n(views, *viewCountOutput, [inputWidth, inputHeight](auto& view) {
@@ -510,6 +732,14 @@ namespace {
                                                                                             m_displayWidth,
                                                                                             m_displayHeight);
                         }
+                        if (m_upscaleMode == ScalingType::CenterWeighted) {
+                            m_centerWeightedUpscaler = graphics::CreateCenterWeightedUpscaler(
+                                m_configManager, m_graphicsDevice, renderWidth, renderHeight);
+                            m_imageProcessors[ImgProc::Scale] = m_centerWeightedUpscaler;
+                        }
+
+                        // Stand-in for the upscaler if it trips the circuit breaker.
+                        m_passThroughScaler = graphics::CreatePassThroughScaler(m_graphicsDevice);
 
                         // Per FSR SDK documentation.
                         m_mipMapBiasForUpscaling = -std::log2f(static_cast<float>(m_displayWidth * m_displayHeight) /
@@ -520,7 +750,8 @@ namespace {
 
                     if (m_graphicsDevice->isEventsSupported()) {
                         if (!m_configManager->getValue("disable_frame_analyzer")) {
-                            m_frameAnalyzer = graphics::CreateFrameAnalyzer(m_configManager, m_graphicsDevice);
+                            m_frameAnalyzer = graphics::CreateFrameAnalyzer(
+                                m_configManager, m_graphicsDevice, renderWidth, renderHeight);
                         }
 
                         m_variableRateShader = graphics::CreateVariableRateShader(m_configManager,
@@ -534,42 +765,73 @@ namespace {
 
                         // Register intercepted events.
                         m_graphicsDevice->registerSetRenderTargetEvent(
-                            [&](std::shared_ptr<graphics::IContext> context,
-                                std::shared_ptr<graphics::ITexture> renderTarget) {
+                            [&](const std::shared_ptr<graphics::IContext>& context,
+                                const std::shared_ptr<graphics::ITexture>& renderTarget,
+                                bool hasDepthBuffer) {
                                 if (m_isInFrame) {
                                     auto eyeHint = utilities::Eye::Both;
                                     if (m_frameAnalyzer) {
                                         m_frameAnalyzer->onSetRenderTarget(context, renderTarget);
-                                        eyeHint = m_frameAnalyzer->getEyeHint();
-                                        m_stats.hasColorBuffer[to_integral(eyeHint)] = true;
+                                        eyeHint = m_frameAnalyzer->getEyeHint(context);
+                                        m_hasColorBuffer[to_integral(eyeHint)] = true;
+                                        m_graphicsDevice->setMipMapBiasPassActive(context,
+                                                                                  m_frameAnalyzer->isEyePass(context));
                                     }
                                     if (m_variableRateShader) {
-                                        if (m_variableRateShader->onSetRenderTarget(context, renderTarget, eyeHint))
-                                            m_stats.numRenderTargetsWithVRS++;
+                                        runGuarded(utilities::GuardedFeature::VariableRateShading, [&] {
+                                            if (m_variableRateShader->onSetRenderTarget(
+                                                    context, renderTarget, hasDepthBuffer, eyeHint))
+                                                m_numRenderTargetsWithVRS++;
+                                        });
                                     }
                                 }
                             });
 
                         m_graphicsDevice->registerUnsetRenderTargetEvent(
-                            [&](std::shared_ptr<graphics::IContext> context) {
+                            [&](const std::shared_ptr<graphics::IContext>& context) {
                                 if (m_isInFrame) {
-                                    if (m_frameAnalyzer)
+                                    if (m_frameAnalyzer) {
                                         m_frameAnalyzer->onUnsetRenderTarget(context);
+                                        m_graphicsDevice->setMipMapBiasPassActive(context, false);
+                                    }
                                     if (m_variableRateShader)
                                         m_variableRateShader->onUnsetRenderTarget(context);
                                 }
                             });
 
-                        m_graphicsDevice->registerCopyTextureEvent([&](std::shared_ptr<graphics::IContext>,
-                                                                       std::shared_ptr<graphics::ITexture> src,
-                                                                       std::shared_ptr<graphics::ITexture> dst,
-                                                                       int srcSlice,
-                                                                       int dstSlice) {
-                            if (m_isInFrame) {
-                                if (m_frameAnalyzer)
-                                    m_frameAnalyzer->onCopyTexture(src, dst, srcSlice, dstSlice);
-                            }
+                        m_graphicsDevice->registerCopyTextureEvent(
+                            [&](const std::shared_ptr<graphics::IContext>& context,
+                                const std::shared_ptr<graphics::ITexture>& src,
+                                const std::shared_ptr<graphics::ITexture>& dst,
+                                int srcSlice,
+                                int dstSlice) {
+                                if (m_isInFrame) {
+                                    if (m_frameAnalyzer)
+                                        m_frameAnalyzer->onCopyTexture(context, src, dst, srcSlice, dstSlice);
+                                }
+                            });
+
+                        // These must be handled even outside of the frame, since they close the per-context state.
+                        m_graphicsDevice->registerCloseContextEvent(
+                            [&](const std::shared_ptr<graphics::IContext>& context) {
+                                if (m_variableRateShader)
+                                    m_variableRateShader->onCloseContext(context);
+                            });
+
+                        m_graphicsDevice->registerExecuteContextsEvent([&](const std::vector<const void*>& contexts) {
+                            if (m_frameAnalyzer)
+                                m_frameAnalyzer->onExecuteContexts(contexts);
+                            if (m_variableRateShader)
+                                m_variableRateShader->onExecuteContexts(contexts);
                         });
+
+                        // The shading rates of the application are tracked for the whole lifetime of its command lists.
+                        m_graphicsDevice->registerSetShadingRateEvent(
+                            [&](const std::shared_ptr<graphics::IContext>& context,
+                                const graphics::IDevice::ShadingRateCommand& command) {
+                                if (m_variableRateShader)
+                                    m_variableRateShader->onSetShadingRate(context, command);
+                            });
                     }
 
                     m_imageProcessors[ImgProc::Post] = graphics::CreateImageProcessor(m_configManager,
@@ -580,6 +842,10 @@ namespace {
                                                                                       m_displayWidth,
                                                                                       m_displayHeight);
 
+                    if (m_emulateQuadViews) {
+                        m_quadViewsCompositor = graphics::CreateQuadViewsCompositor(m_configManager, m_graphicsDevice);
+                    }
+
                     m_performanceCounters.createGpuTimers(m_graphicsDevice.get());
                     m_performanceCounters.updateTimer.start();
 
@@ -633,6 +899,28 @@ namespace {
                         menuInfo.isPimaxFovHackSupported = m_supportFOVHack;
 
                         m_menuHandler = menu::CreateMenuHandler(m_configManager, m_graphicsDevice, menuInfo);
+
+                        // The system usage is only displayed in the advanced overlay.
+                        m_systemMonitor = utilities::CreateSystemMonitor(utilities::CreatePdhSystemUsageProvider(),
+                                                                         std::chrono::seconds(1));
+                        m_systemMonitor->setEnabled(
+                            m_configManager->getEnumValue<config::OverlayType>(config::SettingOverlayType) >=
+                            config::OverlayType::Advanced);
+                    }
+
+                    m_profileComparator = config::CreateProfileComparator(m_configManager);
+                    m_circuitBreaker = utilities::CreateCircuitBreaker();
+
+                    {
+                        utilities::SessionSummary environment;
+                        environment.applicationVersion = m_applicationVersion;
+                        environment.runtime = m_runtimeName;
+                        environment.driver = m_graphicsDevice->getDriverIdentifier();
+                        environment.device = m_graphicsDevice->getDeviceName();
+                        m_performanceSettings = getPerformanceSettings();
+                        environment.features = getPerformanceFeatures(m_performanceSettings);
+                        m_performanceHistory = utilities::CreatePerformanceHistory(
+                            localAppData / "history" / (m_applicationName + ".txt"), environment);
                     }
 
                     // Create a reference space to calculate projection views.
@@ -667,7 +955,22 @@ namespace {
         }
 
         XrResult xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo) override {
-            const XrResult result = OpenXrApi::xrBeginSession(session, beginInfo);
+            // The emulated quad views are advertised before the application picks its graphics API, but they can only
+            // be composited for the Direct3D sessions that we wrapped in xrCreateSession().
+            if (m_emulateQuadViews && !isVrSession(session) &&
+                beginInfo->primaryViewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                Log("Quad views are only emulated for Direct3D sessions\n");
+                return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+            }
+
+            // The runtime only knows about the stereo views that we composite the quad views into.
+            auto chainBeginInfo = *beginInfo;
+            if (isVrSession(session) && m_emulateQuadViews &&
+                chainBeginInfo.primaryViewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                chainBeginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            }
+
+            const XrResult result = OpenXrApi::xrBeginSession(session, &chainBeginInfo);
             if (XR_SUCCEEDED(result) && isVrSession(session)) {
                 m_configManager->setActiveSession(m_applicationName);
             }
@@ -703,7 +1006,10 @@ namespace {
                 }
 
                 // Destroy session instances in reverse order of their dependencies.
+                m_quadViewsCompositor.reset();
                 m_imageProcessors.fill(nullptr);
+                m_passThroughScaler.reset();
+                m_centerWeightedUpscaler.reset();
                 m_variableRateShader.reset();
                 m_frameAnalyzer.reset();
 
@@ -715,14 +1021,42 @@ namespace {
                     m_eyeTracker->endSession();
 
                 m_performanceCounters.destroyGpuTimers();
+                {
+                    std::unique_lock lock(m_poseSamplesLock);
+                    m_poseSampleTimes.clear();
+                }
+                m_eyeGazeSpaces.clear();
+                {
+                    std::unique_lock lock(m_foveationLock);
+                    m_foveationProfiles.clear();
+                    m_swapchainsFoveation.clear();
+                    m_appFoveation.reset();
+                    m_hasAppFoveationChanged = false;
+                }
 
                 m_swapchains.clear();
+                for (const auto& swapchains : m_quadViewsSwapchains) {
+                    for (auto swapchain : swapchains) {
+                        if (swapchain != XR_NULL_HANDLE) {
+                            xrDestroySwapchain(swapchain);
+                        }
+                    }
+                }
+                m_quadViewsSwapchains.clear();
                 m_menuSwapchainImages.clear();
                 if (m_menuSwapchain != XR_NULL_HANDLE) {
                     xrDestroySwapchain(m_menuSwapchain);
                     m_menuSwapchain = XR_NULL_HANDLE;
                 }
                 m_menuHandler.reset();
+                m_systemMonitor.reset();
+                m_profileComparator.reset();
+                m_isComparingProfiles = false;
+                m_circuitBreaker.reset();
+                if (m_performanceHistory) {
+                    m_performanceHistory->commit();
+                }
+                m_performanceHistory.reset();
                 if (m_graphicsDevice) {
                     m_graphicsDevice->shutdown();
                 }
@@ -786,9 +1120,13 @@ namespace {
                 if (m_imageProcessors[ImgProc::Scale]) {
                     // The upscaler requires to use as an unordered access view.
                     chainCreateInfo.usageFlags |= XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT;
-                    // When upscaling, be sure to request the full resolution with the runtime.
-                    chainCreateInfo.width = std::max(m_displayWidth, chainCreateInfo.width);
-                    chainCreateInfo.height = std::max(m_displayHeight, chainCreateInfo.height);
+                    // When upscaling, be sure to request the full resolution with the runtime. Scale the requested size
+                    // rather than using the display resolution, so that atlases of several views fit too.
+                    const auto [renderWidth, renderHeight] = getInputResolution();
+                    chainCreateInfo.width =
+                        static_cast<uint32_t>(std::ceil(createInfo->width * m_displayWidth / float(renderWidth)));
+                    chainCreateInfo.height =
+                        static_cast<uint32_t>(std::ceil(createInfo->height * m_displayHeight / float(renderHeight)));
                 }
                 if (m_imageProcessors[ImgProc::Post]) {
                     // These are not needed for the runtime swapchain: we're using an intermediate texture.
@@ -928,7 +1266,8 @@ namespace {
 
                     for (size_t j = 0; j < std::size(m_imageProcessors); j++) {
                         if (m_imageProcessors[j]) {
-                            for (size_t k = 0; k < std::min(createInfo->arraySize, 2u); k++)
+                            // One timer per view, even when the views share an atlas or a texture array.
+                            for (size_t k = 0; k < utilities::ViewCount; k++)
                                 swapchainState.images[i].gpuTimers[j][k] = m_graphicsDevice->createTimer();
                         }
                     }
@@ -944,6 +1283,9 @@ namespace {
             const XrResult result = OpenXrApi::xrDestroySwapchain(swapchain);
             if (XR_SUCCEEDED(result)) {
                 m_swapchains.erase(swapchain);
+
+                std::unique_lock lock(m_foveationLock);
+                m_swapchainsFoveation.erase(swapchain);
             }
 
             return result;
@@ -951,6 +1293,22 @@ namespace {
 
         XrResult xrSuggestInteractionProfileBindings(
             XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings) override {
+            if (m_emulateEyeGazeInteraction &&
+                getXrPath(suggestedBindings->interactionProfile) == "/interaction_profiles/ext/eye_gaze_interaction") {
+                // The OpenXR runtime does not know about this interaction profile. Remember the gaze actions, we will
+                // answer their queries ourselves.
+                m_eyeGazeActions.clear();
+                for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
+                    const auto& binding = suggestedBindings->suggestedBindings[i];
+                    if (getXrPath(binding.binding) != "/user/eyes_ext/input/gaze_ext/pose") {
+                        return XR_ERROR_PATH_UNSUPPORTED;
+                    }
+                    m_eyeGazeActions.insert(binding.action);
+                }
+                m_eyeGazeInteractionProfile = suggestedBindings->interactionProfile;
+                return XR_SUCCESS;
+            }
+
             if (m_configManager->getValue(config::SettingEyeDebugWithController)) {
                 // We must drop calls to allow the controller override for debugging.
                 if (suggestedBindings->countSuggestedBindings > 1 ||
@@ -970,6 +1328,11 @@ namespace {
 
         XrResult xrAttachSessionActionSets(XrSession session,
                                            const XrSessionActionSetsAttachInfo* attachInfo) override {
+            // Let the application know that the emulated eye gaze interaction profile is now current.
+            if (isVrSession(session) && !m_eyeGazeActions.empty()) {
+                m_sendInterationProfileEvent = true;
+            }
+
             const auto eyeTrackerActionSet = m_eyeTracker ? m_eyeTracker->getActionSet() : XR_NULL_HANDLE;
 
             if (eyeTrackerActionSet == XR_NULL_HANDLE)
@@ -989,7 +1352,20 @@ namespace {
         XrResult xrCreateAction(XrActionSet actionSet,
                                 const XrActionCreateInfo* createInfo,
                                 XrAction* action) override {
-            const XrResult result = OpenXrApi::xrCreateAction(actionSet, createInfo, action);
+            // The OpenXR runtime does not know about the /user/eyes_ext top level path.
+            auto chainCreateInfo = *createInfo;
+            std::vector<XrPath> newSubactionPaths;
+            if (m_emulateEyeGazeInteraction) {
+                for (uint32_t i = 0; i < createInfo->countSubactionPaths; i++) {
+                    if (getXrPath(createInfo->subactionPaths[i]) != "/user/eyes_ext") {
+                        newSubactionPaths.push_back(createInfo->subactionPaths[i]);
+                    }
+                }
+                chainCreateInfo.subactionPaths = newSubactionPaths.data();
+                chainCreateInfo.countSubactionPaths = static_cast<uint32_t>(newSubactionPaths.size());
+            }
+
+            const XrResult result = OpenXrApi::xrCreateAction(actionSet, &chainCreateInfo, action);
             if (XR_SUCCEEDED(result)) {
                 if (m_handTracker)
                     m_handTracker->registerAction(*action, actionSet);
@@ -1001,6 +1377,7 @@ namespace {
         XrResult xrDestroyAction(XrAction action) override {
             const XrResult result = OpenXrApi::xrDestroyAction(action);
             if (XR_SUCCEEDED(result)) {
+                m_eyeGazeActions.erase(action);
                 if (m_handTracker)
                     m_handTracker->unregisterAction(action);
             }
@@ -1011,6 +1388,17 @@ namespace {
         XrResult xrCreateActionSpace(XrSession session,
                                      const XrActionSpaceCreateInfo* createInfo,
                                      XrSpace* space) override {
+            if (isVrSession(session) && m_eyeGazeActions.count(createInfo->action)) {
+                // Keep track of the XrSpace for the eye gaze, so we can locate it ourselves.
+                auto chainCreateInfo = *createInfo;
+                chainCreateInfo.subactionPath = XR_NULL_PATH;
+                const XrResult result = OpenXrApi::xrCreateActionSpace(session, &chainCreateInfo, space);
+                if (XR_SUCCEEDED(result)) {
+                    m_eyeGazeSpaces.insert_or_assign(*space, createInfo->poseInActionSpace);
+                }
+                return result;
+            }
+
             const XrResult result = OpenXrApi::xrCreateActionSpace(session, createInfo, space);
             if (XR_SUCCEEDED(result) && isVrSession(session)) {
                 if (m_handTracker) {
@@ -1031,6 +1419,7 @@ namespace {
         XrResult xrDestroySpace(XrSpace space) override {
             const XrResult result = OpenXrApi::xrDestroySpace(space);
             if (XR_SUCCEEDED(result)) {
+                m_eyeGazeSpaces.erase(space);
                 if (m_handTracker)
                     m_handTracker->unregisterActionSpace(space);
             }
@@ -1131,6 +1520,13 @@ namespace {
                                                 XrPath topLevelUserPath,
                                                 XrInteractionProfileState* interactionProfile) override {
             if (isVrSession(session)) {
+                if (m_emulateEyeGazeInteraction && getXrPath(topLevelUserPath) == "/user/eyes_ext" &&
+                    interactionProfile->type == XR_TYPE_INTERACTION_PROFILE_STATE) {
+                    // Return our emulated interaction profile for the eye tracker.
+                    interactionProfile->interactionProfile =
+                        !m_eyeGazeActions.empty() ? m_eyeGazeInteractionProfile : XR_NULL_PATH;
+                    return XR_SUCCESS;
+                }
                 if (m_handTracker) {
                     // Return our emulated interaction profile for the hands.
                     const auto path = getXrPath(topLevelUserPath);
@@ -1149,6 +1545,17 @@ namespace {
                                         uint32_t viewIndex,
                                         XrVisibilityMaskTypeKHR visibilityMaskType,
                                         XrVisibilityMaskKHR* visibilityMask) override {
+            if (isVrSession(session) && m_emulateQuadViews &&
+                viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                // The focus views are always within the visible area.
+                if (viewIndex >= utilities::ViewCount) {
+                    visibilityMask->vertexCountOutput = 0;
+                    visibilityMask->indexCountOutput = 0;
+                    return XR_SUCCESS;
+                }
+                viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+            }
+
             // When doing the Pimax FOV hack, we swap left and right eyes.
             if (isVrSession(session)) {
                 if (m_supportFOVHack && m_configManager->peekValue(config::SettingPimaxFOVHack))
@@ -1165,6 +1572,11 @@ namespace {
                                uint32_t viewCapacityInput,
                                uint32_t* viewCountOutput,
                                XrView* views) override {
+            if (isVrSession(session) && m_emulateQuadViews &&
+                viewLocateInfo->viewConfigurationType == XR_VIEW_CONFIGURATION_TYPE_PRIMARY_QUAD_VARJO) {
+                return locateQuadViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
+            }
+
             const XrResult result =
                 OpenXrApi::xrLocateViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views);
 
@@ -1182,9 +1594,14 @@ namespace {
                         if (m_variableRateShader) {
                             m_variableRateShader->setViewProjectionCenters(m_projCenters[0], m_projCenters[1]);
                         }
+                        if (m_centerWeightedUpscaler) {
+                            m_centerWeightedUpscaler->setViewProjectionCenters(m_projCenters[0], m_projCenters[1]);
+                        }
                     }
                 }
 
+                recordPoseSample(viewLocateInfo->displayTime);
+
                 // Save the original views poses and orientations for xrEndFrame.
                 m_posesForFrame[0].pose = views[0].pose;
                 m_posesForFrame[1].pose = views[1].pose;
@@ -1277,16 +1694,30 @@ namespace {
 
         XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) override {
             if (location->type == XR_TYPE_SPACE_LOCATION) {
+                const auto eyeGazeSpace = m_eyeGazeSpaces.find(space);
+                if (eyeGazeSpace != m_eyeGazeSpaces.cend()) {
+                    locateEyeGaze(eyeGazeSpace->second, baseSpace, time, *location);
+                    return XR_SUCCESS;
+                }
                 if (m_handTracker) {
                     m_performanceCounters.handTrackingTimer.start();
-                    if (m_handTracker->locate(space, baseSpace, time, getXrTimeNow(), *location)) {
+                    bool isLocated = false;
+                    runGuarded(utilities::GuardedFeature::HandTracking, [&] {
+                        isLocated = m_handTracker->locate(space, baseSpace, time, getXrTimeNow(), *location);
+                    });
+                    if (isLocated) {
                         m_stats.handTrackingCpuTimeUs += m_performanceCounters.handTrackingTimer.stop();
                         return XR_SUCCESS;
                     }
                 }
             }
 
-            return OpenXrApi::xrLocateSpace(space, baseSpace, time, location);
+            const XrResult result = OpenXrApi::xrLocateSpace(space, baseSpace, time, location);
+            if (XR_SUCCEEDED(result)) {
+                recordPoseSample(time);
+            }
+
+            return result;
         }
 
         XrResult xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) override {
@@ -1315,7 +1746,8 @@ namespace {
             if (XR_SUCCEEDED(result) && isVrSession(session)) {
                 if (m_handTracker) {
                     m_performanceCounters.handTrackingTimer.start();
-                    m_handTracker->sync(m_begunFrameTime, getXrTimeNow(), *syncInfo);
+                    runGuarded(utilities::GuardedFeature::HandTracking,
+                               [&] { m_handTracker->sync(m_begunFrameTime, getXrTimeNow(), *syncInfo); });
                     m_stats.handTrackingCpuTimeUs += m_performanceCounters.handTrackingTimer.stop();
                 }
             }
@@ -1365,6 +1797,10 @@ namespace {
             if (isVrSession(session)) {
                 assert(getInfo->type == XR_TYPE_ACTION_STATE_GET_INFO &&
                        state->type == XR_TYPE_ACTION_STATE_POSE); // implicit
+                if (m_eyeGazeActions.count(getInfo->action)) {
+                    state->isActive = m_eyeTracker ? XR_TRUE : XR_FALSE;
+                    return XR_SUCCESS;
+                }
                 if (m_handTracker) {
                     m_performanceCounters.handTrackingTimer.start();
                     const std::string fullPath = m_handTracker->getFullPath(getInfo->action, getInfo->subactionPath);
@@ -1455,6 +1891,9 @@ namespace {
             if (XR_SUCCEEDED(result) && isVrSession(session)) {
                 m_stats.waitCpuTimeUs += m_performanceCounters.waitCpuTimer.stop();
 
+                // Record the display time predicted by the runtime, before any dampening.
+                m_waitedFramePredictedTime = frameState->predictedDisplayTime;
+
                 // Apply prediction dampening if possible and if needed.
                 if (m_hasPerformanceCounterKHR) {
                     const int predictionDampen = m_configManager->getValue(config::SettingPredictionDampen);
@@ -1479,6 +1918,7 @@ namespace {
             if (XR_SUCCEEDED(result) && isVrSession(session)) {
                 // Record the predicted display time.
                 m_begunFrameTime = m_waitedFrameTime;
+                m_begunFramePredictedTime = m_waitedFramePredictedTime;
                 m_isInFrame = true;
 
                 if (m_graphicsDevice) {
@@ -1500,7 +1940,8 @@ namespace {
                 }
 
                 if (m_variableRateShader) {
-                    m_variableRateShader->beginFrame(m_begunFrameTime);
+                    runGuarded(utilities::GuardedFeature::VariableRateShading,
+                               [&] { m_variableRateShader->beginFrame(m_begunFrameTime); });
                 }
             }
 
@@ -1565,6 +2006,11 @@ namespace {
             gLayerProjectionsViews.clear();
             gLayerProjectionsViews.reserve(gLayerHeaders.size() * utilities::ViewCount);
 
+            // Merge the emulated quad views into a stereo layer before applying the processing chain.
+            if (m_quadViewsCompositor) {
+                compositeQuadViews(session);
+            }
+
             struct {
                 const std::shared_ptr<graphics::ITexture>* color{nullptr};
                 const std::shared_ptr<graphics::ITexture>* depth{nullptr};
@@ -1579,11 +2025,10 @@ namespace {
 
                     const auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(baselayer);
 
-                    // For VPRT, we need to handle texture arrays.
+                    // For VPRT (or atlases), both views share the same swapchain.
                     const auto useVPRT = layer->views[0].subImage.swapchain == layer->views[1].subImage.swapchain;
                     if (useVPRT) {
                         // Assume that we've properly distinguished left/right eyes.
-                        // TODO: We need to use subImage.imageArrayIndex instead of assuming 0/left and 1/right.
                         m_stats.hasColorBuffer[to_integral(utilities::Eye::Left)] =
                             m_stats.hasColorBuffer[to_integral(utilities::Eye::Right)] = true;
                     }
@@ -1668,18 +2113,56 @@ namespace {
                         uint32_t nextImage = 0;
                         uint32_t lastImage = 0;
 
+                        // Only process the pixels rendered by the application. The upscaler produces the same
+                        // rectangle in the (larger) runtime texture.
+                        graphics::ProcessingRegion region;
+                        region.eye = static_cast<utilities::Eye>(eye);
+                        region.slice = swapchainImages.chain[0]->isArray()
+                                           ? static_cast<int32_t>(view.subImage.imageArrayIndex)
+                                           : -1;
+                        region.inputRect = view.subImage.imageRect;
+
                         for (size_t i = 0; i < std::size(m_imageProcessors); i++) {
                             if (m_imageProcessors[i]) {
-                                auto timer = swapchainImages.gpuTimers[i][useVPRT ? eye : 0].get();
+                                auto timer = swapchainImages.gpuTimers[i][eye].get();
                                 m_stats.processorGpuTimeUs[i] += timer->query();
 
                                 nextImage++;
+                                region.outputRect =
+                                    i == ImgProc::Scale
+                                        ? scaleRect(region.inputRect,
+                                                    swapchainImages.chain[lastImage]->getInfo(),
+                                                    swapchainImages.chain[nextImage]->getInfo())
+                                        : region.inputRect;
+
+                                const auto& input = swapchainImages.chain[lastImage];
+                                const auto& output = swapchainImages.chain[nextImage];
+                                const auto feature = i == ImgProc::Scale ? utilities::GuardedFeature::Upscaling
+                                                                         : utilities::GuardedFeature::PostProcess;
+
+                                // A degraded processor is replaced by a copy when the images are compatible, or by
+                                // a bilinear scale otherwise (the upscaler, since the resolution was negotiated with
+                                // the runtime). A processor that failed midway is replaced the same way, so that the
+                                // output is always written.
+                                const auto bypass = [&] {
+                                    if (canBypassProcessing(input, output)) {
+                                        input->copyTo(output);
+                                    } else if (m_passThroughScaler) {
+                                        m_passThroughScaler->process(input, output, region);
+                                    }
+                                };
+
                                 timer->start();
-                                m_imageProcessors[i]->process(swapchainImages.chain[lastImage],
-                                                              swapchainImages.chain[nextImage],
-                                                              useVPRT ? eye : -int32_t(eye + 1));
+                                if (m_circuitBreaker && m_circuitBreaker->isTripped(feature)) {
+                                    bypass();
+                                } else if (!runGuarded(feature,
+                                                       [&] { m_imageProcessors[i]->process(input, output, region); })) {
+                                    bypass();
+                                }
                                 timer->stop();
                                 lastImage++;
+
+                                region.inputRect = region.outputRect;
                             }
                         }
 
@@ -1689,10 +2172,7 @@ namespace {
                         }
 
                         // Patch the resolution.
-                        if (m_imageProcessors[ImgProc::Scale]) {
-                            view.subImage.imageRect.extent.width = m_displayWidth;
-                            view.subImage.imageRect.extent.height = m_displayHeight;
-                        }
+                        view.subImage.imageRect = region.inputRect;
                     }
 
                     auto lastView = std::addressof(gLayerProjectionsViews.back());
@@ -1867,6 +2347,11 @@ namespace {
                 utilities::UpdateKeyState(m_requestScreenShotKeyState, m_keyModifiers, m_keyScreenshot, false) &&
                 m_configManager->getValue(config::SettingScreenshotEnabled);
 
+            if (m_profileComparator &&
+                utilities::UpdateKeyState(m_profileKeyState, m_keyModifiers, m_keyProfile, false)) {
+                m_isComparingProfiles = m_profileComparator->toggle();
+            }
+
             if (requestScreenshot) {
                 // TODO: this is capturing frame N-3
                 // review the command queues/lists and context flush
@@ -1904,12 +2389,142 @@ namespace {
                 chainFrameEndInfo.displayTime = m_begunFrameTime;
             }
 
+            updateLatencyForFrame(frameEndInfo->displayTime);
+
             const auto result = OpenXrApi::xrEndFrame(session, &chainFrameEndInfo);
             m_graphicsDevice->unblockCallbacks();
 
             return result;
         }
 
+        XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) override {
+            const XrResult result = OpenXrApi::xrGetInstanceProcAddr(instance, name, function);
+            if (XR_FAILED(result) && m_emulateFoveationFB) {
+                const std::string_view apiName(name);
+                if (apiName == "xrCreateFoveationProfileFB") {
+                    *function = reinterpret_cast<PFN_xrVoidFunction>(emulated::xrCreateFoveationProfileFB);
+                } else if (apiName == "xrDestroyFoveationProfileFB") {
+                    *function = reinterpret_cast<PFN_xrVoidFunction>(emulated::xrDestroyFoveationProfileFB);
+                } else if (apiName == "xrUpdateSwapchainFB") {
+                    *function = reinterpret_cast<PFN_xrVoidFunction>(emulated::xrUpdateSwapchainFB);
+                } else if (apiName == "xrGetSwapchainStateFB") {
+                    *function = reinterpret_cast<PFN_xrVoidFunction>(emulated::xrGetSwapchainStateFB);
+#ifdef XR_META_foveation_eye_tracked
+                } else if (apiName == "xrGetFoveationEyeTrackedStateMETA" && m_requestedFoveationEyeTracked) {
+                    *function = reinterpret_cast<PFN_xrVoidFunction>(emulated::xrGetFoveationEyeTrackedStateMETA);
+#endif
+                } else {
+                    return result;
+                }
+                return XR_SUCCESS;
+            }
+
+            return result;
+        }
+
+        XrResult xrCreateFoveationProfileFB(XrSession session,
+                                            const XrFoveationProfileCreateInfoFB* createInfo,
+                                            XrFoveationProfileFB* profile) {
+            if (createInfo->type != XR_TYPE_FOVEATION_PROFILE_CREATE_INFO_FB) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+            if (!isVrSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            FoveationProfile newProfile;
+            for (auto it = reinterpret_cast<const XrBaseInStructure*>(createInfo->next); it; it = it->next) {
+                if (it->type == XR_TYPE_FOVEATION_LEVEL_PROFILE_CREATE_INFO_FB) {
+                    const auto levelInfo = reinterpret_cast<const XrFoveationLevelProfileCreateInfoFB*>(it);
+                    newProfile.level = levelInfo->level;
+                    newProfile.verticalOffset = levelInfo->verticalOffset;
+                    newProfile.dynamic = levelInfo->dynamic;
+                }
+#ifdef XR_META_foveation_eye_tracked
+                else if (it->type == XR_TYPE_FOVEATION_EYE_TRACKED_PROFILE_CREATE_INFO_META &&
+                         m_requestedFoveationEyeTracked) {
+                    newProfile.isEyeTracked = true;
+                }
+#endif
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "xrCreateFoveationProfileFB",
+                              TLArg((int)newProfile.level, "Level"),
+                              TLArg(newProfile.verticalOffset, "VerticalOffset"),
+                              TLArg((int)newProfile.dynamic, "Dynamic"),
+                              TLArg(newProfile.isEyeTracked, "EyeTracked"));
+
+            std::unique_lock lock(m_foveationLock);
+            *profile = reinterpret_cast<XrFoveationProfileFB>(++m_nextFoveationProfile);
+            m_foveationProfiles.insert_or_assign(*profile, newProfile);
+
+            return XR_SUCCESS;
+        }
+
+        XrResult xrDestroyFoveationProfileFB(XrFoveationProfileFB profile) {
+            // Swapchains keep the settings of the profile they were last updated with.
+            std::unique_lock lock(m_foveationLock);
+            return m_foveationProfiles.erase(profile) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
+        }
+
+        XrResult xrUpdateSwapchainFB(XrSwapchain swapchain, const XrSwapchainStateBaseHeaderFB* state) {
+            if (state->type != XR_TYPE_SWAPCHAIN_STATE_FOVEATION_FB) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            const auto foveationState = reinterpret_cast<const XrSwapchainStateFoveationFB*>(state);
+
+            std::unique_lock lock(m_foveationLock);
+            const auto it = m_foveationProfiles.find(foveationState->profile);
+            if (it == m_foveationProfiles.cend()) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            m_swapchainsFoveation.insert_or_assign(swapchain, std::make_pair(it->first, it->second));
+
+            // Our VRS applies to the whole frame: follow the last update.
+            m_appFoveation = it->second;
+            m_hasAppFoveationChanged = true;
+
+            return XR_SUCCESS;
+        }
+
+        XrResult xrGetSwapchainStateFB(XrSwapchain swapchain, XrSwapchainStateBaseHeaderFB* state) {
+            if (state->type != XR_TYPE_SWAPCHAIN_STATE_FOVEATION_FB) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+
+            auto foveationState = reinterpret_cast<XrSwapchainStateFoveationFB*>(state);
+            foveationState->flags = 0;
+
+            std::unique_lock lock(m_foveationLock);
+            const auto it = m_swapchainsFoveation.find(swapchain);
+            foveationState->profile = it != m_swapchainsFoveation.cend() ? it->second.first : XR_NULL_HANDLE;
+
+            return XR_SUCCESS;
+        }
+
+#ifdef XR_META_foveation_eye_tracked
+        XrResult xrGetFoveationEyeTrackedStateMETA(XrSession session, XrFoveationEyeTrackedStateMETA* foveationState) {
+            if (foveationState->type != XR_TYPE_FOVEATION_EYE_TRACKED_STATE_META) {
+                return XR_ERROR_VALIDATION_FAILURE;
+            }
+            if (!isVrSession(session)) {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+
+            XrVector2f gaze[utilities::ViewCount];
+            if (m_eyeTracker && m_eyeTracker->getProjectedGaze(gaze)) {
+                std::copy_n(gaze, utilities::ViewCount, foveationState->foveationCenter);
+                foveationState->flags = XR_FOVEATION_EYE_TRACKED_STATE_VALID_BIT_META;
+            } else {
+                foveationState->flags = 0;
+            }
+
+            return XR_SUCCESS;
+        }
+#endif
+
       private:
         bool isVrSystem(XrSystemId systemId) const {
             return systemId == m_vrSystemId;
@@ -1919,6 +2534,236 @@ namespace {
             return session == m_vrSession;
         }
 
+        bool isFoveatedRenderingAvailable() const {
+            return m_requestedFoveatedRendering && m_eyeTracker &&
+                   m_configManager->peekValue(config::SettingEyeTrackingEnabled);
+        }
+
+        // Determine the application resolution.
+        std::pair<uint32_t, uint32_t> getInputResolution() const {
+            using namespace toolkit::config;
+
+            if (m_configManager->getEnumValue<ScalingType>(SettingScalingType) != ScalingType::None &&
+                m_requestedDirect3D) {
+                return GetScaledDimensions(m_configManager.get(), m_displayWidth, m_displayHeight, 2);
+            }
+            return {m_displayWidth, m_displayHeight};
+        }
+
+        XrResult enumerateQuadViewConfigurationViews(XrInstance instance,
+                                                     XrSystemId systemId,
+                                                     uint32_t viewCapacityInput,
+                                                     uint32_t* viewCountOutput,
+                                                     XrViewConfigurationView* views) {
+            *viewCountOutput = QuadViewCount;
+            if (viewCapacityInput == 0) {
+                return XR_SUCCESS;
+            }
+            if (viewCapacityInput < QuadViewCount) {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            // The peripheral views are the stereo views at a lower resolution. The focus views keep the pixel density
+            // of the stereo views over a fraction of their field of view.
+            uint32_t stereoCount = 0;
+            const XrResult result = xrEnumerateViewConfigurationViews(instance,
+                                                                      systemId,
+                                                                      XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                                                                      utilities::ViewCount,
+                                                                      &stereoCount,
+                                                                      views);
+            if (XR_SUCCEEDED(result)) {
+                const auto peripheralScale =
+                    std::clamp(m_configManager->getValue(config::SettingQuadViewsPeripheralScale), 10, 100);
+                const auto focusSize = std::clamp(m_configManager->getValue(config::SettingQuadViewsFocusSize), 10, 90);
+
+                for (uint32_t eye = 0; eye < utilities::ViewCount; eye++) {
+                    auto& peripheral = views[eye];
+                    auto& focus = views[eye + utilities::ViewCount];
+
+                    focus.recommendedImageRectWidth =
+                        utilities::GetScaledInputSize(peripheral.recommendedImageRectWidth, focusSize, 2);
+                    focus.recommendedImageRectHeight =
+                        utilities::GetScaledInputSize(peripheral.recommendedImageRectHeight, focusSize, 2);
+                    focus.maxImageRectWidth = peripheral.maxImageRectWidth;
+                    focus.maxImageRectHeight = peripheral.maxImageRectHeight;
+                    focus.recommendedSwapchainSampleCount = peripheral.recommendedSwapchainSampleCount;
+                    focus.maxSwapchainSampleCount = peripheral.maxSwapchainSampleCount;
+
+                    peripheral.recommendedImageRectWidth =
+                        utilities::GetScaledInputSize(peripheral.recommendedImageRectWidth, peripheralScale, 2);
+                    peripheral.recommendedImageRectHeight =
+                        utilities::GetScaledInputSize(peripheral.recommendedImageRectHeight, peripheralScale, 2);
+                }
+
+                Log("Emulating quad views: peripheral %ux%u, focus %ux%u\n",
+                    views[0].recommendedImageRectWidth,
+                    views[0].recommendedImageRectHeight,
+                    views[utilities::ViewCount].recommendedImageRectWidth,
+                    views[utilities::ViewCount].recommendedImageRectHeight);
+            }
+
+            *viewCountOutput = QuadViewCount;
+            return result;
+        }
+
+        XrResult locateQuadViews(XrSession session,
+                                 const XrViewLocateInfo* viewLocateInfo,
+                                 XrViewState* viewState,
+                                 uint32_t viewCapacityInput,
+                                 uint32_t* viewCountOutput,
+                                 XrView* views) {
+            auto stereoLocateInfo = *viewLocateInfo;
+            stereoLocateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+
+            uint32_t stereoCount = 0;
+            if (viewCapacityInput == 0) {
+                *viewCountOutput = QuadViewCount;
+                return OpenXrApi::xrLocateViews(session, &stereoLocateInfo, viewState, 0, &stereoCount, nullptr);
+            }
+            if (viewCapacityInput < QuadViewCount) {
+                *viewCountOutput = QuadViewCount;
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+
+            // Locate the stereo views through our own implementation to get all the overrides applied.
+            const XrResult result =
+                xrLocateViews(session, &stereoLocateInfo, viewState, utilities::ViewCount, &stereoCount, views);
+
+            if (XR_SUCCEEDED(result)) {
+                bool foveatedRenderingActive = false;
+                for (auto it = reinterpret_cast<const XrBaseInStructure*>(viewLocateInfo->next); it; it = it->next) {
+                    if (it->type == XR_TYPE_VIEW_LOCATE_FOVEATED_RENDERING_VARJO) {
+                        foveatedRenderingActive =
+                            reinterpret_cast<const XrViewLocateFoveatedRenderingVARJO*>(it)->foveatedRenderingActive;
+                    }
+                }
+
+                // Center the focus views on the eye gaze when possible, otherwise on the projection centers.
+                XrVector2f centers[utilities::ViewCount] = {};
+                if (!m_needCalibrateEyeProjections) {
+                    std::copy_n(m_projCenters, utilities::ViewCount, centers);
+                }
+                XrVector2f gaze[utilities::ViewCount];
+                if (foveatedRenderingActive && isFoveatedRenderingAvailable() && m_eyeTracker->getProjectedGaze(gaze)) {
+                    std::copy_n(gaze, utilities::ViewCount, centers);
+                }
+
+                const auto focusSize =
+                    std::clamp(m_configManager->getValue(config::SettingQuadViewsFocusSize), 10, 90) * 0.01f;
+
+                for (uint32_t eye = 0; eye < utilities::ViewCount; eye++) {
+                    auto& focus = views[eye + utilities::ViewCount];
+                    focus.pose = views[eye].pose;
+                    focus.fov = utilities::GetFocusFov(views[eye].fov, centers[eye], focusSize);
+                }
+            }
+
+            *viewCountOutput = QuadViewCount;
+            return result;
+        }
+
+        // Replace each quad views projection layer with a stereo layer, compositing the focus views over the peripheral
+        // views.
+        void compositeQuadViews(XrSession session) {
+            // We must reserve the underlying storage to keep our pointers stable.
+            gLayerProjectionsForQuadViews.clear();
+            gLayerProjectionsForQuadViews.reserve(gLayerHeaders.size());
+            gLayerProjectionsViewsForQuadViews.clear();
+            gLayerProjectionsViewsForQuadViews.reserve(gLayerHeaders.size() * utilities::ViewCount);
+
+            for (auto& baseLayer : gLayerHeaders) {
+                if (baseLayer->type != XR_TYPE_COMPOSITION_LAYER_PROJECTION) {
+                    continue;
+                }
+
+                const auto layer = reinterpret_cast<const XrCompositionLayerProjection*>(baseLayer);
+                if (layer->viewCount != QuadViewCount) {
+                    continue;
+                }
+
+                // Each layer composites into its own set of swapchains.
+                const auto layerIndex = static_cast<uint32_t>(gLayerProjectionsForQuadViews.size());
+                if (m_quadViewsSwapchains.size() <= layerIndex) {
+                    m_quadViewsSwapchains.push_back({XR_NULL_HANDLE, XR_NULL_HANDLE});
+                }
+
+                for (uint32_t eye = 0; eye < utilities::ViewCount; eye++) {
+                    const auto& peripheralView = layer->views[eye];
+                    const auto& focusView = layer->views[eye + utilities::ViewCount];
+
+                    const auto peripheralIt = m_swapchains.find(peripheralView.subImage.swapchain);
+                    const auto focusIt = m_swapchains.find(focusView.subImage.swapchain);
+                    if (peripheralIt == m_swapchains.end() || focusIt == m_swapchains.end()) {
+                        throw std::runtime_error("Swapchain is not registered");
+                    }
+
+                    const auto& peripheralState = peripheralIt->second;
+                    const auto& peripheral = peripheralState.images[peripheralState.acquiredImageIndex].chain[0];
+                    const auto& focusState = focusIt->second;
+                    const auto& focus = focusState.images[focusState.acquiredImageIndex].chain[0];
+
+                    // Lazily create the stereo swapchains to composite into. They go through our processing chain like
+                    // any other application swapchain.
+                    uint32_t inputWidth, inputHeight;
+                    std::tie(inputWidth, inputHeight) = getInputResolution();
+
+                    auto& swapchain = m_quadViewsSwapchains[layerIndex][eye];
+                    if (swapchain == XR_NULL_HANDLE) {
+                        auto swapchainInfo = XrSwapchainCreateInfo{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+                        swapchainInfo.width = inputWidth;
+                        swapchainInfo.height = inputHeight;
+                        swapchainInfo.arraySize = 1;
+                        swapchainInfo.usageFlags =
+                            XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+                        swapchainInfo.format = peripheral->getInfo().format;
+                        swapchainInfo.sampleCount = 1;
+                        swapchainInfo.faceCount = 1;
+                        swapchainInfo.mipCount = 1;
+                        CHECK_XRCMD(xrCreateSwapchain(session, &swapchainInfo, &swapchain));
+                    }
+
+                    uint32_t imageIndex;
+                    CHECK_XRCMD(xrAcquireSwapchainImage(swapchain, nullptr, &imageIndex));
+                    auto waitInfo = XrSwapchainImageWaitInfo{XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO};
+                    waitInfo.timeout = XR_INFINITE_DURATION;
+                    CHECK_XRCMD(OpenXrApi::xrWaitSwapchainImage(swapchain, &waitInfo));
+
+                    m_quadViewsCompositor->composite(
+                        peripheral,
+                        peripheral->isArray() ? static_cast<int32_t>(peripheralView.subImage.imageArrayIndex) : -1,
+                        peripheralView.subImage.imageRect,
+                        focus,
+                        focus->isArray() ? static_cast<int32_t>(focusView.subImage.imageArrayIndex) : -1,
+                        focusView.subImage.imageRect,
+                        utilities::GetFocusArea(peripheralView.fov, focusView.fov),
+                        m_swapchains.at(swapchain).images[imageIndex].chain[0],
+                        static_cast<utilities::Eye>(eye),
+                        layerIndex);
+
+                    // The release is delayed until the end of xrEndFrame().
+                    const auto releaseInfo = XrSwapchainImageReleaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
+                    CHECK_XRCMD(xrReleaseSwapchainImage(swapchain, &releaseInfo));
+
+                    // The depth buffers cannot be composited: do not forward them.
+                    auto& view = gLayerProjectionsViewsForQuadViews.emplace_back(
+                        XrCompositionLayerProjectionView{XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW});
+                    view.pose = peripheralView.pose;
+                    view.fov = peripheralView.fov;
+                    view.subImage.swapchain = swapchain;
+                    view.subImage.imageRect.offset = {0, 0};
+                    view.subImage.imageRect.extent.width = inputWidth;
+                    view.subImage.imageRect.extent.height = inputHeight;
+                    view.subImage.imageArrayIndex = 0;
+                }
+
+                auto& stereoLayer = gLayerProjectionsForQuadViews.emplace_back(*layer);
+                stereoLayer.viewCount = utilities::ViewCount;
+                stereoLayer.views = std::addressof(gLayerProjectionsViewsForQuadViews.back()) - 1;
+                baseLayer = reinterpret_cast<const XrCompositionLayerBaseHeader*>(std::addressof(stereoLayer));
+            }
+        }
+
         std::string getXrPath(XrPath path) {
             uint32_t count;
             CHECK_XRCMD(xrPathToString(GetXrInstance(), path, 0, &count, nullptr));
@@ -1939,6 +2784,142 @@ namespace {
             return xrTimeNow;
         }
 
+        // Map a rectangle of a texture to the same area of a texture with different dimensions.
+        static XrRect2Di scaleRect(const XrRect2Di& rect,
+                                   const XrSwapchainCreateInfo& from,
+                                   const XrSwapchainCreateInfo& to) {
+            const auto scale = [](int32_t value, uint32_t fromSize, uint32_t toSize) {
+                return static_cast<int32_t>((static_cast<int64_t>(value) * toSize + fromSize / 2) / fromSize);
+            };
+
+            XrRect2Di scaled;
+            scaled.offset.x = scale(rect.offset.x, from.width, to.width);
+            scaled.offset.y = scale(rect.offset.y, from.height, to.height);
+            scaled.extent.width = scale(rect.offset.x + rect.extent.width, from.width, to.width) - scaled.offset.x;
+            scaled.extent.height = scale(rect.offset.y + rect.extent.height, from.height, to.height) - scaled.offset.y;
+            return scaled;
+        }
+
+        // Locate the gaze for the emulated eye gaze interaction. The gaze is the latest sample from the eye tracker,
+        // and its actual time is reported through XrEyeGazeSampleTimeEXT.
+        void locateEyeGaze(const XrPosef& poseInActionSpace,
+                           XrSpace baseSpace,
+                           XrTime time,
+                           XrSpaceLocation& location) {
+            location.locationFlags = 0;
+
+            XrEyeGazeSampleTimeEXT* sampleTime = nullptr;
+            for (auto it = reinterpret_cast<XrBaseOutStructure*>(location.next); it; it = it->next) {
+                if (it->type == XR_TYPE_EYE_GAZE_SAMPLE_TIME_EXT) {
+                    sampleTime = reinterpret_cast<XrEyeGazeSampleTimeEXT*>(it);
+                    sampleTime->time = 0;
+                } else if (it->type == XR_TYPE_SPACE_VELOCITY) {
+                    reinterpret_cast<XrSpaceVelocity*>(it)->velocityFlags = 0;
+                }
+            }
+
+            XrVector3f gazeDirection;
+            LARGE_INTEGER gazeTime;
+            if (!m_eyeTracker || m_viewSpace == XR_NULL_HANDLE ||
+                !m_eyeTracker->getGazeSample(gazeDirection, gazeTime)) {
+                return;
+            }
+
+            XrSpaceLocation viewLocation{XR_TYPE_SPACE_LOCATION, nullptr};
+            CHECK_XRCMD(OpenXrApi::xrLocateSpace(m_viewSpace, baseSpace, time, &viewLocation));
+            if (!Pose::IsPoseValid(viewLocation)) {
+                return;
+            }
+
+            // Rotate the forward axis (-Z) onto the gaze direction.
+            XrPosef gazeInView = Pose::Identity();
+            StoreXrQuaternion(&gazeInView.orientation,
+                              DirectX::XMQuaternionNormalize(
+                                  DirectX::XMVectorSet(gazeDirection.y, -gazeDirection.x, 0.f, 1.f - gazeDirection.z)));
+
+            location.pose = Pose::Multiply(poseInActionSpace, Pose::Multiply(gazeInView, viewLocation.pose));
+            location.locationFlags = viewLocation.locationFlags;
+
+            if (sampleTime) {
+                sampleTime->time = time;
+                if (m_hasPerformanceCounterKHR) {
+                    CHECK_XRCMD(
+                        xrConvertWin32PerformanceCounterToTimeKHR(GetXrInstance(), &gazeTime, &sampleTime->time));
+                }
+            }
+        }
+
+        // Forward the foveation profile last applied by the application to the VRS.
+        void updateApplicationFoveation() {
+            std::unique_lock lock(m_foveationLock);
+            if (!std::exchange(m_hasAppFoveationChanged, false)) {
+                return;
+            }
+
+            std::optional<graphics::VariableRateShaderFoveation> foveation;
+            if (m_appFoveation) {
+                foveation = utilities::GetFoveationForLevel(m_appFoveation->level,
+                                                            m_appFoveation->verticalOffset,
+                                                            m_posesForFrame[0].fov,
+                                                            m_appFoveation->isEyeTracked && m_eyeTracker);
+            }
+            m_variableRateShader->setApplicationFoveation(foveation);
+        }
+
+        // Remember when the app last sampled a pose for the frame being prepared.
+        void recordPoseSample(XrTime displayTime) {
+            if (!m_hasPerformanceCounterKHR || displayTime != m_waitedFrameTime) {
+                return;
+            }
+
+            const auto now = getXrTimeNow();
+            std::unique_lock lock(m_poseSamplesLock);
+            m_poseSampleTimes[displayTime] = now;
+        }
+
+        // Estimate the motion-to-photon latency of the frame being submitted.
+        //   pose age: time between the last pose sample for the frame and its submission.
+        //   motion-to-photon: time between the last pose sample and the display time predicted by the runtime.
+        //   dampening: how much shorter the prediction given to the app was (the latency left uncompensated).
+        void updateLatencyForFrame(XrTime displayTime) {
+            if (!m_hasPerformanceCounterKHR) {
+                return;
+            }
+
+            XrTime poseSampleTime = 0;
+            {
+                std::unique_lock lock(m_poseSamplesLock);
+                const auto it = m_poseSampleTimes.find(displayTime);
+                if (it != m_poseSampleTimes.end()) {
+                    poseSampleTime = it->second;
+                }
+                m_poseSampleTimes.erase(m_poseSampleTimes.begin(), m_poseSampleTimes.upper_bound(displayTime));
+            }
+            if (!poseSampleTime) {
+                return;
+            }
+
+            const auto submitTime = getXrTimeNow();
+            const auto poseAge = std::max(submitTime - poseSampleTime, XrTime{0});
+            const auto motionToPhoton = std::max(m_begunFramePredictedTime - poseSampleTime, XrTime{0});
+            const auto dampenedPrediction = std::max(m_begunFramePredictedTime - displayTime, XrTime{0});
+
+            m_stats.poseAgeUs += poseAge / 1000;
+            m_stats.motionToPhotonUs += motionToPhoton / 1000;
+            m_stats.dampenedPredictionUs += dampenedPrediction / 1000;
+            m_performanceCounters.numLatencyFrames++;
+
+            TraceLoggingWrite(g_traceProvider,
+                              "FrameLatency",
+                              TLArg(displayTime, "DisplayTime"),
+                              TLArg(m_begunFramePredictedTime, "PredictedDisplayTime"),
+                              TLArg(poseSampleTime, "PoseSampleTime"),
+                              TLArg(submitTime, "SubmitTime"),
+                              TLArg(poseAge, "PoseAge"),
+                              TLArg(motionToPhoton, "MotionToPhoton"),
+                              TLArg(dampenedPrediction, "DampenedPrediction"));
+        }
+
         bool calibrateEyeProjection(XrSession session, XrViewLocateInfo viewLocateInfo) {
             viewLocateInfo.space = m_viewSpace;
             auto viewsState = XrViewState{XR_TYPE_VIEW_STATE};
@@ -1996,10 +2977,38 @@ namespace {
             const auto now = std::chrono::steady_clock::now();
             const auto numFrames = ++m_performanceCounters.numFrames;
 
+            // Collect the statistics updated from the application's rendering threads.
+            m_stats.numRenderTargetsWithVRS += m_numRenderTargetsWithVRS.exchange(0);
+            for (size_t i = 0; i < std::size(m_hasColorBuffer); i++) {
+                if (m_hasColorBuffer[i].exchange(false)) {
+                    m_stats.hasColorBuffer[i] = true;
+                }
+            }
+
             if (m_graphicsDevice) {
                 m_stats.numBiasedSamplers = m_graphicsDevice->getNumBiasedSamplersThisFrame();
             }
 
+            if (m_performanceHistory) {
+                // The A/B comparison switches the settings back and forth: suspend the recording rather than
+                // restarting it.
+                if (!m_isComparingProfiles && m_performanceCounters.lastFrameTime.time_since_epoch().count()) {
+                    m_performanceHistory->addFrame(std::chrono::duration_cast<std::chrono::microseconds>(
+                                                       now - m_performanceCounters.lastFrameTime)
+                                                       .count());
+                }
+                m_performanceCounters.lastFrameTime = now;
+            }
+
+            // The GPU time of the last frame is the difference of the running sums.
+            if (m_profileComparator) {
+                const uint64_t gpuTimeUs = m_stats.appGpuTimeUs + m_stats.processorGpuTimeUs[0] +
+                                           m_stats.processorGpuTimeUs[1] + m_stats.processorGpuTimeUs[2] +
+                                           m_stats.overlayGpuTimeUs;
+                m_profileComparator->onFrame(gpuTimeUs - m_performanceCounters.lastGpuTimeUs);
+                m_performanceCounters.lastGpuTimeUs = gpuTimeUs;
+            }
+
             if (m_performanceCounters.updateTimer.restart(std::chrono::seconds(1))) {
                 m_performanceCounters.numFrames = 0;
 
@@ -2018,8 +3027,37 @@ namespace {
                 m_stats.overlayGpuTimeUs /= numFrames;
                 m_stats.handTrackingCpuTimeUs /= numFrames;
                 m_stats.predictionTimeUs /= numFrames;
+                if (const auto numLatencyFrames = m_performanceCounters.numLatencyFrames) {
+                    m_stats.poseAgeUs /= numLatencyFrames;
+                    m_stats.motionToPhotonUs /= numLatencyFrames;
+                    m_stats.dampenedPredictionUs /= numLatencyFrames;
+                    m_performanceCounters.numLatencyFrames = 0;
+                }
                 m_stats.fps = static_cast<float>(numFrames);
 
+                if (m_circuitBreaker) {
+                    const uint64_t frameTimeUs = 1000000 / numFrames;
+                    const std::pair<utilities::GuardedFeature, uint64_t> costs[] = {
+                        {utilities::GuardedFeature::Upscaling, m_stats.processorGpuTimeUs[ImgProc::Scale]},
+                        {utilities::GuardedFeature::PostProcess, m_stats.processorGpuTimeUs[ImgProc::Post]},
+                        {utilities::GuardedFeature::HandTracking, m_stats.handTrackingCpuTimeUs},
+                    };
+                    for (const auto& [feature, costUs] : costs) {
+                        if (m_circuitBreaker->reportCost(feature, costUs, frameTimeUs)) {
+                            degradeFeature(feature);
+                        }
+                    }
+                }
+
+                if (m_performanceHistory && !m_isComparingProfiles) {
+                    const auto settings = getPerformanceSettings();
+                    if (settings != m_performanceSettings) {
+                        m_performanceSettings = settings;
+                        m_performanceHistory->setFeatures(getPerformanceFeatures(settings));
+                    }
+                    m_performanceHistory->addTimings(m_stats.appCpuTimeUs, m_stats.appGpuTimeUs);
+                }
+
                 // When CPU-bound, do not bother giving a (false) GPU time for D3D12
                 if (m_graphicsDevice->getAs<graphics::D3D12>()) {
                     if (m_stats.appGpuTimeUs < (m_stats.appCpuTimeUs + 500))
@@ -2035,11 +3073,24 @@ namespace {
                     // convert to degrees for display (1Hz)
                     StoreXrFov(&m_stats.fov[0], ConvertToDegrees(m_posesForFrame[0].fov));
                     StoreXrFov(&m_stats.fov[1], ConvertToDegrees(m_posesForFrame[1].fov));
+                    if (m_systemMonitor) {
+                        m_stats.systemUsage = m_systemMonitor->getUsage();
+                    }
+                    if (m_profileComparator) {
+                        m_stats.profileComparison = m_profileComparator->getComparison();
+                    }
+                    if (m_performanceHistory) {
+                        m_stats.performanceRegression = m_performanceHistory->getRegression();
+                    }
+                    if (m_circuitBreaker) {
+                        m_stats.trippedFeatures = m_circuitBreaker->getTrippedFeatures();
+                    }
                     m_menuHandler->updateStatistics(m_stats);
                 }
 
                 // Start from fresh!
                 memset(&m_stats, 0, sizeof(m_stats));
+                m_performanceCounters.lastGpuTimeUs = 0;
             }
 
             if (m_handTracker && m_menuHandler) {
@@ -2054,6 +3105,87 @@ namespace {
             m_stats.numRenderTargetsWithVRS = 0;
         }
 
+        // Run a feature, and report its exceptions to the circuit breaker instead of letting them reach the app.
+        template <typename Function>
+        bool runGuarded(utilities::GuardedFeature feature, Function&& function) {
+            if (!m_circuitBreaker) {
+                function();
+                return true;
+            }
+
+            try {
+                function();
+                return true;
+            } catch (std::exception& exc) {
+                if (m_circuitBreaker->reportFault(feature, exc.what())) {
+                    degradeFeature(feature);
+                }
+                return false;
+            }
+        }
+
+        void degradeFeature(utilities::GuardedFeature feature) {
+            switch (feature) {
+            case utilities::GuardedFeature::Upscaling:
+                // Replaced by a bilinear scale in the processing chain.
+                break;
+
+            case utilities::GuardedFeature::PostProcess:
+                // Bypassed in the processing chain.
+                break;
+
+            case utilities::GuardedFeature::VariableRateShading:
+                if (m_variableRateShader) {
+                    m_variableRateShader->suspend();
+                }
+                break;
+
+            case utilities::GuardedFeature::HandTracking:
+                if (m_handTracker) {
+                    m_handTracker->suspend();
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        static bool canBypassProcessing(const std::shared_ptr<graphics::ITexture>& input,
+                                        const std::shared_ptr<graphics::ITexture>& output) {
+            const auto& inputInfo = input->getInfo();
+            const auto& outputInfo = output->getInfo();
+            return inputInfo.width == outputInfo.width && inputInfo.height == outputInfo.height &&
+                   inputInfo.arraySize == outputInfo.arraySize && input->getNativeFormat() == output->getNativeFormat();
+        }
+
+        // The settings that affect the performance, to only compare sessions with the same ones.
+        using PerformanceSettings = std::array<int, 8>;
+        PerformanceSettings getPerformanceSettings() const {
+            return {m_configManager->peekValue(config::SettingScalingType),
+                    m_configManager->peekValue(config::SettingScaling),
+                    m_configManager->peekValue(config::SettingAnamorphic),
+                    m_configManager->peekValue(config::SettingVRS),
+                    m_configManager->peekValue(config::SettingVRSQuality),
+                    m_configManager->peekValue(config::SettingPostProcess),
+                    m_configManager->peekValue(config::SettingHandTrackingEnabled),
+                    m_configManager->peekValue(config::SettingMotionReprojection)};
+        }
+
+        std::string getPerformanceFeatures(const PerformanceSettings& settings) const {
+            return fmt::format("{}x{} scl={}/{}/{} vrs={}/{} pst={} hnd={} mr={}",
+                               m_displayWidth,
+                               m_displayHeight,
+                               settings[0],
+                               settings[1],
+                               settings[2],
+                               settings[3],
+                               settings[4],
+                               settings[5],
+                               settings[6],
+                               settings[7]);
+        }
+
         void updateConfiguration() {
             // Make sure config gets written if needed.
             m_configManager->tick();
@@ -2099,8 +3231,10 @@ namespace {
             if (m_eyeTracker)
                 m_eyeTracker->update();
 
-            if (m_variableRateShader)
-                m_variableRateShader->update();
+            if (m_variableRateShader) {
+                updateApplicationFoveation();
+                runGuarded(utilities::GuardedFeature::VariableRateShading, [&] { m_variableRateShader->update(); });
+            }
 
             // Update image processors and prepare the Shaders for rendering.
             for (auto& processor : m_imageProcessors) {
@@ -2110,6 +3244,18 @@ namespace {
                     processor->update();
                 }
             }
+
+            if (m_passThroughScaler && reloadShaders)
+                m_passThroughScaler->reload();
+
+            if (m_quadViewsCompositor && reloadShaders)
+                m_quadViewsCompositor->reload();
+
+            if (m_systemMonitor && m_configManager->hasChanged(config::SettingOverlayType)) {
+                m_systemMonitor->setEnabled(
+                    m_configManager->getEnumValue<config::OverlayType>(config::SettingOverlayType) >=
+                    config::OverlayType::Advanced);
+            }
         }
 
         void takeScreenshot(const graphics::ITexture* texture, std::string_view suffix) const {
@@ -2124,9 +3270,10 @@ namespace {
 
                 if (m_upscaleMode != config::ScalingType::None) {
                     // TODO: add a getUpscaleModeName() helper to keep enum and string in sync.
-                    const auto upscaleName = m_upscaleMode == config::ScalingType::NIS   ? "_NIS_"
-                                             : m_upscaleMode == config::ScalingType::FSR ? "_FSR_"
-                                                                                         : "_SCL_";
+                    const auto upscaleName = m_upscaleMode == config::ScalingType::NIS              ? "_NIS_"
+                                             : m_upscaleMode == config::ScalingType::FSR            ? "_FSR_"
+                                             : m_upscaleMode == config::ScalingType::CenterWeighted ? "_CWU_"
+                                                                                                    : "_SCL_";
                     parameters << upscaleName << m_configManager->getValue(config::SettingScaling) << "_"
                                << m_configManager->getValue(config::SettingSharpness);
                 }
@@ -2147,6 +3294,25 @@ namespace {
 
         std::string m_applicationName;
         bool m_isOpenComposite{false};
+        bool m_requestedDirect3D{false};
+        bool m_requestedQuadViews{false};
+        bool m_requestedFoveatedRendering{false};
+        bool m_emulateQuadViews{false};
+        bool m_requestedFoveationFB{false};
+        bool m_requestedFoveationEyeTracked{false};
+        bool m_requestedEyeGazeInteraction{false};
+        bool m_emulateEyeGazeInteraction{false};
+        std::set<XrAction> m_eyeGazeActions;
+        std::map<XrSpace, XrPosef> m_eyeGazeSpaces;
+        XrPath m_eyeGazeInteractionProfile{XR_NULL_PATH};
+        bool m_emulateFoveationFB{false};
+        std::mutex m_foveationLock;
+        std::map<XrFoveationProfileFB, FoveationProfile> m_foveationProfiles;
+        std::map<XrSwapchain, std::pair<XrFoveationProfileFB, FoveationProfile>> m_swapchainsFoveation;
+        uint64_t m_nextFoveationProfile{0};
+        std::optional<FoveationProfile> m_appFoveation;
+        bool m_hasAppFoveationChanged{false};
+        std::string m_applicationVersion;
         std::string m_runtimeName;
         std::string m_systemName;
         XrSystemId m_vrSystemId{XR_NULL_SYSTEM_ID};
@@ -2163,6 +3329,10 @@ namespace {
 
         XrTime m_waitedFrameTime;
         XrTime m_begunFrameTime;
+        XrTime m_waitedFramePredictedTime{0};
+        XrTime m_begunFramePredictedTime{0};
+        std::mutex m_poseSamplesLock;
+        std::map<XrTime, XrTime> m_poseSampleTimes;
         bool m_isInFrame{false};
         bool m_sendInterationProfileEvent{false};
         uint32_t m_visibilityMaskEventIndex{utilities::ViewCount};
@@ -2182,15 +3352,27 @@ namespace {
         std::shared_ptr<input::IEyeTracker> m_eyeTracker;
         std::shared_ptr<input::IHandTracker> m_handTracker;
         std::shared_ptr<graphics::IVariableRateShader> m_variableRateShader;
+        std::shared_ptr<graphics::IQuadViewsCompositor> m_quadViewsCompositor;
+        std::vector<std::array<XrSwapchain, utilities::ViewCount>> m_quadViewsSwapchains;
         std::array<std::shared_ptr<graphics::IImageProcessor>, ImgProc::MaxValue> m_imageProcessors;
+        std::shared_ptr<graphics::ICenterWeightedUpscaler> m_centerWeightedUpscaler;
+        std::shared_ptr<graphics::IImageProcessor> m_passThroughScaler;
 
         std::vector<int> m_keyModifiers;
         int m_keyScreenshot;
+        int m_keyProfile;
         XrSwapchain m_menuSwapchain{XR_NULL_HANDLE};
         std::vector<std::shared_ptr<graphics::ITexture>> m_menuSwapchainImages;
         std::shared_ptr<menu::IMenuHandler> m_menuHandler;
+        std::shared_ptr<utilities::ISystemMonitor> m_systemMonitor;
+        std::shared_ptr<config::IProfileComparator> m_profileComparator;
+        std::shared_ptr<utilities::IPerformanceHistory> m_performanceHistory;
+        PerformanceSettings m_performanceSettings{};
+        bool m_isComparingProfiles{false};
+        std::shared_ptr<utilities::ICircuitBreaker> m_circuitBreaker;
         int m_menuLingering{0};
         bool m_requestScreenShotKeyState{false};
+        bool m_profileKeyState{false};
 
         uint8_t m_gpuTimerApp{0};
         uint8_t m_gpuTimerOvr{0};
@@ -2205,7 +3387,10 @@ namespace {
             utilities::CpuTimer overlayCpuTimer;
             utilities::CpuTimer handTrackingTimer;
             uint32_t numFrames{0};
+            uint32_t numLatencyFrames{0};
             uint32_t gpuTimersId{0};
+            uint64_t lastGpuTimeUs{0};
+            std::chrono::steady_clock::time_point lastFrameTime;
 
             uint64_t startGpuTimer(uint8_t& id) {
                 static_assert(isPow2(ARRAYSIZE(gpuTimers)));
@@ -2227,11 +3412,53 @@ namespace {
         } m_performanceCounters;
 
         menu::MenuStatistics m_stats{};
+        std::atomic<uint32_t> m_numRenderTargetsWithVRS{0};
+        std::atomic<bool> m_hasColorBuffer[utilities::ViewCount + 1]{};
         bool m_hasPerformanceCounterKHR{false};
     };
 
     std::unique_ptr<OpenXrLayer> g_instance = nullptr;
 
+#define EMULATED_ENTRY_POINT(name, params, args)                                                                       \
+    XrResult XRAPI_CALL name params {                                                                                  \
+        TraceLocalActivity(local);                                                                                     \
+        TraceLoggingWriteStart(local, #name);                                                                          \
+                                                                                                                       \
+        XrResult result;                                                                                               \
+        try {                                                                                                          \
+            result = g_instance->name args;                                                                            \
+        } catch (std::exception& exc) {                                                                                \
+            TraceLoggingWriteTagged(local, #name "_Error", TLArg(exc.what(), "Error"));                                \
+            Log(#name ": %s\n", exc.what());                                                                           \
+            result = XR_ERROR_RUNTIME_FAILURE;                                                                         \
+        }                                                                                                              \
+                                                                                                                       \
+        TraceLoggingWriteStop(local, #name, TLArg((int)result, "Result"));                                             \
+        return result;                                                                                                 \
+    }
+
+    namespace emulated {
+        EMULATED_ENTRY_POINT(xrCreateFoveationProfileFB,
+                             (XrSession session,
+                              const XrFoveationProfileCreateInfoFB* createInfo,
+                              XrFoveationProfileFB* profile),
+                             (session, createInfo, profile))
+        EMULATED_ENTRY_POINT(xrDestroyFoveationProfileFB, (XrFoveationProfileFB profile), (profile))
+        EMULATED_ENTRY_POINT(xrUpdateSwapchainFB,
+                             (XrSwapchain swapchain, const XrSwapchainStateBaseHeaderFB* state),
+                             (swapchain, state))
+        EMULATED_ENTRY_POINT(xrGetSwapchainStateFB,
+                             (XrSwapchain swapchain, XrSwapchainStateBaseHeaderFB* state),
+                             (swapchain, state))
+#ifdef XR_META_foveation_eye_tracked
+        EMULATED_ENTRY_POINT(xrGetFoveationEyeTrackedStateMETA,
+                             (XrSession session, XrFoveationEyeTrackedStateMETA* foveationState),
+                             (session, foveationState))
+#endif
+    } // namespace emulated
+
+#undef EMULATED_ENTRY_POINT
+
 } // namespace
 
 namespace toolkit {
@@ -97,7 +97,112 @@ namespace {
     enum class MenuIndent { NoIndent = 0, OptionIndent = 0, SubGroupIndent = 20 };
 
     enum class MenuState { Splash, NotVisible, Visible };
-    enum class MenuEntryType { Tabs, Slider, Choice, Separator, RestoreDefaults, ReloadShaders, ExitButton };
+    enum class MenuEntryType {
+        Tabs,
+        Slider,
+        Choice,
+        Separator,
+        RestoreDefaults,
+        SaveProfile,
+        ReloadShaders,
+        ExitButton
+    };
+
+    // The features whose cost is displayed next to their menu entries.
+    enum class CostFeature { None = 0, Upscaling, PostProcess, VariableRateShading, Hands, MaxValue };
+
+    // Attributes the frame time to the features of the menu, over a sliding window of the statistics (updated every
+    // second). The time spent by the layer itself is measured directly, while the effect of a setting on the whole
+    // frame (eg: render resolution or VRS savings) is the difference of the GPU frame time across its last change.
+    class FeatureCostTracker {
+      public:
+        // The number of statistics updates to average.
+        static constexpr size_t WindowSize = 3;
+
+        void update(const MenuStatistics& stats) {
+            push(m_direct[to_integral(CostFeature::Upscaling)], static_cast<float>(stats.processorGpuTimeUs[1]));
+            push(m_direct[to_integral(CostFeature::PostProcess)], static_cast<float>(stats.processorGpuTimeUs[2]));
+            push(m_direct[to_integral(CostFeature::Hands)], static_cast<float>(stats.handTrackingCpuTimeUs));
+
+            // The app GPU time is not available when CPU-bound (D3D12).
+            if (!stats.appGpuTimeUs) {
+                return;
+            }
+            const auto frameGpuTimeUs = static_cast<float>(stats.appGpuTimeUs + stats.processorGpuTimeUs[0] +
+                                                           stats.processorGpuTimeUs[1] + stats.processorGpuTimeUs[2] +
+                                                           stats.overlayGpuTimeUs);
+
+            for (auto& delta : m_deltas) {
+                // Skip the update that straddles the change.
+                if (delta.skipSamples) {
+                    delta.skipSamples--;
+                    continue;
+                }
+                if (delta.baselineUs && delta.samples.size() < WindowSize) {
+                    delta.samples.push_back(frameGpuTimeUs);
+                }
+            }
+            push(m_frameGpuTimeUs, frameGpuTimeUs);
+        }
+
+        void onChanged(CostFeature feature) {
+            auto& delta = m_deltas[to_integral(feature)];
+
+            // A change during an ongoing measurement keeps the original baseline.
+            if (!delta.baselineUs || delta.samples.size() == WindowSize) {
+                delta.baselineUs = average(m_frameGpuTimeUs);
+            }
+            delta.samples.clear();
+            delta.skipSamples = 1;
+        }
+
+        std::string format(CostFeature feature, bool includeDelta) const {
+            std::string label;
+            const auto& direct = m_direct[to_integral(feature)];
+            if (!direct.empty()) {
+                const auto cost = average(direct);
+                if (cost && *cost > 0.f) {
+                    label = fmt::format("{:.2f}ms {}", *cost / 1000.f, feature == CostFeature::Hands ? "CPU" : "GPU");
+                }
+            }
+
+            const auto& delta = m_deltas[to_integral(feature)];
+            if (includeDelta && delta.baselineUs) {
+                if (!label.empty()) {
+                    label += " ";
+                }
+                label += delta.samples.size() == WindowSize
+                             ? fmt::format("({:+.2f}ms)", (*average(delta.samples) - *delta.baselineUs) / 1000.f)
+                             : "(measuring)";
+            }
+            return label;
+        }
+
+      private:
+        static void push(std::deque<float>& window, float value) {
+            window.push_back(value);
+            if (window.size() > WindowSize) {
+                window.pop_front();
+            }
+        }
+
+        static std::optional<float> average(const std::deque<float>& window) {
+            if (window.empty()) {
+                return {};
+            }
+            return std::accumulate(window.cbegin(), window.cend(), 0.f) / window.size();
+        }
+
+        struct Delta {
+            std::optional<float> baselineUs;
+            std::deque<float> samples;
+            uint32_t skipSamples{0};
+        };
+
+        std::deque<float> m_frameGpuTimeUs;
+        std::deque<float> m_direct[to_integral(CostFeature::MaxValue)];
+        Delta m_deltas[to_integral(CostFeature::MaxValue)];
+    };
 
     class MenuHandler;
 
@@ -151,6 +256,12 @@ namespace {
         bool expert{false};
         bool visible{false};
         bool disable{false};
+
+        // Display the measured cost of the feature next to the value.
+        CostFeature cost{CostFeature::None};
+
+        // The setting only takes effect after a restart: show the direct cost of the feature but no frame time delta.
+        bool costIsDirectOnly{false};
     };
 
     enum class MenuTab { Performance = 0, Appearance, Inputs, System, Menu, Developer };
@@ -285,6 +396,16 @@ namespace {
                     }
                     break;
 
+                case MenuEntryType::SaveProfile:
+                    if (m_resetArmed && moveRight) {
+                        m_resetArmed = false;
+                        // The configName holds the name of the profile.
+                        m_configManager->saveProfile(menuEntry.configName);
+                    } else {
+                        m_resetArmed = moveRight;
+                    }
+                    break;
+
                 case MenuEntryType::ReloadShaders:
                     if (m_resetArmed && moveRight) {
                         m_resetArmed = false;
@@ -306,6 +427,10 @@ namespace {
                                   previousValue +
                                       (moveLeft ? -1 : 1) * (!m_isAccelerating ? 1 : menuEntry.acceleration),
                                   isTabs /* wraparound */);
+                    if (menuEntry.cost != CostFeature::None && !menuEntry.costIsDirectOnly &&
+                        previousValue != peekEntryValue(menuEntry)) {
+                        m_featureCosts.onChanged(menuEntry.cost);
+                    }
 
                     // When changing anamorphic setting, toggle the config value sign.
                     if (menuEntry.pValue == &m_useAnamorphic) {
@@ -560,8 +685,10 @@ namespace {
                 // Display each menu entry.
                 for (unsigned int i = 0; i < m_menuEntries.size(); i++) {
                     const auto& menuEntry = m_menuEntries[i];
-                    const auto& title = m_resetArmed && (menuEntry.type == MenuEntryType::RestoreDefaults ||
-                                                         menuEntry.type == MenuEntryType::ReloadShaders)
+                    const auto& title = m_resetArmed && i == m_selectedItem &&
+                                                (menuEntry.type == MenuEntryType::RestoreDefaults ||
+                                                 menuEntry.type == MenuEntryType::SaveProfile ||
+                                                 menuEntry.type == MenuEntryType::ReloadShaders)
                                             ? "Confirm?"
                                             : menuEntry.title;
 
@@ -649,6 +776,7 @@ namespace {
                         break;
 
                     case MenuEntryType::RestoreDefaults:
+                    case MenuEntryType::SaveProfile:
                     case MenuEntryType::ReloadShaders:
                         break;
 
@@ -666,6 +794,14 @@ namespace {
                         break;
                     }
 
+                    if (menuEntry.cost != CostFeature::None) {
+                        const auto label = m_featureCosts.format(menuEntry.cost, !menuEntry.costIsDirectOnly);
+                        if (!label.empty()) {
+                            left += m_device->drawString(
+                                label, TextStyle::Normal, fontSize, left, top, textColorHint, measureBackgroundWidth);
+                        }
+                    }
+
                     top += 1.5f * fontSize;
 
                     if (measureBackgroundWidth) {
@@ -852,6 +988,98 @@ namespace {
                     }
                     top += 1.05f * fontSize;
 
+                    if (m_stats.performanceRegression.detected) {
+                        const auto& regression = m_stats.performanceRegression;
+                        std::string updates;
+                        if (regression.isApplicationUpdated) {
+                            updates += " game";
+                        }
+                        if (regression.isRuntimeUpdated) {
+                            updates += " runtime";
+                        }
+                        if (regression.isDriverUpdated) {
+                            updates += " driver";
+                        }
+                        m_device->drawString(fmt::format("Slower since{} update (+{:.0f}%)",
+                                                         updates,
+                                                         std::max({regression.frameTimePercent,
+                                                                   regression.appCpuTimePercent,
+                                                                   regression.appGpuTimePercent})),
+                                             TextStyle::Normal,
+                                             fontSize,
+                                             overlayAlign - 300,
+                                             top,
+                                             textColorRedNoFade,
+                                             true,
+                                             FW1_LEFT);
+                        top += 1.05f * fontSize;
+                    }
+
+                    // Features degraded by the circuit breaker.
+                    if (m_stats.trippedFeatures) {
+                        static constexpr const char* FeatureNames[] = {
+                            "Upscaling", "Post-processing", "Foveated rendering", "Hand tracking"};
+                        for (uint32_t i = 0; i < std::size(FeatureNames); i++) {
+                            if (!(m_stats.trippedFeatures & (1u << i))) {
+                                continue;
+                            }
+                            m_device->drawString(
+                                fmt::format("{} {}",
+                                            FeatureNames[i],
+                                            i == to_integral(utilities::GuardedFeature::Upscaling)
+                                                ? "is misbehaving, restart with it off"
+                                                : "was disabled (misbehaving)"),
+                                TextStyle::Normal,
+                                fontSize,
+                                overlayAlign - 300,
+                                top,
+                                textColorRedNoFade,
+                                true,
+                                FW1_LEFT);
+                            top += 1.05f * fontSize;
+                        }
+                    }
+
+                    // A/B comparison.
+                    if (m_stats.profileComparison.active) {
+                        const auto& comparison = m_stats.profileComparison;
+                        m_device->drawString(fmt::format("A/B: profile {} ({} pairs)",
+                                                         comparison.isProfileB ? ProfileB : ProfileA,
+                                                         comparison.numPairs),
+                                             OVERLAY_COMMON);
+                        top += 1.05f * fontSize;
+                        for (size_t i = 0; i < std::size(comparison.profiles); i++) {
+                            const auto& profile = comparison.profiles[i];
+                            m_device->drawString(fmt::format("{}: {:.2f}ms (p50 {:.2f}ms, p95 {:.2f}ms)",
+                                                             i ? ProfileB : ProfileA,
+                                                             profile.meanUs / 1000.f,
+                                                             profile.medianUs / 1000.f,
+                                                             profile.p95Us / 1000.f),
+                                                 OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                        }
+                        if (comparison.numPairs >= 2) {
+                            m_device->drawString(fmt::format("B-A: {:+.2f}ms (t={:.1f}, {})",
+                                                             comparison.meanDifferenceUs / 1000.f,
+                                                             comparison.tStatistic,
+                                                             comparison.isSignificant ? "significant"
+                                                                                      : "not significant"),
+                                                 OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                        }
+                        if (comparison.hasRestartBoundSettings) {
+                            m_device->drawString("Some settings need a restart and are not compared",
+                                                 TextStyle::Normal,
+                                                 fontSize,
+                                                 overlayAlign - 300,
+                                                 top,
+                                                 textColorRedNoFade,
+                                                 true,
+                                                 FW1_LEFT);
+                            top += 1.05f * fontSize;
+                        }
+                    }
+
                     // Advanced display.
                     if (overlayType == OverlayType::Advanced || overlayType == OverlayType::Developer) {
 #define TIMING_STAT(label, name)                                                                                       \
@@ -862,6 +1090,46 @@ namespace {
                         TIMING_STAT("app GPU", appGpuTimeUs);
                         top += 1.05f * fontSize;
 
+                        // Pose latency, only known when the runtime lets us read the current time.
+                        if (m_stats.motionToPhotonUs) {
+                            m_device->drawString(fmt::format("MTP: {:.1f}ms", m_stats.motionToPhotonUs / 1000.f),
+                                                 OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                            m_device->drawString(fmt::format("pose age: {:.1f}ms", m_stats.poseAgeUs / 1000.f),
+                                                 OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                            if (m_stats.dampenedPredictionUs) {
+                                m_device->drawString(
+                                    fmt::format("dampened: -{:.1f}ms", m_stats.dampenedPredictionUs / 1000.f),
+                                    OVERLAY_COMMON);
+                                top += 1.05f * fontSize;
+                            }
+                            top += 1.05f * fontSize;
+                        }
+
+                        // System-wide usage, to tell which resource is the actual bottleneck.
+                        const auto& usage = m_stats.systemUsage;
+                        if (usage.numCpuCores) {
+                            const auto cpuLoad = std::accumulate(usage.cpuCoreLoadPercent,
+                                                                 usage.cpuCoreLoadPercent + usage.numCpuCores,
+                                                                 0.f) /
+                                                 usage.numCpuCores;
+                            const auto cpuPeakLoad = *std::max_element(usage.cpuCoreLoadPercent,
+                                                                       usage.cpuCoreLoadPercent + usage.numCpuCores);
+
+                            m_device->drawString(fmt::format("GPU busy: {:.0f}%", usage.gpuBusyPercent),
+                                                 OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                            m_device->drawString(
+                                fmt::format("VRAM: {:.2f}GB", usage.processVideoMemoryBytes / (1024.f * 1024 * 1024)),
+                                OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                            m_device->drawString(
+                                fmt::format("CPU: {:.0f}% (core max {:.0f}%)", cpuLoad, cpuPeakLoad), OVERLAY_COMMON);
+                            top += 1.05f * fontSize;
+                            top += 1.05f * fontSize;
+                        }
+
                         if (overlayType == OverlayType::Developer) {
                             TIMING_STAT("lay CPU", endFrameCpuTimeUs);
                             TIMING_STAT("pre GPU", processorGpuTimeUs[0]);
@@ -960,6 +1228,13 @@ namespace {
                                                                  m_eyeGazeState.gazeNdc[1].y),
                                                      OVERLAY_COMMON);
                                 top += 1.05f * fontSize;
+
+                                static const char* const movements[] = {"fixation", "saccade", "blink"};
+                                m_device->drawString(fmt::format("eye: {} {:.0f}deg/s",
+                                                                 movements[to_integral(m_eyeGazeState.movement)],
+                                                                 m_eyeGazeState.angularVelocity),
+                                                     OVERLAY_COMMON);
+                                top += 1.05f * fontSize;
                             }
                         }
                     }
@@ -970,6 +1245,7 @@ namespace {
 
         void updateStatistics(const MenuStatistics& stats) override {
             m_stats = stats;
+            m_featureCosts.update(stats);
         }
 
         void updateGesturesState(const GesturesState& state) override {
@@ -1014,6 +1290,8 @@ namespace {
                                      0,
                                      MenuEntry::LastVal<ScalingType>(),
                                      MenuEntry::FmtEnum<ScalingType>});
+            m_menuEntries.back().cost = CostFeature::Upscaling;
+            m_menuEntries.back().costIsDirectOnly = true;
             m_menuEntries.back().noCommitDelay = true;
 
             // Scaling sub-group.
@@ -1038,6 +1316,8 @@ namespace {
                                         GetScaledInputSize(getDisplayWidth(), value, 2),
                                         GetScaledInputSize(getDisplayHeight(), value, 2));
                  }});
+            m_menuEntries.back().cost = CostFeature::Upscaling;
+            m_menuEntries.back().costIsDirectOnly = true;
             m_menuEntries.back().noCommitDelay = true;
             proportionalGroup.finalize();
 
@@ -1048,6 +1328,8 @@ namespace {
                 {MenuIndent::SubGroupIndent, "Width", MenuEntryType::Slider, SettingScaling, 25, 400, [&](int value) {
                      return fmt::format("{}% ({} pixels)", value, GetScaledInputSize(getDisplayWidth(), value, 2));
                  }});
+            m_menuEntries.back().cost = CostFeature::Upscaling;
+            m_menuEntries.back().costIsDirectOnly = true;
             m_menuEntries.back().noCommitDelay = true;
 
             m_menuEntries.push_back(
@@ -1060,6 +1342,8 @@ namespace {
                  [&](int value) {
                      return fmt::format("{}% ({} pixels)", value, GetScaledInputSize(getDisplayHeight(), value, 2));
                  }});
+            m_menuEntries.back().cost = CostFeature::Upscaling;
+            m_menuEntries.back().costIsDirectOnly = true;
             m_menuEntries.back().noCommitDelay = true;
             anamorphicGroup.finalize();
 
@@ -1070,6 +1354,17 @@ namespace {
                                      0,
                                      100,
                                      MenuEntry::FmtPercent});
+            m_menuEntries.back().cost = CostFeature::Upscaling;
+
+            MenuGroup centerWeightedGroup(this, [&] { return getCurrentScalingType() == ScalingType::CenterWeighted; });
+            m_menuEntries.push_back({MenuIndent::SubGroupIndent,
+                                     "Center radius",
+                                     MenuEntryType::Slider,
+                                     SettingCenterWeightedRadius,
+                                     10,
+                                     150,
+                                     MenuEntry::FmtPercent});
+            centerWeightedGroup.finalize();
             // TODO: Mip-map biasing is only support on D3D11.
             if (m_device->getApi() == Api::D3D11) {
                 m_menuEntries.push_back({MenuIndent::SubGroupIndent,
@@ -1092,6 +1387,7 @@ namespace {
                                          0,
                                          MenuEntry::LastVal<VariableShadingRateType>(),
                                          MenuEntry::FmtEnum<VariableShadingRateType>});
+                m_menuEntries.back().cost = CostFeature::VariableRateShading;
 
                 // Common sub-group.
                 MenuGroup variableRateShaderCommonGroup(this, [&] {
@@ -1127,6 +1423,14 @@ namespace {
                                                  [](int value) { return fmt::format("{:.2f}m", value / 100.f); }});
                         m_menuEntries.back().acceleration = 5;
                     }
+                    m_menuEntries.push_back({MenuIndent::SubGroupIndent,
+                                             "Hold during saccades",
+                                             MenuEntryType::Choice,
+                                             SettingEyeSaccadeHold,
+                                             0,
+                                             MenuEntry::LastVal<OffOnType>(),
+                                             MenuEntry::FmtEnum<OffOnType>});
+                    m_menuEntries.back().expert = true;
                     variableRateShaderEyeTrackingSettingsGroup.finalize();
                 } // m_isEyeTrackingSupported
 
@@ -1137,6 +1441,14 @@ namespace {
                                          0,
                                          MenuEntry::LastVal<NoYesType>(),
                                          MenuEntry::FmtEnum<NoYesType>});
+                m_menuEntries.push_back({MenuIndent::SubGroupIndent,
+                                         "Full rate w/o depth",
+                                         MenuEntryType::Choice,
+                                         SettingVRSFullRateWithoutDepth,
+                                         0,
+                                         MenuEntry::LastVal<NoYesType>(),
+                                         MenuEntry::FmtEnum<NoYesType>});
+                m_menuEntries.back().expert = true;
                 // TODO: place holders
                 // m_menuEntries.push_back({MenuIndent::SubGroupIndent,
                 //                         "Anti Shimmer",
@@ -1166,6 +1478,7 @@ namespace {
                                          0,
                                          MenuEntry::LastVal<VariableShadingRateQuality>(),
                                          MenuEntry::FmtEnum<VariableShadingRateQuality>});
+                m_menuEntries.back().cost = CostFeature::VariableRateShading;
                 m_menuEntries.push_back({MenuIndent::SubGroupIndent,
                                          "Pattern",
                                          MenuEntryType::Slider,
@@ -1299,6 +1612,7 @@ namespace {
                                      0,
                                      MenuEntry::LastVal<PostProcessType>(),
                                      MenuEntry::FmtEnum<PostProcessType>});
+            m_menuEntries.back().cost = CostFeature::PostProcess;
             MenuGroup postProcessGroup(this, [&] {
                 return m_configManager->peekEnumValue<PostProcessType>(SettingPostProcess) != PostProcessType::Off;
             });
@@ -1417,6 +1731,7 @@ namespace {
                                          0,
                                          MenuEntry::LastVal<HandTrackingVisibility>(),
                                          MenuEntry::FmtEnum<HandTrackingVisibility>});
+                m_menuEntries.back().cost = CostFeature::Hands;
                 m_menuEntries.push_back({MenuIndent::SubGroupIndent,
                                          "Controller timeout",
                                          MenuEntryType::Slider,
@@ -1679,6 +1994,32 @@ namespace {
                                      MenuEntry::LastVal<NoYesType>(),
                                      MenuEntry::FmtEnum<NoYesType>});
 
+            // The A/B profiles are switched with the hotkey.
+            m_menuEntries.push_back({MenuIndent::OptionIndent,
+                                     "Save as profile A",
+                                     MenuEntryType::SaveProfile,
+                                     ProfileA,
+                                     0,
+                                     0,
+                                     MenuEntry::FmtNone});
+            m_menuEntries.back().expert = true;
+            m_menuEntries.push_back({MenuIndent::OptionIndent,
+                                     "Save as profile B",
+                                     MenuEntryType::SaveProfile,
+                                     ProfileB,
+                                     0,
+                                     0,
+                                     MenuEntry::FmtNone});
+            m_menuEntries.back().expert = true;
+            m_menuEntries.push_back({MenuIndent::OptionIndent,
+                                     "A/B switch cadence",
+                                     MenuEntryType::Slider,
+                                     SettingProfileCadence,
+                                     1,
+                                     30,
+                                     [](int value) { return fmt::format("{}s", value); }});
+            m_menuEntries.back().expert = true;
+
             m_menuEntries.push_back(
                 {MenuIndent::OptionIndent, "Restore defaults", MenuEntryType::RestoreDefaults, BUTTON_OR_SEPARATOR});
 
@@ -1716,6 +2057,14 @@ namespace {
                                      MenuEntry::LastVal<OffOnType>(),
                                      MenuEntry::FmtEnum<OffOnType>});
 
+            m_menuEntries.push_back({MenuIndent::OptionIndent,
+                                     "Tune upscaler shaders",
+                                     MenuEntryType::Choice,
+                                     SettingShaderTuning,
+                                     0,
+                                     MenuEntry::LastVal<OffOnType>(),
+                                     MenuEntry::FmtEnum<OffOnType>});
+
             m_menuEntries.push_back(
                 {MenuIndent::OptionIndent, "Reload Shaders", MenuEntryType::ReloadShaders, BUTTON_OR_SEPARATOR});
 
@@ -1824,6 +2173,7 @@ namespace {
         const bool m_supportFOVHack;
         bool m_hagsWarning;
         MenuStatistics m_stats{};
+        FeatureCostTracker m_featureCosts;
         GesturesState m_gesturesState{};
         EyeGazeState m_eyeGazeState{};
 
@@ -66,15 +66,32 @@ namespace {
 
         void update() override {
             if (m_configManager->hasChanged(SettingSharpness)) {
-                updateScaler(m_configManager->getValue(SettingSharpness) / 100.f);
+                m_sharpness = m_configManager->getValue(SettingSharpness) / 100.f;
+                std::fill_n(m_configUpdated, std::size(m_configUpdated), true);
             }
         }
 
-        void process(std::shared_ptr<ITexture> input, std::shared_ptr<ITexture> output, int32_t slice = -1) override {
-            m_device->setShader(!input->isArray() ? m_shader : m_shaderVPRT, SamplerType::LinearClamp);
-            m_device->setShaderInput(0, m_configBuffer);
-            m_device->setShaderInput(0, input, slice);
-            m_device->setShaderOutput(0, output, slice);
+        void process(const std::shared_ptr<ITexture>& input,
+                     const std::shared_ptr<ITexture>& output,
+                     const ProcessingRegion& region) override {
+            const auto eye = std::min(to_integral(region.eye), ViewCount - 1);
+            updateViewport(eye, *input, *output, region);
+
+            const auto variant = m_tuner ? m_tuner->beginDispatch() : m_selectedVariant;
+            const auto& shaders = m_shaders[variant];
+            const auto& shader = !input->isArray() ? shaders.shader : shaders.shaderVPRT;
+
+            // Only dispatch the blocks covering the pixels to produce.
+            const auto& shape = m_variants[variant];
+            shader->updateThreadGroups(
+                {(static_cast<uint32_t>(region.outputRect.extent.width) + shape.blockWidth - 1) / shape.blockWidth,
+                 (static_cast<uint32_t>(region.outputRect.extent.height) + shape.blockHeight - 1) / shape.blockHeight,
+                 1});
+
+            m_device->setShader(shader, SamplerType::LinearClamp);
+            m_device->setShaderInput(0, m_configBuffers[eye]);
+            m_device->setShaderInput(0, input, region.slice);
+            m_device->setShaderOutput(0, output, region.slice);
 
             if (!m_isSharpenOnly) {
                 m_device->setShaderInput(1, m_coefScale);
@@ -82,13 +99,45 @@ namespace {
             }
 
             m_device->dispatchShader();
+
+            if (m_tuner) {
+                m_tuner->endDispatch();
+                if (!m_tuner->isTuning()) {
+                    // Release the variants we will not use anymore, once the GPU is done with the tuning dispatches.
+                    m_selectedVariant = m_tuner->getSelectedVariant();
+                    for (size_t i = 0; i < m_shaders.size(); i++) {
+                        if (i != m_selectedVariant) {
+                            m_device->deferRelease(std::make_shared<Shaders>(std::move(m_shaders[i])));
+                            m_shaders[i] = {};
+                        }
+                    }
+                    m_tuner.reset();
+                }
+            }
         }
 
       private:
-        void initializeScaler() {
-            const auto shadersDir = dllHome / "shaders";
-            const auto shaderFile = shadersDir / "NIS.hlsl";
+        // The tile shapes supported by the NIS shaders, that we may pick from when tuning.
+        struct TileShape {
+            uint32_t blockWidth;
+            uint32_t blockHeight;
+            uint32_t threadGroupSize;
+        };
+
+        struct Shaders {
+            std::shared_ptr<IComputeShader> shader;
+            std::shared_ptr<IComputeShader> shaderVPRT;
+        };
+
+        // The rectangles to process for a view and the dimensions of the textures they belong to.
+        struct Viewport {
+            XrRect2Di input;
+            XrRect2Di output;
+            XrExtent2Di inputSize;
+            XrExtent2Di outputSize;
+        };
 
+        void initializeScaler() {
             // Identify the GPU architecture in order to infer the best settings for the shader.
             const auto gpuArchitecture = m_device->GetGpuArchitecture();
             const auto nisArchitecture = gpuArchitecture == GpuArchitecture::AMD ? NISGPUArchitecture::AMD_Generic
@@ -97,44 +146,79 @@ namespace {
                                              : NISGPUArchitecture::NVIDIA_Generic;
             NISOptimizer opt(true, nisArchitecture);
 
+            // The architecture's recommended shape comes first and is the default.
+            m_variants = {{opt.GetOptimalBlockWidth(), opt.GetOptimalBlockHeight(), opt.GetOptimalThreadGroupSize()}};
+            for (const auto& shape : std::initializer_list<TileShape>{
+                     {32, 24, 128}, {32, 24, 256}, {32, 32, 128}, {32, 32, 256}}) {
+                if (std::none_of(m_variants.cbegin(), m_variants.cend(), [&](const TileShape& v) {
+                        return v.blockWidth == shape.blockWidth && v.blockHeight == shape.blockHeight &&
+                               v.threadGroupSize == shape.threadGroupSize;
+                    })) {
+                    m_variants.push_back(shape);
+                }
+            }
+            m_selectedVariant = 0;
+
+            // When requested, time the tile shapes on this GPU the first time (or reuse the previous results).
+            if (!m_tuner && m_configManager->getValue(SettingShaderTuning)) {
+                m_tuner = CreateShaderTuner(
+                    m_device, m_isSharpenOnly ? "nis_sharpen" : "nis_scaler", m_variants.size(), 0);
+            }
+            if (m_tuner && !m_tuner->isTuning()) {
+                m_selectedVariant = m_tuner->getSelectedVariant();
+                m_tuner.reset();
+            }
+
+            m_shaders.clear();
+            m_shaders.resize(m_variants.size());
+            for (size_t i = 0; i < m_variants.size(); i++) {
+                if (m_tuner || i == m_selectedVariant) {
+                    m_shaders[i] = createShaders(m_variants[i]);
+                }
+            }
+
+            if (!m_isSharpenOnly) {
+                // create coefficient inputs for NISScaler only
+                initializeCoefficients();
+            }
+
+            // TODO: Consider making immutable and create a new buffer in update(). For now, our D3D12 implementation
+            // does not do heap descriptor recycling.
+            for (auto& it : m_configBuffers) {
+                it = m_device->createBuffer(sizeof(NISConfig), "NIS Configuration CB");
+            }
+            m_sharpness = m_configManager->getValue(SettingSharpness) / 100.f;
+            std::fill_n(m_configUpdated, std::size(m_configUpdated), true);
+        }
+
+        Shaders createShaders(const TileShape& shape) const {
+            const auto shadersDir = dllHome / "shaders";
+            const auto shaderFile = shadersDir / "NIS.hlsl";
+
             const std::array<unsigned int, 3> threadGroups = {
-                (unsigned int)std::ceil(m_outputWidth / float(opt.GetOptimalBlockWidth())),
-                (unsigned int)std::ceil(m_outputHeight / float(opt.GetOptimalBlockHeight())),
+                (unsigned int)std::ceil(m_outputWidth / float(shape.blockWidth)),
+                (unsigned int)std::ceil(m_outputHeight / float(shape.blockHeight)),
                 1};
 
             // NISScaler/NISSharpen common
             utilities::shader::Defines defines;
             defines.add("NIS_SCALER", !m_isSharpenOnly);
             defines.add("NIS_HDR_MODE", (uint32_t)NISHDRMode::None);
-            defines.add("NIS_BLOCK_WIDTH", opt.GetOptimalBlockWidth());
-            defines.add("NIS_BLOCK_HEIGHT", opt.GetOptimalBlockHeight());
-            defines.add("NIS_THREAD_GROUP_SIZE", opt.GetOptimalThreadGroupSize());
-
-            if (!m_isSharpenOnly) {
-                m_shader = m_device->createComputeShader(
-                    shaderFile, "main", "NISScaler CS", threadGroups, defines.get() /*,  shadersDir*/);
+            defines.add("NIS_BLOCK_WIDTH", shape.blockWidth);
+            defines.add("NIS_BLOCK_HEIGHT", shape.blockHeight);
+            defines.add("NIS_THREAD_GROUP_SIZE", shape.threadGroupSize);
 
-                defines.add("VPRT", true);
-                m_shaderVPRT = m_device->createComputeShader(
-                    shaderFile, "main", "NISScaler VPRT CS", threadGroups, defines.get() /*,  shadersDir*/);
+            const std::string name = !m_isSharpenOnly ? "NISScaler" : "NISSharpen";
 
-                // create coefficient inputs for NISScaler only
-                initializeCoefficients();
-
-            } else {
-                m_shader = m_device->createComputeShader(
-                    shaderFile, "main", "NISSharpen CS", threadGroups, defines.get() /*,  shadersDir*/);
+            Shaders shaders;
+            shaders.shader = m_device->createComputeShader(
+                shaderFile, "main", name + " CS", threadGroups, defines.get() /*,  shadersDir*/);
 
-                defines.add("VPRT", true);
-                m_shaderVPRT =
-                    m_device->createComputeShader(shaderFile, "main", "NISSharpen VPRT CS", threadGroups, defines.get()
-                                                  /*,  shadersDir*/);
-            }
+            defines.add("VPRT", true);
+            shaders.shaderVPRT = m_device->createComputeShader(
+                shaderFile, "main", name + " VPRT CS", threadGroups, defines.get() /*,  shadersDir*/);
 
-            // TODO: Consider making immutable and create a new buffer in update(). For now, our D3D12 implementation
-            // does not do heap descriptor recycling.
-            m_configBuffer = m_device->createBuffer(sizeof(NISConfig), "NIS Configuration CB");
-            updateScaler(m_configManager->getValue(SettingSharpness) / 100.f);
+            return shaders;
         }
 
         void initializeCoefficients() {
@@ -165,39 +249,55 @@ namespace {
             }
         }
 
-        void updateScaler(float sharpness) {
+        void updateViewport(size_t eye, const ITexture& input, const ITexture& output, const ProcessingRegion& region) {
+            const Viewport viewport{
+                region.inputRect,
+                region.outputRect,
+                {static_cast<int32_t>(input.getInfo().width), static_cast<int32_t>(input.getInfo().height)},
+                {static_cast<int32_t>(output.getInfo().width), static_cast<int32_t>(output.getInfo().height)}};
+
+            if (m_configUpdated[eye] || memcmp(&viewport, &m_viewports[eye], sizeof(viewport))) {
+                m_viewports[eye] = viewport;
+                updateScaler(eye);
+                m_configUpdated[eye] = false;
+            }
+        }
+
+        void updateScaler(size_t eye) {
+            const auto& viewport = m_viewports[eye];
+
             NISConfig config = {};
             if (!m_isSharpenOnly) {
                 NVScalerUpdateConfig(config,
-                                     sharpness,
-                                     0,
-                                     0,
-                                     m_inputWidth,
-                                     m_inputHeight,
-                                     m_inputWidth,
-                                     m_inputHeight,
-                                     0,
-                                     0,
-                                     m_outputWidth,
-                                     m_outputHeight,
-                                     m_outputWidth,
-                                     m_outputHeight,
+                                     m_sharpness,
+                                     viewport.input.offset.x,
+                                     viewport.input.offset.y,
+                                     viewport.input.extent.width,
+                                     viewport.input.extent.height,
+                                     viewport.inputSize.width,
+                                     viewport.inputSize.height,
+                                     viewport.output.offset.x,
+                                     viewport.output.offset.y,
+                                     viewport.output.extent.width,
+                                     viewport.output.extent.height,
+                                     viewport.outputSize.width,
+                                     viewport.outputSize.height,
                                      NISHDRMode::None);
             } else {
                 NVSharpenUpdateConfig(config,
-                                      sharpness,
-                                      0,
-                                      0,
-                                      m_inputWidth,
-                                      m_inputHeight,
-                                      m_inputWidth,
-                                      m_inputHeight,
-                                      0,
-                                      0,
+                                      m_sharpness,
+                                      viewport.input.offset.x,
+                                      viewport.input.offset.y,
+                                      viewport.input.extent.width,
+                                      viewport.input.extent.height,
+                                      viewport.inputSize.width,
+                                      viewport.inputSize.height,
+                                      viewport.output.offset.x,
+                                      viewport.output.offset.y,
                                       NISHDRMode::None);
             }
 
-            m_configBuffer->uploadData(&config, sizeof(config));
+            m_configBuffers[eye]->uploadData(&config, sizeof(config));
         }
 
         // Taken directly from /NVIDIAImageScaling/samples/DX12/src/NVScaler.cpp.
@@ -222,9 +322,14 @@ namespace {
         uint32_t m_inputHeight;
         bool m_isSharpenOnly{false};
 
-        std::shared_ptr<IComputeShader> m_shader;
-        std::shared_ptr<IComputeShader> m_shaderVPRT;
-        std::shared_ptr<IShaderBuffer> m_configBuffer;
+        std::vector<TileShape> m_variants;
+        std::vector<Shaders> m_shaders;
+        size_t m_selectedVariant{0};
+        std::shared_ptr<IShaderTuner> m_tuner;
+        std::shared_ptr<IShaderBuffer> m_configBuffers[ViewCount];
+        Viewport m_viewports[ViewCount]{};
+        bool m_configUpdated[ViewCount]{true, true};
+        float m_sharpness{0.f};
         std::shared_ptr<ITexture> m_coefScale;
         std::shared_ptr<ITexture> m_coefUSM;
     };
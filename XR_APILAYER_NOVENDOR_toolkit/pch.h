@@ -28,6 +28,7 @@
 #include <atomic>
 #include <bit>
 #include <chrono>
+#include <condition_variable>
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <cstdarg>
@@ -45,6 +46,7 @@
 #include <numeric>
 #include <optional>
 #include <set>
+#include <shared_mutex>
 #include <thread>
 #include <vector>
 
@@ -59,6 +61,7 @@ using namespace std::chrono_literals;
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <wil/registry.h>
+#include <pdh.h>
 
 using Microsoft::WRL::ComPtr;
 
@@ -110,6 +113,7 @@ constexpr bool isPow2(const size_t value) noexcept {
 
 // Direct3D.
 #include <d3d11_1.h>
+#include <d3d11_3.h>
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <d3d11on12.h>
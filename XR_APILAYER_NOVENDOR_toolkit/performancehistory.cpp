@@ -0,0 +1,292 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::utilities;
+    using namespace toolkit::log;
+
+    // Bump when changing the format of the history file.
+    constexpr int HistoryVersion = 1;
+    constexpr size_t MaxHistorySessions = 50;
+
+    // Frame times are bucketed by 0.1ms, up to 100ms.
+    constexpr uint64_t BucketSizeUs = 100;
+    constexpr size_t NumBuckets = 1000;
+
+    // Only consider sessions with enough measurements.
+    constexpr uint32_t MinSessionSeconds = 60;
+
+    // The baseline is the median of the last sessions before the update.
+    constexpr size_t MaxBaselineSessions = 5;
+
+    // A regression must exceed both thresholds, to avoid warning about noise.
+    constexpr float RegressionThresholdPercent = 10.f;
+    constexpr float RegressionThresholdUs = 500.f;
+
+    std::string Sanitize(std::string value) {
+        std::replace(value.begin(), value.end(), '\t', ' ');
+        std::replace(value.begin(), value.end(), '\n', ' ');
+        return value;
+    }
+
+    std::optional<SessionSummary> ParseSummary(const std::string& line) {
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 12 || fields[0] != std::to_string(HistoryVersion)) {
+            return {};
+        }
+
+        try {
+            SessionSummary summary;
+            summary.applicationVersion = fields[1];
+            summary.runtime = fields[2];
+            summary.driver = fields[3];
+            summary.device = fields[4];
+            summary.features = fields[5];
+            summary.numFrames = std::stoul(fields[6]);
+            summary.frameTimeP50Us = std::stof(fields[7]);
+            summary.frameTimeP95Us = std::stof(fields[8]);
+            summary.frameTimeP99Us = std::stof(fields[9]);
+            summary.appCpuTimeUs = std::stof(fields[10]);
+            summary.appGpuTimeUs = std::stof(fields[11]);
+            return summary;
+        } catch (std::exception&) {
+            return {};
+        }
+    }
+
+    std::string FormatSummary(const SessionSummary& summary) {
+        return fmt::format("{}\t{}\t{}\t{}\t{}\t{}\t{}\t{:.0f}\t{:.0f}\t{:.0f}\t{:.0f}\t{:.0f}",
+                           HistoryVersion,
+                           Sanitize(summary.applicationVersion),
+                           Sanitize(summary.runtime),
+                           Sanitize(summary.driver),
+                           Sanitize(summary.device),
+                           Sanitize(summary.features),
+                           summary.numFrames,
+                           summary.frameTimeP50Us,
+                           summary.frameTimeP95Us,
+                           summary.frameTimeP99Us,
+                           summary.appCpuTimeUs,
+                           summary.appGpuTimeUs);
+    }
+
+    bool IsSameEnvironment(const SessionSummary& a, const SessionSummary& b) {
+        return a.applicationVersion == b.applicationVersion && a.runtime == b.runtime && a.driver == b.driver;
+    }
+
+    float Median(std::vector<float> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    float GetRegressionPercent(float current, float baseline) {
+        if (baseline <= 0.f || current - baseline < RegressionThresholdUs) {
+            return 0.f;
+        }
+        const float percent = 100.f * (current - baseline) / baseline;
+        return percent >= RegressionThresholdPercent ? percent : 0.f;
+    }
+
+    // Keeps the history in a text file (one line per session) under LocalAppData.
+    class PerformanceHistory : public IPerformanceHistory {
+      public:
+        PerformanceHistory(const std::filesystem::path& path, const SessionSummary& environment)
+            : m_path(path), m_environment(environment) {
+            std::ifstream file(m_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                if (const auto summary = ParseSummary(line)) {
+                    m_history.push_back(summary.value());
+                }
+            }
+            Log("Loaded %zu sessions from the performance history\n", m_history.size());
+        }
+
+        void setFeatures(const std::string& features) override {
+            if (features == m_environment.features) {
+                return;
+            }
+
+            m_environment.features = features;
+            m_buckets.fill(0);
+            m_numFrames = 0;
+            m_appCpuTimeSumUs = m_appGpuTimeSumUs = 0;
+            m_numSeconds = 0;
+            m_regression = {};
+        }
+
+        void addFrame(uint64_t frameTimeUs) override {
+            m_buckets[std::min(frameTimeUs / BucketSizeUs, NumBuckets - 1)]++;
+            m_numFrames++;
+        }
+
+        void addTimings(uint64_t appCpuTimeUs, uint64_t appGpuTimeUs) override {
+            m_appCpuTimeSumUs += appCpuTimeUs;
+            m_appGpuTimeSumUs += appGpuTimeUs;
+            m_numSeconds++;
+
+            // Compare once, after enough measurements.
+            if (m_numSeconds == MinSessionSeconds) {
+                m_regression = ComparePerformance(m_history, getSummary());
+                if (m_regression.detected) {
+                    Log("Performance regression after an update of the%s%s%s: frame time %+.0f%%, app CPU %+.0f%%, "
+                        "app GPU %+.0f%%\n",
+                        m_regression.isApplicationUpdated ? " application" : "",
+                        m_regression.isRuntimeUpdated ? " runtime" : "",
+                        m_regression.isDriverUpdated ? " driver" : "",
+                        m_regression.frameTimePercent,
+                        m_regression.appCpuTimePercent,
+                        m_regression.appGpuTimePercent);
+                }
+            }
+        }
+
+        PerformanceRegression getRegression() const override {
+            return m_regression;
+        }
+
+        void commit() override {
+            if (m_numSeconds < MinSessionSeconds) {
+                return;
+            }
+
+            m_history.push_back(getSummary());
+            if (m_history.size() > MaxHistorySessions) {
+                m_history.erase(m_history.begin(), m_history.end() - MaxHistorySessions);
+            }
+
+            std::ofstream file(m_path, std::ios_base::trunc);
+            if (!file.is_open()) {
+                Log("Failed to write the performance history\n");
+                return;
+            }
+            for (const auto& summary : m_history) {
+                file << FormatSummary(summary) << "\n";
+            }
+
+            // Do not record the same session twice.
+            m_numSeconds = 0;
+        }
+
+      private:
+        SessionSummary getSummary() const {
+            SessionSummary summary = m_environment;
+            summary.numFrames = static_cast<uint32_t>(m_numFrames);
+            summary.frameTimeP50Us = getPercentile(50);
+            summary.frameTimeP95Us = getPercentile(95);
+            summary.frameTimeP99Us = getPercentile(99);
+            if (m_numSeconds) {
+                summary.appCpuTimeUs = static_cast<float>(m_appCpuTimeSumUs) / m_numSeconds;
+                summary.appGpuTimeUs = static_cast<float>(m_appGpuTimeSumUs) / m_numSeconds;
+            }
+            return summary;
+        }
+
+        float getPercentile(uint32_t percent) const {
+            const uint64_t rank = (m_numFrames * percent) / 100;
+            uint64_t count = 0;
+            for (size_t i = 0; i < NumBuckets; i++) {
+                count += m_buckets[i];
+                if (count > rank) {
+                    // Use the middle of the bucket.
+                    return static_cast<float>(i * BucketSizeUs + BucketSizeUs / 2);
+                }
+            }
+            return 0.f;
+        }
+
+        const std::filesystem::path m_path;
+        SessionSummary m_environment;
+        std::vector<SessionSummary> m_history;
+
+        std::array<uint32_t, NumBuckets> m_buckets{};
+        uint64_t m_numFrames{0};
+        uint64_t m_appCpuTimeSumUs{0};
+        uint64_t m_appGpuTimeSumUs{0};
+        uint32_t m_numSeconds{0};
+
+        PerformanceRegression m_regression;
+    };
+
+} // namespace
+
+namespace toolkit::utilities {
+
+    std::shared_ptr<IPerformanceHistory> CreatePerformanceHistory(const std::filesystem::path& path,
+                                                                  const SessionSummary& environment) {
+        return std::make_shared<PerformanceHistory>(path, environment);
+    }
+
+    // Only report regressions that follow an update: the previous sessions with the same features (and on the same
+    // GPU) are the baseline, and the current session must have a different environment than the most recent of them.
+    PerformanceRegression ComparePerformance(const std::vector<SessionSummary>& history,
+                                             const SessionSummary& current) {
+        PerformanceRegression regression;
+
+        std::vector<const SessionSummary*> matches;
+        for (const auto& summary : history) {
+            if (summary.features == current.features && summary.device == current.device) {
+                matches.push_back(&summary);
+            }
+        }
+        if (matches.empty() || IsSameEnvironment(*matches.back(), current)) {
+            return regression;
+        }
+
+        // Use the last sessions in the environment before the update.
+        const SessionSummary& previous = *matches.back();
+        std::vector<float> frameTimes, appCpuTimes, appGpuTimes;
+        for (auto it = matches.crbegin(); it != matches.crend() && frameTimes.size() < MaxBaselineSessions; ++it) {
+            if (!IsSameEnvironment(**it, previous)) {
+                break;
+            }
+            frameTimes.push_back((*it)->frameTimeP50Us);
+            appCpuTimes.push_back((*it)->appCpuTimeUs);
+            appGpuTimes.push_back((*it)->appGpuTimeUs);
+        }
+
+        regression.frameTimePercent = GetRegressionPercent(current.frameTimeP50Us, Median(frameTimes));
+        regression.appCpuTimePercent = GetRegressionPercent(current.appCpuTimeUs, Median(appCpuTimes));
+        regression.appGpuTimePercent = GetRegressionPercent(current.appGpuTimeUs, Median(appGpuTimes));
+        regression.detected = regression.frameTimePercent > 0.f || regression.appCpuTimePercent > 0.f ||
+                              regression.appGpuTimePercent > 0.f;
+        regression.isApplicationUpdated = current.applicationVersion != previous.applicationVersion;
+        regression.isRuntimeUpdated = current.runtime != previous.runtime;
+        regression.isDriverUpdated = current.driver != previous.driver;
+
+        return regression;
+    }
+
+} // namespace toolkit::utilities
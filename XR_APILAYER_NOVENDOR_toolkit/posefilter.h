@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "pch.h"
+
+namespace toolkit::input {
+
+    // A velocity-adaptive low-pass filter (the "1 Euro filter") for the aim and grip poses. It smooths heavily when the
+    // hand is still to remove the tracking jitter, and lightly when the hand moves to limit the lag.
+    class PoseFilter {
+      public:
+        struct Parameters {
+            // The cutoff frequency (in Hz) when the hand is still.
+            float minCutoff;
+
+            // How much the cutoff frequency increases with the linear (per m/s) and angular (per rad/s) speed.
+            float beta;
+            float rotationBeta;
+
+            // The maximum time (in milliseconds) to extrapolate the filtered pose from the time it was sampled to the
+            // time requested by the application (0 to disable).
+            float maxPredictionMs;
+        };
+
+        // Filter a pose that was sampled at sampleTime, and extrapolate the result to the requested time.
+        XrPosef update(const XrPosef& pose, XrTime sampleTime, XrTime time, const Parameters& parameters) {
+            using namespace DirectX;
+            using namespace xr::math;
+
+            // Locating the same space multiple times for a frame returns the same pose, and an older sample (eg: a
+            // late query for the previous frame) does not rewind the filter.
+            if (!m_lastSampleTime || sampleTime > m_lastSampleTime) {
+                const float dt = (sampleTime - m_lastSampleTime) / 1e9f;
+                m_lastSampleTime = sampleTime;
+                if (dt > MaxGap) {
+                    m_position = pose.position;
+                    m_orientation = pose.orientation;
+                    m_linearVelocity = m_angularVelocity = XMVectorZero();
+                } else {
+                    const auto position = LoadXrVector3(pose.position);
+                    const auto previousPosition = LoadXrVector3(m_position);
+                    m_linearVelocity = XMVectorLerp(
+                        m_linearVelocity, (position - previousPosition) / dt, getAlpha(DerivativeCutoff, dt));
+                    const float linearSpeed = XMVectorGetX(XMVector3Length(m_linearVelocity));
+                    StoreXrVector3(&m_position,
+                                   XMVectorLerp(previousPosition,
+                                                position,
+                                                getAlpha(parameters.minCutoff + parameters.beta * linearSpeed, dt)));
+
+                    const auto orientation = LoadXrQuaternion(pose.orientation);
+                    const auto previousOrientation = LoadXrQuaternion(m_orientation);
+                    const auto delta = XMQuaternionMultiply(XMQuaternionInverse(previousOrientation), orientation);
+                    m_angularVelocity = XMVectorLerp(
+                        m_angularVelocity, getRotationVector(delta) / dt, getAlpha(DerivativeCutoff, dt));
+                    const float angularSpeed = XMVectorGetX(XMVector3Length(m_angularVelocity));
+                    StoreXrQuaternion(
+                        &m_orientation,
+                        XMQuaternionNormalize(XMQuaternionSlerp(
+                            previousOrientation,
+                            orientation,
+                            getAlpha(parameters.minCutoff + parameters.rotationBeta * angularSpeed, dt))));
+                }
+            }
+
+            // Extrapolate with the filtered velocities, up to the requested time.
+            const float prediction =
+                std::clamp((time - m_lastSampleTime) / 1e9f, 0.f, parameters.maxPredictionMs / 1000.f);
+            XrPosef output;
+            StoreXrVector3(&output.position, LoadXrVector3(m_position) + m_linearVelocity * prediction);
+            StoreXrQuaternion(&output.orientation,
+                              XMQuaternionNormalize(XMQuaternionMultiply(
+                                  LoadXrQuaternion(m_orientation), getRotation(m_angularVelocity * prediction))));
+            return output;
+        }
+
+      private:
+        // Reset the filter after a gap in the tracking.
+        static constexpr float MaxGap = 0.1f;
+
+        // The cutoff frequency (in Hz) to filter the velocities.
+        static constexpr float DerivativeCutoff = 1.f;
+
+        static float getAlpha(float cutoff, float dt) {
+            const float tau = 1.f / (2.f * DirectX::XM_PI * cutoff);
+            return 1.f / (1.f + tau / dt);
+        }
+
+        // Convert a rotation to a vector whose direction is the axis and length is the angle.
+        static DirectX::XMVECTOR getRotationVector(DirectX::XMVECTOR rotation) {
+            using namespace DirectX;
+
+            // Take the shortest path.
+            if (XMVectorGetW(rotation) < 0.f) {
+                rotation = XMVectorNegate(rotation);
+            }
+            XMVECTOR axis;
+            float angle;
+            XMQuaternionToAxisAngle(&axis, &angle, rotation);
+            if (angle < 1e-6f) {
+                return XMVectorZero();
+            }
+            return XMVector3Normalize(axis) * angle;
+        }
+
+        static DirectX::XMVECTOR getRotation(DirectX::FXMVECTOR rotationVector) {
+            using namespace DirectX;
+
+            const float angle = XMVectorGetX(XMVector3Length(rotationVector));
+            if (angle < 1e-6f) {
+                return XMQuaternionIdentity();
+            }
+            return XMQuaternionRotationNormal(rotationVector / angle, angle);
+        }
+
+        XrTime m_lastSampleTime{0};
+        XrVector3f m_position{};
+        XrQuaternionf m_orientation{0, 0, 0, 1};
+        DirectX::XMVECTOR m_linearVelocity{};
+        DirectX::XMVECTOR m_angularVelocity{};
+    };
+
+} // namespace toolkit::input
@@ -32,6 +32,7 @@ cbuffer config : register(b0) {
     float4 Rings12;  // 1/(a1^2), 1/(b1^2), 1/(a2^2), 1/(b2^2)
     float4 Rings34;  // 1/(a3^2), 1/(b3^2), 1/(a4^2), 1/(b4^2)
     float4 Dims2;
+    float4 InputRect; // offset.xy, scale.zw (normalized)
 };
 
 SamplerState sourceSampler : register(s0);
@@ -223,7 +224,7 @@ float3 AdjustRingFlicker(float3 color, float2 pos_uv) {
 
 // For now, our shader only does a copy, effectively allowing Direct3D to convert between color formats.
 float4 mainPostProcess(in float4 position : SV_POSITION, in float2 texcoord : TEXCOORD0) : SV_TARGET {
-  float4 color = TEXTURE_SAMP(texcoord);
+  float4 color = TEXTURE_SAMP(InputRect.xy + texcoord * InputRect.zw);
 
   //if (!any(color.rgb))
   //  return color;
@@ -274,7 +275,7 @@ float4 mainPostProcess(in float4 position : SV_POSITION, in float2 texcoord : TE
 }
 
 float4 mainPassThrough(in float4 position : SV_POSITION, in float2 texcoord : TEXCOORD0) : SV_TARGET {
-  float4 color = TEXTURE_SAMP(texcoord);
+  float4 color = TEXTURE_SAMP(InputRect.xy + texcoord * InputRect.zw);
 
   //if (!any(color.rgb))
   //  return color;
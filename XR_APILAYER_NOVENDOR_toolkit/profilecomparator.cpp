@@ -0,0 +1,252 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::config;
+    using namespace toolkit::log;
+
+    // Skip the frames right after switching profile (shaders compilation, resources re-creation...).
+    constexpr auto SettleTime = 500ms;
+
+    // Bound the memory used by the percentiles (about 3 minutes at 120Hz for each profile).
+    constexpr size_t MaxSamples = 20000;
+
+    // Settings that only take effect when the session is (re-)created. They cannot be compared live.
+    const std::set<std::string> RestartBoundSettings = {SettingScalingType,
+                                                        SettingScaling,
+                                                        SettingAnamorphic,
+                                                        SettingHandTrackingEnabled,
+                                                        SettingEyeTrackingEnabled,
+                                                        SettingResolutionOverride,
+                                                        SettingResolutionWidth,
+                                                        SettingMotionReprojection};
+
+    // Two-sided 95% critical values of the Student t-distribution, for 1 to 30 degrees of freedom.
+    constexpr float StudentCriticalValues[] = {12.706f, 4.303f, 3.182f, 2.776f, 2.571f, 2.447f, 2.365f, 2.306f,
+                                               2.262f,  2.228f, 2.201f, 2.179f, 2.160f, 2.145f, 2.131f, 2.120f,
+                                               2.110f,  2.101f, 2.093f, 2.086f, 2.080f, 2.074f, 2.069f, 2.064f,
+                                               2.060f,  2.056f, 2.052f, 2.048f, 2.045f, 2.042f};
+
+    float GetStudentCriticalValue(size_t degreesOfFreedom) {
+        if (degreesOfFreedom - 1 < std::size(StudentCriticalValues)) {
+            return StudentCriticalValues[degreesOfFreedom - 1];
+        }
+
+        // Normal approximation.
+        return 1.96f;
+    }
+
+    ProfileStatistics ComputeStatistics(std::vector<uint64_t> samples) {
+        ProfileStatistics statistics;
+        if (samples.empty()) {
+            return statistics;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        statistics.numFrames = static_cast<uint32_t>(samples.size());
+        statistics.meanUs = static_cast<float>(std::accumulate(samples.cbegin(), samples.cend(), 0ull)) /
+                            statistics.numFrames;
+        statistics.medianUs = static_cast<float>(samples[samples.size() / 2]);
+        statistics.p95Us = static_cast<float>(samples[(samples.size() * 95) / 100]);
+
+        return statistics;
+    }
+
+    // Alternate between the A and B profiles, and pair each period of B with the preceding period of A. Pairing the
+    // periods (rather than comparing all the frames of A against all the frames of B) cancels out the slow changes of
+    // the scene, which would otherwise dominate the difference between the profiles.
+    class ProfileComparator : public IProfileComparator {
+      public:
+        ProfileComparator(std::shared_ptr<IConfigManager> configManager) : m_configManager(configManager) {
+        }
+
+        ~ProfileComparator() override {
+            if (m_isActive) {
+                m_configManager->revertProfile();
+            }
+        }
+
+        bool toggle() override {
+            if (m_isActive) {
+                stop();
+                return false;
+            }
+
+            if (!m_configManager->hasProfile(ProfileA) || !m_configManager->hasProfile(ProfileB)) {
+                Log("Cannot start the A/B comparison: both profiles must be saved first\n");
+                return false;
+            }
+
+            m_samples[0].clear();
+            m_samples[1].clear();
+            m_differences.clear();
+            m_lastPeriodMeanA.reset();
+            m_hasRestartBoundSettings = false;
+            m_isActive = true;
+            Log("Starting the A/B comparison\n");
+
+            startPeriod(false);
+
+            return true;
+        }
+
+        void onFrame(uint64_t gpuFrameTimeUs) override {
+            if (!m_isActive) {
+                return;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const auto elapsed = now - m_periodStart;
+            if (elapsed >= SettleTime && gpuFrameTimeUs) {
+                auto& samples = m_samples[m_isProfileB];
+                if (samples.size() < MaxSamples) {
+                    samples.push_back(gpuFrameTimeUs);
+                }
+                m_periodSumUs += gpuFrameTimeUs;
+                m_periodNumFrames++;
+            }
+
+            const auto cadence = std::chrono::seconds(std::max(1, m_configManager->peekValue(SettingProfileCadence)));
+            if (elapsed >= cadence) {
+                endPeriod();
+                startPeriod(!m_isProfileB);
+            }
+        }
+
+        ProfileComparison getComparison() const override {
+            ProfileComparison comparison;
+            if (!m_isActive) {
+                return comparison;
+            }
+
+            comparison.active = true;
+            comparison.isProfileB = m_isProfileB;
+            comparison.profiles[0] = ComputeStatistics(m_samples[0]);
+            comparison.profiles[1] = ComputeStatistics(m_samples[1]);
+            comparison.hasRestartBoundSettings = m_hasRestartBoundSettings;
+
+            const size_t numPairs = m_differences.size();
+            comparison.numPairs = static_cast<uint32_t>(numPairs);
+            if (numPairs) {
+                const double mean = std::accumulate(m_differences.cbegin(), m_differences.cend(), 0.0) / numPairs;
+                comparison.meanDifferenceUs = static_cast<float>(mean);
+
+                if (numPairs >= 2) {
+                    double sumSquares = 0.0;
+                    for (const auto difference : m_differences) {
+                        sumSquares += (difference - mean) * (difference - mean);
+                    }
+                    const double standardError = std::sqrt(sumSquares / (numPairs - 1)) / std::sqrt(numPairs);
+                    if (standardError > 0.0) {
+                        comparison.tStatistic = static_cast<float>(mean / standardError);
+                        comparison.isSignificant =
+                            std::abs(comparison.tStatistic) > GetStudentCriticalValue(numPairs - 1);
+                    }
+                }
+            }
+
+            return comparison;
+        }
+
+      private:
+        void startPeriod(bool isProfileB) {
+            m_isProfileB = isProfileB;
+
+            const auto changed = m_configManager->applyProfile(isProfileB ? ProfileB : ProfileA);
+            for (const auto& name : changed) {
+                if (RestartBoundSettings.count(name)) {
+                    m_hasRestartBoundSettings = true;
+                }
+            }
+
+            m_periodStart = std::chrono::steady_clock::now();
+            m_periodSumUs = 0;
+            m_periodNumFrames = 0;
+        }
+
+        void endPeriod() {
+            if (!m_periodNumFrames) {
+                return;
+            }
+
+            const double periodMean = static_cast<double>(m_periodSumUs) / m_periodNumFrames;
+            if (!m_isProfileB) {
+                m_lastPeriodMeanA = periodMean;
+            } else if (m_lastPeriodMeanA) {
+                m_differences.push_back(periodMean - m_lastPeriodMeanA.value());
+                m_lastPeriodMeanA.reset();
+            }
+        }
+
+        void stop() {
+            const auto comparison = getComparison();
+            Log("A/B comparison: A %.0fus (p50 %.0fus, p95 %.0fus, %u frames), B %.0fus (p50 %.0fus, p95 %.0fus, %u "
+                "frames), B-A %+.0fus over %u pairs (t=%.2f, %s)\n",
+                comparison.profiles[0].meanUs,
+                comparison.profiles[0].medianUs,
+                comparison.profiles[0].p95Us,
+                comparison.profiles[0].numFrames,
+                comparison.profiles[1].meanUs,
+                comparison.profiles[1].medianUs,
+                comparison.profiles[1].p95Us,
+                comparison.profiles[1].numFrames,
+                comparison.meanDifferenceUs,
+                comparison.numPairs,
+                comparison.tStatistic,
+                comparison.isSignificant ? "significant" : "not significant");
+
+            m_configManager->revertProfile();
+            m_isActive = false;
+        }
+
+        const std::shared_ptr<IConfigManager> m_configManager;
+
+        bool m_isActive{false};
+        bool m_isProfileB{false};
+        bool m_hasRestartBoundSettings{false};
+
+        std::chrono::steady_clock::time_point m_periodStart;
+        uint64_t m_periodSumUs{0};
+        uint32_t m_periodNumFrames{0};
+        std::optional<double> m_lastPeriodMeanA;
+
+        std::vector<uint64_t> m_samples[2];
+        std::vector<double> m_differences;
+    };
+
+} // namespace
+
+namespace toolkit::config {
+
+    std::shared_ptr<IProfileComparator> CreateProfileComparator(std::shared_ptr<IConfigManager> configManager) {
+        return std::make_shared<ProfileComparator>(configManager);
+    }
+
+} // namespace toolkit::config
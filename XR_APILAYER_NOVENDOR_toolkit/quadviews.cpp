@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright(c) 2021 Matthieu Bucchianeri
+// Copyright(c) 2021-2022 Jean-Luc Dupiot - Reality XP
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "shader_utilities.h"
+#include "factories.h"
+#include "interfaces.h"
+#include "layer.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::config;
+    using namespace toolkit::graphics;
+    using namespace toolkit::utilities;
+    using namespace toolkit::log;
+
+    struct alignas(16) QuadViewsCompositorConfig {
+        XrVector4f PeripheralUv; // scale.xy, offset.zw
+        XrVector4f FocusUv;      // scale.xy, offset.zw
+        XrVector4f FocusArea;    // u0, v0, u1, v1 (output space)
+        XrVector4f Blend;        // 1/band.x, 1/band.y
+    };
+
+    // Width of the transition between the focus and peripheral views, relative to the focus view.
+    constexpr float kBlendBand = 0.05f;
+
+    class QuadViewsCompositor : public IQuadViewsCompositor {
+      public:
+        QuadViewsCompositor(std::shared_ptr<IConfigManager> configManager, std::shared_ptr<IDevice> graphicsDevice)
+            : m_configManager(configManager), m_device(graphicsDevice) {
+            createRenderResources();
+        }
+
+        void reload() override {
+            createRenderResources();
+        }
+
+        void composite(const std::shared_ptr<ITexture>& peripheral,
+                       int32_t peripheralSlice,
+                       const XrRect2Di& peripheralRect,
+                       const std::shared_ptr<ITexture>& focus,
+                       int32_t focusSlice,
+                       const XrRect2Di& focusRect,
+                       const XrVector4f& focusArea,
+                       const std::shared_ptr<ITexture>& output,
+                       utilities::Eye eye,
+                       uint32_t layerIndex) override {
+            QuadViewsCompositorConfig config;
+            config.PeripheralUv = GetUvTransform(peripheral->getInfo(), peripheralRect);
+            config.FocusUv = GetUvTransform(focus->getInfo(), focusRect);
+            config.FocusArea = focusArea;
+            config.Blend.x = 1.f / std::max(kBlendBand * (focusArea.z - focusArea.x), FLT_EPSILON);
+            config.Blend.y = 1.f / std::max(kBlendBand * (focusArea.w - focusArea.y), FLT_EPSILON);
+            config.Blend.z = config.Blend.w = 0.f;
+
+            // Each layer needs its own constant buffers, since all the composites are recorded before the GPU
+            // executes them.
+            while (m_cbParams.size() <= layerIndex) {
+                auto& cbParams = m_cbParams.emplace_back();
+                for (auto& it : cbParams) {
+                    it = m_device->createBuffer(sizeof(QuadViewsCompositorConfig), "Quad Views Composite CB");
+                }
+            }
+
+            const auto& cbParams = m_cbParams[layerIndex][eye == Eye::Right];
+            cbParams->uploadData(&config, sizeof(config));
+
+            m_device->setShader(m_shaders[peripheral->isArray()][focus->isArray()], SamplerType::LinearClamp);
+            m_device->setShaderInput(0, cbParams);
+            m_device->setShaderInput(0, peripheral, peripheralSlice);
+            m_device->setShaderInput(1, focus, focusSlice);
+            m_device->setShaderOutput(0, output);
+            m_device->dispatchShader();
+        }
+
+      private:
+        void createRenderResources() {
+            const auto shadersDir = dllHome / "shaders";
+            const auto shaderFile = shadersDir / "quadviews.hlsl";
+
+            for (int peripheralArray = 0; peripheralArray < 2; peripheralArray++) {
+                for (int focusArray = 0; focusArray < 2; focusArray++) {
+                    shader::Defines defines;
+                    if (peripheralArray) {
+                        defines.add("PERIPHERAL_VPRT", true);
+                    }
+                    if (focusArray) {
+                        defines.add("FOCUS_VPRT", true);
+                    }
+
+                    m_shaders[peripheralArray][focusArray] = m_device->createQuadShader(
+                        shaderFile, "mainComposite", "Quad Views Composite PS", defines.get());
+                }
+            }
+
+            m_cbParams.clear();
+        }
+
+        static XrVector4f GetUvTransform(const XrSwapchainCreateInfo& info, const XrRect2Di& rect) {
+            const float invWidth = 1.f / std::max(info.width, 1u);
+            const float invHeight = 1.f / std::max(info.height, 1u);
+            return {rect.extent.width * invWidth,
+                    rect.extent.height * invHeight,
+                    rect.offset.x * invWidth,
+                    rect.offset.y * invHeight};
+        }
+
+        const std::shared_ptr<IConfigManager> m_configManager;
+        const std::shared_ptr<IDevice> m_device;
+
+        std::shared_ptr<IQuadShader> m_shaders[2][2]; // [peripheral VPRT][focus VPRT]
+        std::vector<std::array<std::shared_ptr<IShaderBuffer>, 2>> m_cbParams; // one per layer and per eye
+    };
+
+} // namespace
+
+namespace toolkit::graphics {
+
+    std::shared_ptr<IQuadViewsCompositor> CreateQuadViewsCompositor(std::shared_ptr<IConfigManager> configManager,
+                                                                    std::shared_ptr<IDevice> graphicsDevice) {
+        return std::make_shared<QuadViewsCompositor>(configManager, graphicsDevice);
+    }
+
+} // namespace toolkit::graphics
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright(c) 2021-2022 Matthieu Bucchianeri
+// Copyright(c) 2021-2022 Jean-Luc Dupiot - Reality XP
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// clang-format off
+
+cbuffer config : register(b0) {
+    float4 PeripheralUv; // scale.xy, offset.zw
+    float4 FocusUv;      // scale.xy, offset.zw
+    float4 FocusArea;    // u0, v0, u1, v1 (output space)
+    float4 Blend;        // 1/band.x, 1/band.y
+};
+
+SamplerState sourceSampler : register(s0);
+
+#ifdef PERIPHERAL_VPRT
+Texture2DArray peripheralTexture : register(t0);
+#define PERIPHERAL_SAMP(texcoord) peripheralTexture.Sample(sourceSampler, float3((texcoord), 0))
+#else
+Texture2D peripheralTexture : register(t0);
+#define PERIPHERAL_SAMP(texcoord) peripheralTexture.Sample(sourceSampler, (texcoord))
+#endif
+
+#ifdef FOCUS_VPRT
+Texture2DArray focusTexture : register(t1);
+#define FOCUS_SAMP(texcoord) focusTexture.Sample(sourceSampler, float3((texcoord), 0))
+#else
+Texture2D focusTexture : register(t1);
+#define FOCUS_SAMP(texcoord) focusTexture.Sample(sourceSampler, (texcoord))
+#endif
+
+float4 mainComposite(in float4 position : SV_POSITION, in float2 texcoord : TEXCOORD0) : SV_TARGET {
+    float4 color = PERIPHERAL_SAMP(texcoord * PeripheralUv.xy + PeripheralUv.zw);
+
+    // Distance to the closest edge of the focus area, negative when outside.
+    const float2 edge = min(texcoord - FocusArea.xy, FocusArea.zw - texcoord);
+    const float2 weight = saturate(edge * Blend.xy);
+    const float alpha = weight.x * weight.y;
+
+    [branch]
+    if (alpha > 0) {
+        const float2 focusUv = (texcoord - FocusArea.xy) / (FocusArea.zw - FocusArea.xy);
+        color = lerp(color, FOCUS_SAMP(focusUv * FocusUv.xy + FocusUv.zw), alpha);
+    }
+
+    return color;
+}
@@ -0,0 +1,166 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "layer.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::graphics;
+    using namespace toolkit::log;
+
+    // Number of timings to collect for each variant before making a decision.
+    constexpr size_t SamplesPerVariant = 32;
+
+    // Number of consecutive dispatches with the same variant, to limit the cost of switching.
+    constexpr size_t DispatchesPerBurst = 4;
+
+    // Required gain to move away from the default variant.
+    constexpr float MinGainPercent = 3.f;
+
+    const std::wstring TuningKey = std::wstring(RegPrefix.begin(), RegPrefix.end()) + L"\\tuning";
+
+    class ShaderTuner : public IShaderTuner {
+      public:
+        ShaderTuner(std::shared_ptr<IDevice> device, const std::string& name, size_t numVariants, size_t defaultVariant)
+            : m_device(device), m_selectedVariant(defaultVariant), m_defaultVariant(defaultVariant),
+              m_timings(numVariants) {
+            const auto valueName = name + "_" + m_device->getDriverIdentifier();
+            m_valueName = std::wstring(valueName.begin(), valueName.end());
+
+            // Reuse the previous choice for this GPU and driver.
+            const auto savedVariant = utilities::RegGetDword(HKEY_CURRENT_USER, TuningKey, m_valueName);
+            if (savedVariant && *savedVariant >= 0 && static_cast<size_t>(*savedVariant) < numVariants) {
+                m_selectedVariant = *savedVariant;
+                Log("Using tuned variant %zu for %s\n", m_selectedVariant, valueName.c_str());
+                return;
+            }
+
+            if (numVariants > 1) {
+                for (auto& timer : m_timers) {
+                    timer.timer = m_device->createTimer();
+                }
+                m_isTuning = true;
+                Log("Tuning %zu variants for %s\n", numVariants, valueName.c_str());
+            }
+        }
+
+        size_t beginDispatch() override {
+            if (!m_isTuning) {
+                return m_selectedVariant;
+            }
+
+            // Collect the timing from the last use of this timer (if ready), before reusing it.
+            auto& timer = m_timers[m_numDispatches % std::size(m_timers)];
+            if (timer.isPending) {
+                const auto duration = timer.timer->query();
+                if (duration) {
+                    m_timings[timer.variant].push_back(duration);
+                }
+                timer.isPending = false;
+            }
+
+            timer.variant = (m_numDispatches / DispatchesPerBurst) % m_timings.size();
+            timer.timer->start();
+            m_currentTimer = &timer;
+
+            return timer.variant;
+        }
+
+        void endDispatch() override {
+            if (!m_isTuning || !m_currentTimer) {
+                return;
+            }
+
+            m_currentTimer->timer->stop();
+            m_currentTimer->isPending = true;
+            m_currentTimer = nullptr;
+            m_numDispatches++;
+
+            const bool isComplete = std::all_of(
+                m_timings.cbegin(), m_timings.cend(), [](const auto& t) { return t.size() >= SamplesPerVariant; });
+            if (isComplete) {
+                m_selectedVariant = utilities::SelectFastestVariant(m_timings, m_defaultVariant, MinGainPercent);
+                utilities::RegSetDword(
+                    HKEY_CURRENT_USER, TuningKey, m_valueName, static_cast<DWORD>(m_selectedVariant));
+                Log("Tuning selected variant %zu\n", m_selectedVariant);
+                stopTuning();
+            } else if (m_numDispatches >= SamplesPerVariant * m_timings.size() * 4) {
+                // Timers are not producing data (eg: disjoint), do not persist anything.
+                Log("Tuning gave up, keeping default variant %zu\n", m_defaultVariant);
+                stopTuning();
+            }
+        }
+
+        bool isTuning() const override {
+            return m_isTuning;
+        }
+
+        size_t getSelectedVariant() const override {
+            return m_selectedVariant;
+        }
+
+      private:
+        void stopTuning() {
+            m_isTuning = false;
+            for (auto& timer : m_timers) {
+                timer.timer.reset();
+            }
+            m_timings.clear();
+        }
+
+        struct PendingTimer {
+            std::shared_ptr<IGpuTimer> timer;
+            size_t variant{0};
+            bool isPending{false};
+        };
+
+        const std::shared_ptr<IDevice> m_device;
+        std::wstring m_valueName;
+
+        size_t m_selectedVariant;
+        const size_t m_defaultVariant;
+        bool m_isTuning{false};
+
+        PendingTimer m_timers[8];
+        PendingTimer* m_currentTimer{nullptr};
+        size_t m_numDispatches{0};
+        std::vector<std::vector<uint64_t>> m_timings;
+    };
+
+} // namespace
+
+namespace toolkit::graphics {
+
+    std::shared_ptr<IShaderTuner> CreateShaderTuner(std::shared_ptr<IDevice> graphicsDevice,
+                                                    const std::string& name,
+                                                    size_t numVariants,
+                                                    size_t defaultVariant) {
+        return std::make_shared<ShaderTuner>(graphicsDevice, name, numVariants, defaultVariant);
+    }
+
+} // namespace toolkit::graphics
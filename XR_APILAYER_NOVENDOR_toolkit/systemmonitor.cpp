@@ -0,0 +1,228 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "log.h"
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::utilities;
+    using namespace toolkit::log;
+
+    // Retrieve all the instances of a wildcard counter.
+    std::vector<PDH_FMT_COUNTERVALUE_ITEM_W> GetCounterArray(PDH_HCOUNTER counter, std::vector<uint8_t>& buffer) {
+        DWORD bufferSize = 0;
+        DWORD itemCount = 0;
+        if (PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, nullptr) !=
+            PDH_MORE_DATA) {
+            return {};
+        }
+
+        buffer.resize(bufferSize);
+        auto items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buffer.data());
+        if (PdhGetFormattedCounterArrayW(counter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, items) != ERROR_SUCCESS) {
+            return {};
+        }
+
+        std::vector<PDH_FMT_COUNTERVALUE_ITEM_W> result;
+        for (DWORD i = 0; i < itemCount; i++) {
+            if (items[i].FmtValue.CStatus == PDH_CSTATUS_VALID_DATA ||
+                items[i].FmtValue.CStatus == PDH_CSTATUS_NEW_DATA) {
+                result.push_back(items[i]);
+            }
+        }
+        return result;
+    }
+
+    // Poll the performance counters (the same ones used by the Task Manager).
+    class PdhSystemUsageProvider : public ISystemUsageProvider {
+      public:
+        PdhSystemUsageProvider() : m_pidPrefix(L"pid_" + std::to_wstring(GetCurrentProcessId()) + L"_") {
+            if (PdhOpenQueryW(nullptr, 0, &m_query) != ERROR_SUCCESS) {
+                Log("Failed to open PDH query\n");
+                m_query = nullptr;
+                return;
+            }
+
+            // Missing counters (eg: older Windows versions without GPU counters) are simply not reported.
+            PdhAddEnglishCounterW(m_query, L"\\GPU Engine(*)\\Utilization Percentage", 0, &m_gpuEngineCounter);
+            PdhAddEnglishCounterW(m_query, L"\\GPU Process Memory(*)\\Dedicated Usage", 0, &m_gpuMemoryCounter);
+            PdhAddEnglishCounterW(m_query, L"\\Processor(*)\\% Processor Time", 0, &m_processorCounter);
+
+            // Rate counters need a first sample.
+            PdhCollectQueryData(m_query);
+        }
+
+        ~PdhSystemUsageProvider() override {
+            if (m_query) {
+                PdhCloseQuery(m_query);
+            }
+        }
+
+        bool sample(SystemUsage& usage) override {
+            if (!m_query || PdhCollectQueryData(m_query) != ERROR_SUCCESS) {
+                return false;
+            }
+
+            usage = {};
+
+            // The instances are named "pid_<pid>_luid_<luid>_phys_<n>_eng_<n>_engtype_<type>". The engine busy
+            // percentage is the sum across all processes, and the GPU busy percentage is the busiest engine.
+            if (m_gpuEngineCounter) {
+                std::map<std::wstring, double> engines;
+                for (const auto& item : GetCounterArray(m_gpuEngineCounter, m_buffer)) {
+                    const std::wstring_view name(item.szName);
+                    const auto luid = name.find(L"luid_");
+                    if (luid != std::wstring_view::npos) {
+                        engines[std::wstring(name.substr(luid))] += item.FmtValue.doubleValue;
+                    }
+                }
+                for (const auto& engine : engines) {
+                    usage.gpuBusyPercent = std::max(usage.gpuBusyPercent, static_cast<float>(engine.second));
+                }
+                usage.gpuBusyPercent = std::min(usage.gpuBusyPercent, 100.f);
+            }
+
+            // The instances are named "pid_<pid>_luid_<luid>_phys_<n>", one per adapter.
+            if (m_gpuMemoryCounter) {
+                for (const auto& item : GetCounterArray(m_gpuMemoryCounter, m_buffer)) {
+                    if (std::wstring_view(item.szName).rfind(m_pidPrefix, 0) == 0) {
+                        usage.processVideoMemoryBytes += static_cast<uint64_t>(item.FmtValue.doubleValue);
+                    }
+                }
+            }
+
+            // The instances are named after the logical processor index, plus "_Total".
+            if (m_processorCounter) {
+                for (const auto& item : GetCounterArray(m_processorCounter, m_buffer)) {
+                    wchar_t* end = nullptr;
+                    const auto index = wcstoul(item.szName, &end, 10);
+                    if (end == item.szName || *end != L'\0' || index >= MaxCpuCores) {
+                        continue;
+                    }
+                    usage.cpuCoreLoadPercent[index] = static_cast<float>(item.FmtValue.doubleValue);
+                    usage.numCpuCores = std::max(usage.numCpuCores, static_cast<uint32_t>(index + 1));
+                }
+            }
+
+            return true;
+        }
+
+      private:
+        const std::wstring m_pidPrefix;
+
+        PDH_HQUERY m_query{nullptr};
+        PDH_HCOUNTER m_gpuEngineCounter{nullptr};
+        PDH_HCOUNTER m_gpuMemoryCounter{nullptr};
+        PDH_HCOUNTER m_processorCounter{nullptr};
+
+        std::vector<uint8_t> m_buffer;
+    };
+
+    // Poll the provider from a background thread, so that the (rather expensive) counters enumeration never stalls
+    // the frame loop.
+    class SystemMonitor : public ISystemMonitor {
+      public:
+        SystemMonitor(std::shared_ptr<ISystemUsageProvider> provider, std::chrono::milliseconds period)
+            : m_provider(provider), m_period(period) {
+            m_thread = std::thread([&] { samplerThread(); });
+        }
+
+        ~SystemMonitor() override {
+            {
+                std::unique_lock lock(m_mutex);
+                m_isRunning = false;
+            }
+            m_wakeUp.notify_all();
+            m_thread.join();
+        }
+
+        void setEnabled(bool enabled) override {
+            {
+                std::unique_lock lock(m_mutex);
+                if (m_isEnabled == enabled) {
+                    return;
+                }
+                m_isEnabled = enabled;
+                if (!enabled) {
+                    m_usage = {};
+                }
+            }
+            m_wakeUp.notify_all();
+        }
+
+        SystemUsage getUsage() const override {
+            std::unique_lock lock(m_mutex);
+            return m_usage;
+        }
+
+      private:
+        void samplerThread() {
+            SetThreadDescription(GetCurrentThread(), L"System Monitor");
+
+            std::unique_lock lock(m_mutex);
+            while (m_isRunning) {
+                if (m_isEnabled) {
+                    lock.unlock();
+                    SystemUsage usage;
+                    const bool valid = m_provider->sample(usage);
+                    lock.lock();
+
+                    if (valid && m_isEnabled) {
+                        m_usage = usage;
+                    }
+                    m_wakeUp.wait_for(lock, m_period, [&] { return !m_isRunning; });
+                } else {
+                    m_wakeUp.wait(lock, [&] { return !m_isRunning || m_isEnabled; });
+                }
+            }
+        }
+
+        const std::shared_ptr<ISystemUsageProvider> m_provider;
+        const std::chrono::milliseconds m_period;
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        bool m_isRunning{true};
+        bool m_isEnabled{false};
+        SystemUsage m_usage;
+    };
+
+} // namespace
+
+namespace toolkit::utilities {
+
+    std::shared_ptr<ISystemUsageProvider> CreatePdhSystemUsageProvider() {
+        return std::make_shared<PdhSystemUsageProvider>();
+    }
+
+    std::shared_ptr<ISystemMonitor> CreateSystemMonitor(std::shared_ptr<ISystemUsageProvider> provider,
+                                                        std::chrono::milliseconds period) {
+        return std::make_shared<SystemMonitor>(provider, period);
+    }
+
+} // namespace toolkit::utilities
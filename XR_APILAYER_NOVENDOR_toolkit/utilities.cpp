@@ -79,7 +79,7 @@ namespace toolkit::config {
     DECLARE_ENUM_TO_STRING_VIEW(OverlayType, {"Off", "FPS", "Advanced", "Developer"})
     DECLARE_ENUM_TO_STRING_VIEW(MenuFontSize, {"Small", "Medium", "Large"})
     DECLARE_ENUM_TO_STRING_VIEW(MenuTimeout, {"Short", "Medium", "Long", "None"})
-    DECLARE_ENUM_TO_STRING_VIEW(ScalingType, {"Off", "NIS", "FSR"})
+    DECLARE_ENUM_TO_STRING_VIEW(ScalingType, {"Off", "NIS", "FSR", "Center"})
     DECLARE_ENUM_TO_STRING_VIEW(MipMapBias, {"Off", "Conservative", "All"})
     DECLARE_ENUM_TO_STRING_VIEW(HandTrackingEnabled, {"Off", "Both", "Left", "Right"})
     DECLARE_ENUM_TO_STRING_VIEW(HandTrackingVisibility, {"Hidden", "Bright", "Medium", "Dark", "Darker"})
@@ -150,6 +150,123 @@ namespace toolkit::utilities {
         return size;
     }
 
+    size_t SelectFastestVariant(const std::vector<std::vector<uint64_t>>& timings,
+                                size_t defaultVariant,
+                                float minGainPercent) {
+        // Use the median to be robust against the occasional hitch.
+        const auto median = [](std::vector<uint64_t> samples) {
+            const auto middle = samples.begin() + samples.size() / 2;
+            std::nth_element(samples.begin(), middle, samples.end());
+            return *middle;
+        };
+
+        if (defaultVariant >= timings.size() || timings[defaultVariant].empty()) {
+            return defaultVariant;
+        }
+
+        const auto defaultTime = median(timings[defaultVariant]);
+        size_t bestVariant = defaultVariant;
+        auto bestTime = defaultTime;
+        for (size_t i = 0; i < timings.size(); i++) {
+            if (i == defaultVariant || timings[i].empty()) {
+                continue;
+            }
+
+            const auto time = median(timings[i]);
+            if (time < bestTime) {
+                bestVariant = i;
+                bestTime = time;
+            }
+        }
+
+        // Only move away from the default when the gain is worth it.
+        if (bestTime > defaultTime * (1.f - minGainPercent / 100.f)) {
+            return defaultVariant;
+        }
+        return bestVariant;
+    }
+
+    XrFovf GetFocusFov(const XrFovf& fullFov, const XrVector2f& centerNdc, float size) {
+        // Work in tangent space, where the image plane is linear.
+        const float tanLeft = std::tan(fullFov.angleLeft);
+        const float tanRight = std::tan(fullFov.angleRight);
+        const float tanDown = std::tan(fullFov.angleDown);
+        const float tanUp = std::tan(fullFov.angleUp);
+
+        const float halfWidth = (tanRight - tanLeft) * std::clamp(size, 0.f, 1.f) * 0.5f;
+        const float halfHeight = (tanUp - tanDown) * std::clamp(size, 0.f, 1.f) * 0.5f;
+
+        // Keep the focus region entirely within the full view.
+        const float centerX = std::clamp(tanLeft + (centerNdc.x + 1.f) * 0.5f * (tanRight - tanLeft),
+                                         tanLeft + halfWidth,
+                                         tanRight - halfWidth);
+        const float centerY = std::clamp(
+            tanDown + (centerNdc.y + 1.f) * 0.5f * (tanUp - tanDown), tanDown + halfHeight, tanUp - halfHeight);
+
+        XrFovf focusFov;
+        focusFov.angleLeft = std::atan(centerX - halfWidth);
+        focusFov.angleRight = std::atan(centerX + halfWidth);
+        focusFov.angleDown = std::atan(centerY - halfHeight);
+        focusFov.angleUp = std::atan(centerY + halfHeight);
+        return focusFov;
+    }
+
+    XrVector4f GetFocusArea(const XrFovf& fullFov, const XrFovf& focusFov) {
+        const float tanLeft = std::tan(fullFov.angleLeft);
+        const float tanRight = std::tan(fullFov.angleRight);
+        const float tanDown = std::tan(fullFov.angleDown);
+        const float tanUp = std::tan(fullFov.angleUp);
+
+        // Texture coordinates have V pointing down.
+        XrVector4f area;
+        area.x = (std::tan(focusFov.angleLeft) - tanLeft) / (tanRight - tanLeft);
+        area.y = (tanUp - std::tan(focusFov.angleUp)) / (tanUp - tanDown);
+        area.z = (std::tan(focusFov.angleRight) - tanLeft) / (tanRight - tanLeft);
+        area.w = (tanUp - std::tan(focusFov.angleDown)) / (tanUp - tanDown);
+        return area;
+    }
+
+    std::optional<graphics::VariableRateShaderFoveation>
+    GetFoveationForLevel(XrFoveationLevelFB level, float verticalOffsetDegrees, const XrFovf& fov, bool eyeTracked) {
+        graphics::VariableRateShaderFoveation foveation;
+
+        // Follow the VRS presets: the rings of the Wide, Balanced and Narrow patterns, and the Quality rates for the
+        // low level then the Performance rates, with a coarser periphery at the high level.
+        switch (level) {
+        case XR_FOVEATION_LEVEL_LOW_FB:
+            foveation.innerRadius = 55, foveation.outerRadius = 80;
+            foveation.rates[0] = to_integral(VariableShadingRateVal::R_1x1);
+            foveation.rates[1] = to_integral(VariableShadingRateVal::R_2x1);
+            foveation.rates[2] = to_integral(VariableShadingRateVal::R_2x2);
+            break;
+        case XR_FOVEATION_LEVEL_MEDIUM_FB:
+            foveation.innerRadius = 50, foveation.outerRadius = 60;
+            foveation.rates[0] = to_integral(VariableShadingRateVal::R_1x1);
+            foveation.rates[1] = to_integral(VariableShadingRateVal::R_2x2);
+            foveation.rates[2] = to_integral(VariableShadingRateVal::R_4x2);
+            break;
+        case XR_FOVEATION_LEVEL_HIGH_FB:
+            foveation.innerRadius = 30, foveation.outerRadius = 55;
+            foveation.rates[0] = to_integral(VariableShadingRateVal::R_1x1);
+            foveation.rates[1] = to_integral(VariableShadingRateVal::R_2x2);
+            foveation.rates[2] = to_integral(VariableShadingRateVal::R_4x4);
+            break;
+        default:
+            return std::nullopt;
+        }
+
+        // The offset is an angle, convert it to the ndc of the view.
+        const float tanOffset = std::tan(verticalOffsetDegrees * float(M_PI) / 180.f);
+        const float tanExtent = tanOffset >= 0 ? std::tan(fov.angleUp) : -std::tan(fov.angleDown);
+        if (tanExtent > FLT_EPSILON) {
+            foveation.verticalOffset = std::clamp(tanOffset / tanExtent, -1.f, 1.f);
+        }
+
+        foveation.isEyeTracked = eyeTracked;
+
+        return foveation;
+    }
+
     bool UpdateKeyState(bool& keyState, const std::vector<int>& vkModifiers, int vkKey, bool isRepeat) {
         // bail out early if any modifier is not depressed.
         const auto isPressed =
@@ -62,6 +62,12 @@ namespace {
     // The number of frames before freeing an unused set of VRS mask textures.
     constexpr uint16_t MaxAge = 100;
 
+    // The number of sets of VRS mask textures to keep, eg: with dynamic resolution.
+    constexpr size_t MaxMasks = 16;
+
+    // The smallest fraction of the eye resolution for the intermediate passes (eg: quarter resolution).
+    constexpr uint32_t MaxDownscale = 4;
+
     template <typename T>
     constexpr T integer_log2(T n) noexcept {
         // _HAS_CXX20: std::bit_width(m_tileSize) - 1;
@@ -94,18 +100,91 @@ namespace {
     };
 
     struct ShadingRateMask {
+        uint32_t width;
+        uint32_t height;
         uint32_t widthInTiles;
         uint32_t heightInTiles;
 
-        // The generation of this mask. If the generation is too old, the mask must be updated.
-        uint64_t gen;
+        // The number of steps to lower the shading rates by, for passes rendering at a fraction of the eye resolution.
+        uint32_t rateReduction;
 
-        // The number of frames since the mask was last used during a rendering pass.
-        uint16_t age;
+        // The generation of the parameters this mask was drawn with (0 until it is drawn). If the generation is too
+        // old, the mask must be updated.
+        std::atomic<uint64_t> gen{0};
+
+        // The last frame during which the mask was used for a rendering pass.
+        std::atomic<uint64_t> lastUsedFrame{0};
 
         std::shared_ptr<IShaderBuffer> cbShading[ViewCount + 1];
         std::shared_ptr<ITexture> mask[ViewCount + 1];
         std::shared_ptr<ITexture> maskVPRT;
+
+        // D3D11 only.
+        ComPtr<ID3D11NvShadingRateResourceView> nvView[ViewCount + 1];
+        ComPtr<ID3D11NvShadingRateResourceView> nvViewVPRT;
+    };
+
+    using MaskList = std::vector<std::shared_ptr<ShadingRateMask>>;
+
+    // The D3D12 state of the masks while a command list is being recorded.
+    struct Dx12CommandListState {
+        std::map<ID3D12Resource*, D3D12_RESOURCE_STATES> states;
+        ID3D12Resource* boundMask{nullptr};
+
+        // The shading rate state programmed by the application itself, merged with our masks.
+        D3D12_SHADING_RATE appRate{D3D12_SHADING_RATE_1X1};
+        D3D12_SHADING_RATE_COMBINER appCombiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT]{
+            D3D12_SHADING_RATE_COMBINER_PASSTHROUGH, D3D12_SHADING_RATE_COMBINER_PASSTHROUGH};
+        ID3D12Resource* appImage{nullptr};
+    };
+
+    // The parameters that the masks are drawn with, captured for each generation.
+    struct MaskParameters {
+        uint64_t gen{0};
+        XrVector2f gazeLocation[ViewCount + 1];
+        XrVector2f rings[4];
+        uint8_t rates[ViewCount + 1][4];
+        bool swapViews{false};
+        bool preferHorizontal{true};
+    };
+
+    // A set of pointers filled concurrently by the rendering threads, without lock. Once full, the insertions are
+    // dropped.
+    template <size_t Capacity>
+    class ConcurrentPointerSet {
+      public:
+        void insert(const void* value) {
+            for (size_t i = 0, slot = hash(value); i < Capacity; i++, slot = (slot + 1) % Capacity) {
+                const void* expected = nullptr;
+                if (m_slots[slot].compare_exchange_strong(expected, value) || expected == value) {
+                    return;
+                }
+            }
+        }
+
+        bool contains(const void* value) const {
+            for (size_t i = 0, slot = hash(value); i < Capacity; i++, slot = (slot + 1) % Capacity) {
+                const void* const current = m_slots[slot];
+                if (!current || current == value) {
+                    return current == value;
+                }
+            }
+            return false;
+        }
+
+        // Not synchronized with the insertions: an insertion racing with the reset may be lost.
+        void clear() {
+            for (auto& slot : m_slots) {
+                slot = nullptr;
+            }
+        }
+
+      private:
+        static size_t hash(const void* value) {
+            return std::hash<const void*>{}(value) % Capacity;
+        }
+
+        std::atomic<const void*> m_slots[Capacity]{};
     };
 
     inline XrVector2f MakeRingParam(XrVector2f size) {
@@ -135,49 +214,65 @@ namespace {
             setupRenderConstants();
 
             // Request update.
-            m_currentGen++;
+            newGeneration();
         }
 
         ~VariableRateShader() override {
             disable();
 
             // TODO: Leak NVAPI resources for now, since there is an occasional crash.
-            for (size_t i = 0; i < m_NvShadingRateResources.views.size(); i++) {
-                LeakNVAPIResource(i);
-            }
-        }
-
-        void LeakNVAPIResource(size_t index) {
-            for (auto& view : m_NvShadingRateResources.views[index]) {
-                view.Detach();
+            for (auto& mask : *m_shadingRateMasks) {
+                for (auto& view : mask->nvView) {
+                    view.Detach();
+                }
+                mask->nvViewVPRT.Detach();
             }
-            m_NvShadingRateResources.viewsVPRT[index].Detach();
         }
 
         void beginFrame(XrTime frameTime) override {
-            // When using eye tracking we must render the views every frame.
+            m_renderTargetsWithDepth.clear();
+
+            // When using eye tracking we must render the views every frame, except while the mask is held.
             // TODO: What do we do upon (permanent) loss of tracking?
-            if (m_usingEyeTracking) {
-                updateGaze();
-                m_currentGen++;
-            }
-
-            // Age all masks. If they are used in this frame, their age will be reset to 0.
-            size_t index = 0;
-            for (auto it = m_shadingRateMask.begin(); it != m_shadingRateMask.end();) {
-                // Evict old entries.
-                if (++it->age > MaxAge) {
-                    it = m_shadingRateMask.erase(it);
-
-                    if (m_NvShadingRateResources.views.size()) {
-                        // TODO: Leak NVAPI resources for now, since there is an occasional crash.
-                        LeakNVAPIResource(index);
-                        m_NvShadingRateResources.views.erase(m_NvShadingRateResources.views.begin() + index);
-                        m_NvShadingRateResources.viewsVPRT.erase(m_NvShadingRateResources.viewsVPRT.begin() + index);
+            if (m_usingEyeTracking && updateGaze(m_holdDuringEyeMovement)) {
+                newGeneration();
+            }
+
+            const auto frameIndex = ++m_frameIndex;
+            std::vector<std::shared_ptr<ShadingRateMask>> recentMasks;
+            {
+                std::unique_lock lock(m_masksLock);
+
+                // Create the masks requested by the D3D12 command lists during the previous frame.
+                for (const auto& [width, height] : std::exchange(m_pendingMasks, {})) {
+                    addMask(width, height);
+                }
+
+                // Evict the masks that have not been used for a while.
+                auto masks = std::make_shared<MaskList>();
+                for (const auto& mask : *m_shadingRateMasks) {
+                    if (frameIndex - mask->lastUsedFrame > MaxAge) {
+                        releaseMaskResources(mask);
+                        continue;
+                    }
+                    masks->push_back(mask);
+                    if (frameIndex - mask->lastUsedFrame <= 1) {
+                        recentMasks.push_back(mask);
                     }
-                } else {
-                    it++;
-                    index++;
+                }
+                publishMasks(std::move(masks));
+            }
+
+            // We may only record our compute passes into our own command list, which is not ordered with the command
+            // lists of the application. With D3D12, the masks are drawn ahead of the rendering of each frame, and may
+            // be one frame late when the parameters change during the frame.
+            if (m_device->getApi() == Api::D3D12) {
+                bool hasUpdatedMasks = false;
+                for (const auto& mask : recentMasks) {
+                    hasUpdatedMasks |= updateMask(*mask);
+                }
+                if (hasUpdatedMasks) {
+                    m_device->flushContext();
                 }
             }
         }
@@ -187,14 +282,37 @@ namespace {
         }
 
         void update() override {
-            const auto mode = m_configManager->getEnumValue<VariableShadingRateType>(config::SettingVRS);
-            const auto hasModeChanged = mode != m_mode;
+            auto mode = m_configManager->getEnumValue<VariableShadingRateType>(config::SettingVRS);
+            // Suspension may be requested from any thread, sample it once for the whole update.
+            const bool isSuspended = m_isSuspended;
+            if (isSuspended) {
+                mode = VariableShadingRateType::None;
+            }
+
+            const auto hasAppFoveationChanged = std::exchange(m_hasAppFoveationChanged, false);
+            if (hasAppFoveationChanged) {
+                m_appFoveation = m_newAppFoveation;
+            }
 
-            if (hasModeChanged)
+            // The foveation requested by the application only applies when the user did not set up VRS.
+            const auto isUsingAppFoveation =
+                !isSuspended && mode == VariableShadingRateType::None && m_appFoveation.has_value();
+            if (isUsingAppFoveation) {
+                mode = VariableShadingRateType::Custom;
+            }
+            const auto hasModeChanged = mode != m_mode || isUsingAppFoveation != m_isUsingAppFoveation ||
+                                        (isUsingAppFoveation && hasAppFoveationChanged);
+
+            if (hasModeChanged) {
                 m_mode = mode;
+                m_isUsingAppFoveation = isUsingAppFoveation;
+            }
 
             if (mode != VariableShadingRateType::None) {
-                m_usingEyeTracking = m_eyeTracker && m_configManager->getValue(SettingEyeTrackingEnabled);
+                m_usingEyeTracking = m_eyeTracker && (m_isUsingAppFoveation
+                                                          ? m_appFoveation->isEyeTracked
+                                                          : m_configManager->getValue(SettingEyeTrackingEnabled));
+                m_holdDuringEyeMovement = m_configManager->getValue(SettingEyeSaccadeHold);
 
                 if (m_configManager->hasChanged(config::SettingZoom)) {
                     const auto zoom = m_configManager->getValue(config::SettingZoom);
@@ -214,15 +332,18 @@ namespace {
 
                 // Only update the texture when necessary.
                 if (hasQualityChanged || hasPatternChanged) {
-                    m_currentGen++;
+                    newGeneration();
                 }
             } else if (m_usingEyeTracking) {
                 m_usingEyeTracking = false;
             }
+
+            m_fullRateWithoutDepth = m_configManager->getValue(SettingVRSFullRateWithoutDepth);
         }
 
-        bool onSetRenderTarget(std::shared_ptr<graphics::IContext> context,
-                               std::shared_ptr<ITexture> renderTarget,
+        bool onSetRenderTarget(const std::shared_ptr<graphics::IContext>& context,
+                               const std::shared_ptr<ITexture>& renderTarget,
+                               bool hasDepthBuffer,
                                Eye eyeHint) override {
             const auto& info = renderTarget->getInfo();
 
@@ -231,6 +352,12 @@ namespace {
                 return false;
             }
 
+            if (isOverlayWithoutDepth(renderTarget, hasDepthBuffer)) {
+                TraceLoggingWrite(g_traceProvider, "ExemptVariableRateShading", TLArg(to_integral(eyeHint), "Eye"));
+                disable(context);
+                return false;
+            }
+
             TraceLoggingWrite(g_traceProvider, "EnableVariableRateShading", TLArg(to_integral(eyeHint), "Eye"));
 
             if (auto context11 = context->getAs<D3D11>()) {
@@ -238,8 +365,15 @@ namespace {
                 // const auto updateSingleRTV = eyeHint != Eye::Both && info.arraySize == 1;
                 // const auto updateArrayRTV = info.arraySize > 1;
                 // updateViews(updateSingleRTV, updateArrayRTV, false);
-                size_t maskIndex;
-                updateViews(context11, getOrCreateMaskResources(info.width, info.height, &maskIndex));
+                const auto maskForSize = getMaskForSize(info.width, info.height);
+                maskForSize->lastUsedFrame = m_frameIndex.load();
+
+                // The masks can only be drawn on the immediate context. For the deferred contexts, this is deferred
+                // until their command list is executed (see onExecuteContexts()).
+                const bool isImmediateContext = context11 == m_device->getContextAs<D3D11>();
+                if (isImmediateContext) {
+                    updateMask(*maskForSize);
+                }
 
                 // We set VRS on 2 viewports in case the stereo view renders in parallel.
                 NV_D3D11_VIEWPORTS_SHADING_RATE_DESC desc;
@@ -249,13 +383,14 @@ namespace {
                 desc.pViewports = m_nvRates;
                 CHECK_NVCMD(NvAPI_D3D11_RSSetViewportsPixelShadingRates(context11, &desc));
 
-                auto& mask = info.arraySize == 2 ? m_NvShadingRateResources.viewsVPRT[maskIndex]
-                                                 : m_NvShadingRateResources.views[maskIndex][to_integral(eyeHint)];
+                auto& mask = info.arraySize == 2 ? maskForSize->nvViewVPRT : maskForSize->nvView[to_integral(eyeHint)];
 
                 CHECK_NVCMD(NvAPI_D3D11_RSSetShadingRateResourceView(context11, get(mask)));
 
-                doCapture(context /* post */);
-                doCapture(context, renderTarget, eyeHint);
+                if (isImmediateContext) {
+                    doCapture(context /* post */);
+                    doCapture(context, renderTarget, eyeHint);
+                }
 
             } else if (auto context12 = context->getAs<D3D12>()) {
                 ComPtr<ID3D12GraphicsCommandList5> vrsCommandList;
@@ -264,15 +399,26 @@ namespace {
                     return false;
                 }
 
-                // TODO: for now redraw all the views until we implement better logic
-                auto& maskForSize = getOrCreateMaskResources(info.width, info.height);
-                updateViews(get(vrsCommandList), maskForSize);
+                const auto commandListState = m_Dx12ShadingRateResources.getCommandListState(get(vrsCommandList));
+
+                // The masks are drawn at the beginning of each frame (see beginFrame()): a new mask is only used
+                // starting with the next frame.
+                const auto maskForSize = getMaskForSize(info.width, info.height);
+                if (maskForSize) {
+                    maskForSize->lastUsedFrame = m_frameIndex.load();
+                }
+                if (!maskForSize || !maskForSize->gen) {
+                    m_Dx12ShadingRateResources.RSUnsetShadingRateImages(get(vrsCommandList), *commandListState);
+                    return false;
+                }
 
                 // TODO: With DX12, the mask cannot be a texture array. For now we just use the generic mask.
 
                 // Use the special SHADING_RATE_SOURCE resource state for barriers on the VRS surface
-                auto mask = maskForSize.mask[to_integral(eyeHint)]->getAs<D3D12>();
-                m_Dx12ShadingRateResources.RSSetShadingRateImage(get(vrsCommandList), mask, to_integral(eyeHint));
+                auto mask = maskForSize->mask[to_integral(eyeHint)]->getAs<D3D12>();
+                if (!m_Dx12ShadingRateResources.RSSetShadingRateImage(get(vrsCommandList), *commandListState, mask)) {
+                    return false;
+                }
 
             } else {
                 throw std::runtime_error("Unsupported graphics runtime");
@@ -281,10 +427,47 @@ namespace {
             return true;
         }
 
-        void onUnsetRenderTarget(std::shared_ptr<graphics::IContext> context) override {
+        void onUnsetRenderTarget(const std::shared_ptr<graphics::IContext>& context) override {
             disable(context);
         }
 
+        void onCloseContext(const std::shared_ptr<graphics::IContext>& context) override {
+            if (context->getAs<D3D11>()) {
+                // Do not leak the shading rate state of a deferred context into its command list.
+                if (m_mode != VariableShadingRateType::None) {
+                    disable(context);
+                }
+            } else if (auto context12 = context->getAs<D3D12>()) {
+                ComPtr<ID3D12GraphicsCommandList5> vrsCommandList;
+                if (SUCCEEDED(context12->QueryInterface(set(vrsCommandList)))) {
+                    m_Dx12ShadingRateResources.closeCommandList(get(vrsCommandList));
+                }
+            }
+        }
+
+        void onSetShadingRate(const std::shared_ptr<graphics::IContext>& context,
+                              const IDevice::ShadingRateCommand& command) override {
+            auto context12 = context->getAs<D3D12>();
+            ComPtr<ID3D12GraphicsCommandList5> vrsCommandList;
+            if (!context12 || FAILED(context12->QueryInterface(set(vrsCommandList)))) {
+                return;
+            }
+
+            m_Dx12ShadingRateResources.onApplicationCommand(
+                get(vrsCommandList), *m_Dx12ShadingRateResources.getCommandListState(get(vrsCommandList)), command);
+        }
+
+        void onExecuteContexts(const std::vector<const void*>& contexts) override {
+            // Update the masks used by the D3D11 deferred contexts, before their command lists execute. A command list
+            // may be executed several times, or after the frame it was recorded in: update any mask that is stale.
+            if (m_device->getApi() == Api::D3D11) {
+                const auto masks = std::atomic_load(&m_shadingRateMasks);
+                for (const auto& mask : *masks) {
+                    updateMask(*mask);
+                }
+            }
+        }
+
         void setViewProjectionCenters(XrVector2f left, XrVector2f right) override {
             m_gazeOffset[0] = left;
             m_gazeOffset[1] = right;
@@ -292,7 +475,13 @@ namespace {
             updateRates(m_mode);
             updateRings(m_mode);
             updateGaze();
-            m_currentGen++;
+            newGeneration();
+        }
+
+        void setApplicationFoveation(const std::optional<VariableRateShaderFoveation>& foveation) override {
+            // Applied upon the next update().
+            m_newAppFoveation = foveation;
+            m_hasAppFoveationChanged = true;
         }
 
         uint8_t getMaxRate() const override {
@@ -304,7 +493,7 @@ namespace {
         }
 
         uint64_t getCurrentGen() const override {
-            return m_mode != VariableShadingRateType::None ? m_currentGen : 0;
+            return m_mode != VariableShadingRateType::None ? m_currentGen.load() : 0;
         }
 
         void getShaderState(VariableRateShaderState& state, utilities::Eye eye) const override {
@@ -343,8 +532,15 @@ namespace {
             }
         }
 
-        void doCapture(std::shared_ptr<graphics::IContext> context,
-                       std::shared_ptr<ITexture> renderTarget = nullptr,
+        void suspend() override {
+            TraceLoggingWrite(g_traceProvider, "SuspendVariableRateShading");
+
+            // Takes effect upon the next update().
+            m_isSuspended = true;
+        }
+
+        void doCapture(const std::shared_ptr<graphics::IContext>& context,
+                       const std::shared_ptr<ITexture>& renderTarget = nullptr,
                        Eye eyeHint = Eye::Both) {
             if (!m_isCapturing)
                 return;
@@ -356,7 +552,7 @@ namespace {
                                   TLArg(m_captureID, "CaptureID"),
                                   TLArg(m_captureFileIndex, "CaptureFileIndex"));
 
-                m_captureRT = std::move(renderTarget);
+                m_captureRT = renderTarget;
                 m_captureEye = eyeHint;
             }
 
@@ -404,7 +600,6 @@ namespace {
                 resetShadingRates(Api::D3D11);
 
             } else if (m_device->getAs<D3D12>()) {
-                m_Dx12ShadingRateResources.initialize();
                 resetShadingRates(Api::D3D12);
             }
         }
@@ -425,7 +620,7 @@ namespace {
             updateGaze();
         }
 
-        void disable(std::shared_ptr<graphics::IContext> context = nullptr) {
+        void disable(const std::shared_ptr<graphics::IContext>& context = nullptr) {
             TraceLoggingWrite(g_traceProvider, "DisableVariableRateShading");
             if (m_device->getApi() == Api::D3D11) {
                 auto context11 = context ? context->getAs<D3D11>() : m_device->getContextAs<D3D11>();
@@ -436,7 +631,9 @@ namespace {
                 CHECK_NVCMD(NvAPI_D3D11_RSSetViewportsPixelShadingRates(context11, &desc));
                 CHECK_NVCMD(NvAPI_D3D11_RSSetShadingRateResourceView(context11, nullptr));
 
-                doCapture(context /* post */);
+                if (context11 == m_device->getContextAs<D3D11>()) {
+                    doCapture(context /* post */);
+                }
             } else if (m_device->getApi() == Api::D3D12) {
                 auto context12 = context ? context->getAs<D3D12>() : m_device->getContextAs<D3D12>();
 
@@ -446,7 +643,8 @@ namespace {
                     return;
                 }
 
-                m_Dx12ShadingRateResources.RSUnsetShadingRateImages(get(vrsCommandList));
+                m_Dx12ShadingRateResources.RSUnsetShadingRateImages(
+                    get(vrsCommandList), *m_Dx12ShadingRateResources.getCommandListState(get(vrsCommandList)));
 
             } else {
                 throw std::runtime_error("Unsupported graphics runtime");
@@ -454,6 +652,9 @@ namespace {
         }
 
         bool checkUpdateRates(VariableShadingRateType mode) const {
+            if (m_isUsingAppFoveation) {
+                return false;
+            }
             if (mode == VariableShadingRateType::Preset) {
                 return m_configManager->hasChanged(SettingVRSQuality);
             }
@@ -469,7 +670,16 @@ namespace {
         void updateRates(VariableShadingRateType mode) {
             m_rateDir = m_configManager->getEnumValue<VariableShadingRateDir>(SettingVRSPreferHorizontal);
 
-            if (mode == VariableShadingRateType::Preset) {
+            if (m_isUsingAppFoveation) {
+                const auto preferHorizontal = m_rateDir == VariableShadingRateDir::Horizontal;
+                for (size_t eye = 0; eye < 3; eye++) {
+                    for (size_t i = 0; i < 3; i++) {
+                        m_Rates[eye][i] = settingsRateToShadingRate(m_appFoveation->rates[i], 0, preferHorizontal);
+                    }
+                    m_Rates[eye][3] = SHADING_RATE_CULL;
+                }
+
+            } else if (mode == VariableShadingRateType::Preset) {
                 const auto quality = m_configManager->getEnumValue<VariableShadingRateQuality>(SettingVRSQuality);
                 for (size_t i = 0; i < 3; i++) {
                     const auto rate = i + (quality != VariableShadingRateQuality::Quality ? i : 0);
@@ -512,6 +722,9 @@ namespace {
         }
 
         bool checkUpdateRings(VariableShadingRateType mode) const {
+            if (m_isUsingAppFoveation) {
+                return false;
+            }
             if (mode == VariableShadingRateType::Preset) {
                 return m_configManager->hasChanged(SettingVRSPattern);
             }
@@ -543,7 +756,10 @@ namespace {
         void updateRings(VariableShadingRateType mode) {
             uint32_t radius[2] = {10000u, 10000u};
 
-            if (mode == VariableShadingRateType::Preset) {
+            if (m_isUsingAppFoveation) {
+                radius[0] = m_appFoveation->innerRadius;
+                radius[1] = m_appFoveation->outerRadius;
+            } else if (mode == VariableShadingRateType::Preset) {
                 const auto pattern = m_configManager->getEnumValue<VariableShadingRatePattern>(SettingVRSPattern);
                 if (pattern == VariableShadingRatePattern::Wide) {
                     radius[0] = 55, radius[1] = 80;
@@ -552,8 +768,7 @@ namespace {
                 } else { // VariableShadingRatePattern::Balanced
                     radius[0] = 50, radius[1] = 60;
                 }
-            }
-            if (mode == VariableShadingRateType::Custom) {
+            } else if (mode == VariableShadingRateType::Custom) {
                 radius[0] = m_configManager->getValue(SettingVRSInnerRadius);
                 radius[1] = m_configManager->getValue(SettingVRSOuterRadius);
             }
@@ -570,8 +785,13 @@ namespace {
             m_Rings[2] = MakeRingParam({100.f, 100.f}); // large enough
             m_Rings[3] = MakeRingParam({100.f, 100.f}); // large enough
 
-            m_gazeOffset[2].x = m_configManager->getValue(SettingVRSXOffset) * 0.01f;
-            m_gazeOffset[2].y = m_configManager->getValue(SettingVRSYOffset) * 0.01f;
+            if (m_isUsingAppFoveation) {
+                m_gazeOffset[2].x = 0.f;
+                m_gazeOffset[2].y = m_appFoveation->verticalOffset;
+            } else {
+                m_gazeOffset[2].x = m_configManager->getValue(SettingVRSXOffset) * 0.01f;
+                m_gazeOffset[2].y = m_configManager->getValue(SettingVRSYOffset) * 0.01f;
+            }
 
             // These depend only on VRS X/Y offsets so we update here only.
             m_gazeLocation[2].x = 0; // The generic mask only supports vertical offsets.
@@ -586,16 +806,27 @@ namespace {
                 g_traceProvider, "VariableRateShading_Rings", TLArg(radius[0], "Ring1"), TLArg(radius[1], "Ring2"));
         }
 
-        void updateGaze() {
+        // Returns false when the gaze location is held.
+        bool updateGaze(bool holdDuringEyeMovement = false) {
             using namespace xr::math;
             XrVector2f gaze[ViewCount];
             if (!m_usingEyeTracking || !m_eyeTracker || !m_eyeTracker->getProjectedGaze(gaze)) {
                 gaze[0] = m_gazeOffset[0];
                 gaze[1] = m_gazeOffset[1];
             }
+
+            // Vision is suppressed during saccades and blinks: keep the mask where it is instead of chasing the gaze,
+            // and snap to the next fixation.
+            if (holdDuringEyeMovement && m_usingEyeTracking && m_eyeTracker &&
+                m_eyeTracker->getEyeGazeState().movement != input::EyeMovement::Fixation) {
+                return false;
+            }
+
             // location = view center + view offset (L/R)
             m_gazeLocation[0] = (gaze[0] * m_zoomRatio) + m_gazeOffset[2];
             m_gazeLocation[1] = (gaze[1] * m_zoomRatio) + XrVector2f{-m_gazeOffset[2].x, m_gazeOffset[2].y};
+
+            return true;
         }
 
         void updateStats() {
@@ -615,51 +846,118 @@ namespace {
             m_stats.totalRate = std::clamp(totalRate, 0.f, 1.f);
         }
 
-        ShadingRateMask& getOrCreateMaskResources(uint32_t width, uint32_t height, size_t* index = nullptr) {
-            const auto texW = xr::math::DivideRoundingUp(width, m_tileSize);
-            const auto texH = xr::math::DivideRoundingUp(height, m_tileSize);
+        struct MaskKey {
+            uint32_t widthInTiles;
+            uint32_t heightInTiles;
+            uint32_t rateReduction;
+        };
+
+        MaskKey getMaskKey(uint32_t width, uint32_t height) const {
+            MaskKey key;
+            key.widthInTiles = xr::math::DivideRoundingUp(width, m_tileSize);
+            key.heightInTiles = xr::math::DivideRoundingUp(height, m_tileSize);
+
+            // A pass at half the eye resolution shades a quarter of the pixels: lower the rates by 2 steps (each step
+            // halves the shading rate) to keep the same density as the full resolution passes.
+            key.rateReduction = 0;
+            if (width < (m_renderWidth * 0.51f)) {
+                const auto downscale = std::round(float(m_renderWidth) / width);
+                key.rateReduction = static_cast<uint32_t>(std::round(2.f * std::log2(downscale)));
+            }
 
-            // Look-up existing resources.
-            for (size_t i = 0; i < m_shadingRateMask.size(); i++) {
-                if (m_shadingRateMask[i].widthInTiles == texW && m_shadingRateMask[i].heightInTiles == texH) {
-                    if (index) {
-                        *index = i;
-                    }
-                    return m_shadingRateMask[i];
+            return key;
+        }
+
+        static std::shared_ptr<ShadingRateMask> findMask(const MaskList& masks, const MaskKey& key) {
+            // The render targets covering the same tiles grid share a mask: the rings are normalized to the first of
+            // them, which differs from the others by less than a tile.
+            for (const auto& mask : masks) {
+                if (mask->widthInTiles == key.widthInTiles && mask->heightInTiles == key.heightInTiles &&
+                    mask->rateReduction == key.rateReduction) {
+                    return mask;
                 }
             }
+            return nullptr;
+        }
 
-            TraceLoggingWrite(g_traceProvider, "VariableRateShading_Mask", TLArg(width), TLArg(height));
+        // The masks are looked up for every render target from the threads recording the command lists: the lock is
+        // only taken when a new mask is needed.
+        std::shared_ptr<ShadingRateMask> getMaskForSize(uint32_t width, uint32_t height) {
+            const auto key = getMaskKey(width, height);
+            if (auto mask = findMask(*std::atomic_load(&m_shadingRateMasks), key)) {
+                return mask;
+            }
 
-            ShadingRateMask newMask;
-            newMask.widthInTiles = texW;
-            newMask.heightInTiles = texH;
-            newMask.age = 0;
-            newMask.gen = 0;
+            std::unique_lock lock(m_masksLock);
+
+            // With D3D12, the masks are created and drawn on the frame thread (see beginFrame()).
+            if (m_device->getApi() == Api::D3D12) {
+                m_pendingMasks.insert({width, height});
+                return nullptr;
+            }
+
+            return addMask(width, height);
+        }
+
+        // Must be called with m_masksLock held.
+        std::shared_ptr<ShadingRateMask> addMask(uint32_t width, uint32_t height) {
+            const auto key = getMaskKey(width, height);
+            if (auto mask = findMask(*m_shadingRateMasks, key)) {
+                return mask;
+            }
+
+            auto masks = std::make_shared<MaskList>(*m_shadingRateMasks);
+
+            // Evict the least recently used mask when the cache is full, eg: with dynamic resolution. The masks used
+            // during the current frame are kept.
+            if (masks->size() >= MaxMasks) {
+                const auto oldest = std::min_element(
+                    masks->begin(),
+                    masks->end(),
+                    [](const std::shared_ptr<ShadingRateMask>& a, const std::shared_ptr<ShadingRateMask>& b) {
+                        return a->lastUsedFrame < b->lastUsedFrame;
+                    });
+                if ((*oldest)->lastUsedFrame != m_frameIndex) {
+                    releaseMaskResources(*oldest);
+                    masks->erase(oldest);
+                }
+            }
+
+            TraceLoggingWrite(g_traceProvider,
+                              "VariableRateShading_Mask",
+                              TLArg(width),
+                              TLArg(height),
+                              TLArg(key.rateReduction, "RateReduction"));
+
+            auto newMask = std::make_shared<ShadingRateMask>();
+            newMask->width = width;
+            newMask->height = height;
+            newMask->widthInTiles = key.widthInTiles;
+            newMask->heightInTiles = key.heightInTiles;
+            newMask->rateReduction = key.rateReduction;
+            newMask->lastUsedFrame = m_frameIndex.load();
 
             // Initialize shading rate resources
             XrSwapchainCreateInfo info;
             ZeroMemory(&info, sizeof(info));
-            info.width = texW;
-            info.height = texH;
+            info.width = key.widthInTiles;
+            info.height = key.heightInTiles;
             info.format = DXGI_FORMAT_R8_UINT;
             info.arraySize = 1;
             info.mipCount = 1;
             info.sampleCount = 1;
             info.usageFlags = XR_SWAPCHAIN_USAGE_SAMPLED_BIT | XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT;
 
-            for (auto& it : newMask.mask) {
+            for (auto& it : newMask->mask) {
                 it = m_device->createTexture(info, "VRS TEX2D");
             }
             info.arraySize = 2;
-            newMask.maskVPRT = m_device->createTexture(info, "VRS VPRT TEX2D");
+            newMask->maskVPRT = m_device->createTexture(info, "VRS VPRT TEX2D");
 
-            for (auto& it : newMask.cbShading) {
+            for (auto& it : newMask->cbShading) {
                 it = m_device->createBuffer(sizeof(ShadingConstants), "VRS CB");
             }
 
-            m_shadingRateMask.push_back(newMask);
-
             if (auto device11 = m_device->getAs<D3D11>()) {
                 NV_D3D11_SHADING_RATE_RESOURCE_VIEW_DESC desc;
                 ZeroMemory(&desc, sizeof(desc));
@@ -668,84 +966,76 @@ namespace {
                 desc.ViewDimension = NV_SRRV_DIMENSION_TEXTURE2D;
                 desc.Texture2D.MipSlice = 0;
 
-                const auto newIndex = m_NvShadingRateResources.views.size();
-                m_NvShadingRateResources.views.push_back({});
-                m_NvShadingRateResources.viewsVPRT.push_back({});
-
-                for (size_t i = 0; i < std::size(newMask.mask); i++) {
-                    CHECK_NVCMD(
-                        NvAPI_D3D11_CreateShadingRateResourceView(device11,
-                                                                  newMask.mask[i]->getAs<D3D11>(),
-                                                                  &desc,
-                                                                  set(m_NvShadingRateResources.views[newIndex][i])));
+                for (size_t i = 0; i < std::size(newMask->mask); i++) {
+                    CHECK_NVCMD(NvAPI_D3D11_CreateShadingRateResourceView(
+                        device11, newMask->mask[i]->getAs<D3D11>(), &desc, set(newMask->nvView[i])));
                 }
 
                 desc.ViewDimension = NV_SRRV_DIMENSION_TEXTURE2DARRAY;
                 desc.Texture2DArray.ArraySize = 2;
-                CHECK_NVCMD(
-                    NvAPI_D3D11_CreateShadingRateResourceView(device11,
-                                                              newMask.maskVPRT->getAs<D3D11>(),
-                                                              &desc,
-                                                              set(m_NvShadingRateResources.viewsVPRT[newIndex])));
+                CHECK_NVCMD(NvAPI_D3D11_CreateShadingRateResourceView(
+                    device11, newMask->maskVPRT->getAs<D3D11>(), &desc, set(newMask->nvViewVPRT)));
             }
 
-            if (index) {
-                *index = m_shadingRateMask.size() - 1;
-            }
-            return m_shadingRateMask.back();
-        }
+            masks->push_back(newMask);
+            publishMasks(std::move(masks));
 
-        void updateViews(D3D11::Context pContext, ShadingRateMask& mask) {
-            // Reset the age to keep this mask active.
-            mask.age = 0;
+            return newMask;
+        }
 
-            // Check if this mask needs to be updated.
-            if (mask.gen == m_currentGen) {
-                return;
-            }
-            mask.gen = m_currentGen;
+        // Must be called with m_masksLock held. The list is replaced rather than modified, since it is read without
+        // the lock.
+        void publishMasks(std::shared_ptr<MaskList> masks) {
+            std::atomic_store(&m_shadingRateMasks, std::shared_ptr<const MaskList>(std::move(masks)));
+        }
 
-            const auto dispatchX = xr::math::DivideRoundingUp(mask.widthInTiles, 8);
-            const auto dispatchY = xr::math::DivideRoundingUp(mask.heightInTiles, 8);
+        // The GPU may still be using the mask from a previous frame.
+        void releaseMaskResources(const std::shared_ptr<ShadingRateMask>& mask) {
+            m_device->deferRelease(mask);
+        }
 
-            for (size_t i = 0; i < std::size(mask.mask); i++) {
-                const auto constants = makeShadingConstants(i, mask.widthInTiles, mask.heightInTiles);
-                mask.cbShading[i]->uploadData(&constants, sizeof(constants));
+        // Capture the parameters for the masks, which are drawn from the rendering threads.
+        void newGeneration() {
+            std::unique_lock lock(m_masksLock);
 
-                m_csShading->updateThreadGroups({dispatchX, dispatchY, 1});
-                m_device->setShader(m_csShading, SamplerType::NearestClamp);
-                m_device->setShaderInput(0, mask.cbShading[i]);
-                m_device->setShaderInput(0, mask.mask[i]);
-                m_device->setShaderOutput(0, mask.mask[i]);
-                m_device->dispatchShader();
-            }
+            m_maskParameters.gen = m_currentGen + 1;
+            std::copy_n(m_gazeLocation, std::size(m_gazeLocation), m_maskParameters.gazeLocation);
+            std::copy_n(m_Rings, std::size(m_Rings), m_maskParameters.rings);
+            std::copy_n(&m_Rates[0][0], std::size(m_Rates) * std::size(m_Rates[0]), &m_maskParameters.rates[0][0]);
+            m_maskParameters.swapViews = m_swapViews;
+            m_maskParameters.preferHorizontal = m_rateDir == VariableShadingRateDir::Horizontal;
 
-            if (pContext) {
-                auto pDstResource = mask.maskVPRT->getAs<D3D11>();
-                pContext->CopySubresourceRegion(pDstResource, 0, 0, 0, 0, mask.mask[0]->getAs<D3D11>(), 0, nullptr);
-                pContext->CopySubresourceRegion(pDstResource, 1, 0, 0, 0, mask.mask[1]->getAs<D3D11>(), 0, nullptr);
-            }
+            m_currentGen = m_maskParameters.gen;
         }
 
-        void updateViews(ID3D12GraphicsCommandList5* pCommandList, ShadingRateMask& mask) {
-            // Reset the age to keep this mask active.
-            mask.age = 0;
-
-            // Check if this mask needs to be updated.
+        // Returns false when the mask was already up-to-date. Must be called from the immediate context (D3D11) or the
+        // frame thread (D3D12).
+        bool updateMask(ShadingRateMask& mask) {
             if (mask.gen == m_currentGen) {
-                return;
+                return false;
+            }
+
+            MaskParameters parameters;
+            {
+                std::unique_lock lock(m_masksLock);
+                parameters = m_maskParameters;
             }
-            mask.gen = m_currentGen;
 
             const auto dispatchX = xr::math::DivideRoundingUp(mask.widthInTiles, 8);
             const auto dispatchY = xr::math::DivideRoundingUp(mask.heightInTiles, 8);
 
+            auto context12 = m_device->getContextAs<D3D12>();
             for (size_t i = 0; i < std::size(mask.mask); i++) {
-                const auto constants = makeShadingConstants(i, mask.widthInTiles, mask.heightInTiles);
+                const auto constants = makeShadingConstants(i, mask, parameters);
                 mask.cbShading[i]->uploadData(&constants, sizeof(constants));
 
-                m_Dx12ShadingRateResources.ResourceBarrier(
-                    pCommandList, mask.mask[i]->getAs<D3D12>(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, i);
+                // The masks are in the common state between the command lists.
+                if (context12) {
+                    const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mask.mask[i]->getAs<D3D12>(),
+                                                                              D3D12_RESOURCE_STATE_COMMON,
+                                                                              D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+                    context12->ResourceBarrier(1, &barrier);
+                }
 
                 m_csShading->updateThreadGroups({dispatchX, dispatchY, 1});
                 m_device->setShader(m_csShading, SamplerType::NearestClamp);
@@ -753,21 +1043,50 @@ namespace {
                 m_device->setShaderInput(0, mask.mask[i]);
                 m_device->setShaderOutput(0, mask.mask[i]);
                 m_device->dispatchShader();
+
+                if (context12) {
+                    const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mask.mask[i]->getAs<D3D12>(),
+                                                                              D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+                                                                              D3D12_RESOURCE_STATE_COMMON);
+                    context12->ResourceBarrier(1, &barrier);
+                }
+            }
+
+            if (auto context11 = m_device->getContextAs<D3D11>()) {
+                auto pDstResource = mask.maskVPRT->getAs<D3D11>();
+                context11->CopySubresourceRegion(pDstResource, 0, 0, 0, 0, mask.mask[0]->getAs<D3D11>(), 0, nullptr);
+                context11->CopySubresourceRegion(pDstResource, 1, 0, 0, 0, mask.mask[1]->getAs<D3D11>(), 0, nullptr);
             }
+
+            mask.gen = parameters.gen;
+            return true;
         }
 
-        ShadingConstants makeShadingConstants(size_t eye, uint32_t texW, uint32_t texH) {
+        ShadingConstants makeShadingConstants(size_t eye,
+                                              const ShadingRateMask& mask,
+                                              const MaskParameters& parameters) const {
             ShadingConstants constants;
-            eye ^= (m_swapViews && eye != 2);
-            constants.GazeXY = m_gazeLocation[eye];
-            constants.InvDim = {1.f / texW, 1.f / texH};
-            for (size_t i = 0; i < std::size(m_Rings); i++) {
-                constants.Rings[i] = m_Rings[i];
-                constants.Rates[i] = m_shadingRates[m_Rates[eye][i]];
+            eye ^= (parameters.swapViews && eye != 2);
+            constants.GazeXY = parameters.gazeLocation[eye];
+            // The last row and column of tiles may overhang the render target.
+            constants.InvDim = {float(m_tileSize) / mask.width, float(m_tileSize) / mask.height};
+            for (size_t i = 0; i < std::size(parameters.rings); i++) {
+                constants.Rings[i] = parameters.rings[i];
+                constants.Rates[i] = m_shadingRates[reduceShadingRate(
+                    parameters.rates[eye][i], mask.rateReduction, parameters.preferHorizontal)];
             }
             return constants;
         }
 
+        uint8_t reduceShadingRate(uint8_t shadingRate, uint32_t steps, bool preferHorizontal) const {
+            if (!steps || shadingRate == SHADING_RATE_CULL) {
+                return shadingRate;
+            }
+            const auto settingsRate = shadingRateToSettingsRate(shadingRate);
+            return settingsRateToShadingRate(
+                settingsRate - std::min<size_t>(settingsRate, steps), 0, preferHorizontal);
+        }
+
         uint8_t settingsRateToShadingRate(size_t settingsRate, int rateBias = 0, bool preferHorizontal = false) const {
             static const uint8_t lut[to_integral(VariableShadingRateVal::MaxValue) - 1] = {
                 SHADING_RATE_x1, SHADING_RATE_2x1, SHADING_RATE_2x2, SHADING_RATE_4x2, SHADING_RATE_4x4};
@@ -842,9 +1161,16 @@ namespace {
 
             // Check for proportionality with the size of our render target.
             // Also check that the texture is not under 50% of the render scale. We expect that no one should use
-            // in-app render scale that is so small.
-            if (info.width < (m_renderWidth * 0.51f))
-                return false;
+            // in-app render scale that is so small. Below that, only accept the intermediate passes rendering at an
+            // integer fraction of the eye resolution (eg: half resolution bloom or volumetrics).
+            if (info.width < (m_renderWidth * 0.51f)) {
+                const auto downscale = float(m_renderWidth) / info.width;
+                const auto fraction = std::round(downscale);
+                if (fraction > MaxDownscale || std::abs(downscale - fraction) > 0.02f * fraction ||
+                    info.width < m_tileSize * 4) {
+                    return false;
+                }
+            }
 
             const float aspectRatio = (float)info.width / info.height;
             if (std::abs(aspectRatio - m_renderRatio) > 0.01f)
@@ -856,6 +1182,22 @@ namespace {
             return true;
         }
 
+        // Detect the passes drawing without depth buffer on top of a render target that has been rendered with a depth
+        // buffer earlier in the frame. This is how applications typically draw the HUD, text or other UI elements,
+        // which suffer the most from coarse shading, but it also matches the post-processing passes drawing in place.
+        // We do not see the blend state or the viewport, so we cannot tell them apart. Full screen passes that come
+        // before (eg: deferred lighting) are not affected.
+        bool isOverlayWithoutDepth(const std::shared_ptr<ITexture>& renderTarget, bool hasDepthBuffer) {
+            const void* const nativePtr = renderTarget->getNativePtr();
+
+            if (hasDepthBuffer) {
+                m_renderTargetsWithDepth.insert(nativePtr);
+                return false;
+            }
+
+            return m_fullRateWithoutDepth && m_renderTargetsWithDepth.contains(nativePtr);
+        }
+
         const std::shared_ptr<IConfigManager> m_configManager;
         const std::shared_ptr<IDevice> m_device;
         const std::shared_ptr<input::IEyeTracker> m_eyeTracker;
@@ -869,13 +1211,25 @@ namespace {
 
         const bool m_supportFOVHack;
         bool m_usingEyeTracking{false};
+        bool m_holdDuringEyeMovement{false};
+        std::atomic<bool> m_fullRateWithoutDepth{false};
         bool m_swapViews{false};
         bool m_isCapturing{false};
 
         // The current "generation" of the mask parameters.
-        uint64_t m_currentGen{0};
+        std::atomic<uint64_t> m_currentGen{0};
+        std::atomic<uint64_t> m_frameIndex{0};
+
+        // Protects the creation and eviction of the masks, and the parameters they are drawn with.
+        std::mutex m_masksLock;
+        MaskParameters m_maskParameters;
 
         VariableShadingRateType m_mode{VariableShadingRateType::None};
+        std::optional<VariableRateShaderFoveation> m_appFoveation;
+        std::optional<VariableRateShaderFoveation> m_newAppFoveation;
+        bool m_hasAppFoveationChanged{false};
+        bool m_isUsingAppFoveation{false};
+        std::atomic<bool> m_isSuspended{false};
         VariableShadingRateDir m_rateDir{VariableShadingRateDir::Horizontal};
 
         // ShadingConstants
@@ -894,7 +1248,15 @@ namespace {
         uint8_t m_shadingRates[SHADING_RATE_COUNT];
 
         std::shared_ptr<IComputeShader> m_csShading;
-        std::vector<ShadingRateMask> m_shadingRateMask;
+
+        // The masks are shared by the command lists recorded concurrently. Only access with std::atomic_load().
+        std::shared_ptr<const MaskList> m_shadingRateMasks{std::make_shared<MaskList>()};
+
+        // The sizes of the masks to create upon the next frame (D3D12 only).
+        std::set<std::pair<uint32_t, uint32_t>> m_pendingMasks;
+
+        // The render targets that were used with a depth buffer during the current frame.
+        ConcurrentPointerSet<256> m_renderTargetsWithDepth;
 
         struct {
             // Must appear first.
@@ -913,59 +1275,141 @@ namespace {
                 // Make sure to unload NvAPI on destruction
                 deferredUnloadNvAPI.needUnload = true;
             }
-            std::vector<std::array<ComPtr<ID3D11NvShadingRateResourceView>, ViewCount + 1>> views;
-            std::vector<ComPtr<ID3D11NvShadingRateResourceView>> viewsVPRT;
-
         } m_NvShadingRateResources;
 
         struct {
-            void initialize() {
-                // Make sure we got a valid initial state
-                state[2] = state[1] = state[0] = D3D12_RESOURCE_STATE_COMMON;
-                boundState = 0;
+            // Command lists are recorded concurrently and only ordered at submission, so the resource states and
+            // bindings are tracked per command list. Every command list starts and ends with the masks in the common
+            // state, which makes any submission order valid.
+            std::shared_ptr<Dx12CommandListState> getCommandListState(ID3D12GraphicsCommandList5* pCommandList) {
+                // A command list is recorded from one thread at a time: remember its state to skip the lock upon the
+                // next render target. The state expires once the command list is closed.
+                thread_local std::pair<ID3D12GraphicsCommandList5*, std::weak_ptr<Dx12CommandListState>> lastUsed;
+                if (lastUsed.first == pCommandList) {
+                    if (auto commandListState = lastUsed.second.lock()) {
+                        return commandListState;
+                    }
+                }
+
+                std::unique_lock lock(commandListsLock);
+                auto& commandListState = commandLists[pCommandList];
+                if (!commandListState) {
+                    commandListState = std::make_shared<Dx12CommandListState>();
+                }
+                lastUsed = {pCommandList, commandListState};
+                return commandListState;
             }
 
             void ResourceBarrier(ID3D12GraphicsCommandList5* pCommandList,
+                                 Dx12CommandListState& commandListState,
                                  ID3D12Resource* pResource,
-                                 D3D12_RESOURCE_STATES newState,
-                                 size_t idx) {
-                if (state[idx] != newState) {
-                    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(pResource, state[idx], newState);
+                                 D3D12_RESOURCE_STATES newState) {
+                auto& state = commandListState.states.try_emplace(pResource, D3D12_RESOURCE_STATE_COMMON).first->second;
+                if (state != newState) {
+                    auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(pResource, state, newState);
                     pCommandList->ResourceBarrier(1, &barrier);
-                    state[idx] = newState;
+                    state = newState;
                 }
             }
 
-            void RSSetShadingRateImage(ID3D12GraphicsCommandList5* pCommandList,
-                                       ID3D12Resource* pResource,
-                                       size_t idx) {
-                const uint32_t boundMask = 1u << idx;
-                if (!(boundState & boundMask)) {
-                    ResourceBarrier(pCommandList, pResource, D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE, idx);
+            // The application may program its own shading rates: we keep its per-draw rate and per-primitive combiner,
+            // and stack our mask on top of them through the screen-space image combiner. Only one image can be bound,
+            // so we step aside while the application has its own image bound.
+            void setMergedShadingRate(ID3D12GraphicsCommandList5* pCommandList,
+                                      const Dx12CommandListState& commandListState) {
+                const auto imageCombiner = commandListState.appCombiners[1];
+                const D3D12_SHADING_RATE_COMBINER combiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT] = {
+                    commandListState.appCombiners[0],
+                    imageCombiner == D3D12_SHADING_RATE_COMBINER_SUM ? imageCombiner
+                                                                      : D3D12_SHADING_RATE_COMBINER_MAX};
+
+                pCommandList->RSSetShadingRate(commandListState.appRate, combiners);
+            }
 
-                    // RSSetShadingRate() function sets both the combiners and the per-drawcall shading rate.
-                    // We set to 1X1 for all sources and all combiners to MAX, so that the coarsest wins
-                    // (per-drawcall, per-primitive, VRS surface).
+            bool RSSetShadingRateImage(ID3D12GraphicsCommandList5* pCommandList,
+                                       Dx12CommandListState& commandListState,
+                                       ID3D12Resource* pResource) {
+                if (commandListState.appImage) {
+                    return false;
+                }
 
-                    static const D3D12_SHADING_RATE_COMBINER combiners[D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT] = {
-                        D3D12_SHADING_RATE_COMBINER_MAX, D3D12_SHADING_RATE_COMBINER_MAX};
+                if (commandListState.boundMask != pResource) {
+                    ResourceBarrier(
+                        pCommandList, commandListState, pResource, D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE);
 
-                    pCommandList->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
+                    // RSSetShadingRate() function sets both the combiners and the per-drawcall shading rate.
+                    // Without a rate from the application, this is 1X1 and the VRS surface wins.
+                    setMergedShadingRate(pCommandList, commandListState);
                     pCommandList->RSSetShadingRateImage(pResource);
 
-                    boundState = boundMask;
+                    commandListState.boundMask = pResource;
+                }
+
+                return true;
+            }
+
+            void RSUnsetShadingRateImages(ID3D12GraphicsCommandList5* pCommandList,
+                                          Dx12CommandListState& commandListState) {
+                if (!commandListState.boundMask) {
+                    return;
+                }
+
+                // To disable VRS, restore the state programmed by the application (by default 1X1 with no combiners,
+                // and no RSSetShadingRateImage()).
+                pCommandList->RSSetShadingRate(commandListState.appRate, commandListState.appCombiners);
+                pCommandList->RSSetShadingRateImage(commandListState.appImage);
+                commandListState.boundMask = nullptr;
+            }
+
+            // The command has already reached the command list: amend the state when our mask is bound.
+            void onApplicationCommand(ID3D12GraphicsCommandList5* pCommandList,
+                                      Dx12CommandListState& commandListState,
+                                      const IDevice::ShadingRateCommand& command) {
+                if (!command.isImage) {
+                    commandListState.appRate = command.baseRate;
+                    std::copy_n(command.combiners, std::size(command.combiners), commandListState.appCombiners);
+                    if (commandListState.boundMask) {
+                        setMergedShadingRate(pCommandList, commandListState);
+                    }
+                    return;
+                }
+
+                commandListState.appImage = command.image;
+                if (commandListState.boundMask) {
+                    if (command.image) {
+                        // The application replaced our mask with its own.
+                        pCommandList->RSSetShadingRate(commandListState.appRate, commandListState.appCombiners);
+                        commandListState.boundMask = nullptr;
+                    } else {
+                        pCommandList->RSSetShadingRateImage(commandListState.boundMask);
+                    }
                 }
             }
 
-            void RSUnsetShadingRateImages(ID3D12GraphicsCommandList5* pCommandList) {
-                // To disable VRS, set shading rate to 1X1 with no combiners, and no RSSetShadingRateImage()
-                pCommandList->RSSetShadingRate(D3D12_SHADING_RATE_1X1, nullptr);
-                pCommandList->RSSetShadingRateImage(nullptr);
-                boundState = 0;
+            void closeCommandList(ID3D12GraphicsCommandList5* pCommandList) {
+                std::shared_ptr<Dx12CommandListState> commandListState;
+                {
+                    std::unique_lock lock(commandListsLock);
+                    auto it = commandLists.find(pCommandList);
+                    if (it == commandLists.end()) {
+                        return;
+                    }
+                    commandListState = std::move(it->second);
+                    commandLists.erase(it);
+                }
+
+                // Return the masks to the common state before the command list is submitted.
+                for (const auto& [pResource, state] : commandListState->states) {
+                    if (state != D3D12_RESOURCE_STATE_COMMON) {
+                        auto barrier =
+                            CD3DX12_RESOURCE_BARRIER::Transition(pResource, state, D3D12_RESOURCE_STATE_COMMON);
+                        pCommandList->ResourceBarrier(1, &barrier);
+                    }
+                }
             }
 
-            D3D12_RESOURCE_STATES state[ViewCount + 1];
-            uint32_t boundState;
+            std::mutex commandListsLock;
+            std::map<ID3D12GraphicsCommandList5*, std::shared_ptr<Dx12CommandListState>> commandLists;
 
         } m_Dx12ShadingRateResources;
 
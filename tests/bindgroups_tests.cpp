@@ -0,0 +1,194 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include "bindgroups.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit::graphics;
+
+    // A stand-in for the GPU fence and the descriptor heap, counting the descriptor writes and the waits.
+    class FakeGpu {
+      public:
+        // The fence value that the commands recorded now complete with.
+        uint64_t getCurrentFenceValue() const {
+            return m_submittedFenceValue + 1;
+        }
+
+        void submit() {
+            m_submittedFenceValue++;
+        }
+
+        void complete() {
+            m_completedFenceValue = m_submittedFenceValue;
+        }
+
+        BindGroupCache createCache(uint32_t numSlots) {
+            return BindGroupCache(
+                numSlots,
+                [this]() { return m_completedFenceValue; },
+                [this](uint64_t value) {
+                    m_numWaits++;
+                    m_completedFenceValue = std::max(m_completedFenceValue, value);
+                });
+        }
+
+        // Look up or create the bind group for the objects, in the same manner as the D3D12 device.
+        const BindGroupCache::BindGroup* bind(BindGroupCache& cache,
+                                              const std::vector<std::shared_ptr<int>>& objects) {
+            BindGroupCache::Key key;
+            for (const auto& object : objects) {
+                key.push_back(reinterpret_cast<uintptr_t>(object.get()));
+            }
+            return cache.getOrCreate(key, getCurrentFenceValue(), [&](uint32_t slot) {
+                m_numDescriptorWrites += static_cast<uint32_t>(objects.size());
+                m_lastWrittenSlot = slot;
+                return std::vector<std::weak_ptr<void>>(objects.cbegin(), objects.cend());
+            });
+        }
+
+        uint32_t m_numDescriptorWrites{0};
+        uint32_t m_numWaits{0};
+        uint32_t m_lastWrittenSlot{~0u};
+
+      private:
+        uint64_t m_submittedFenceValue{0};
+        uint64_t m_completedFenceValue{0};
+    };
+
+} // namespace
+
+namespace toolkit::tests {
+
+    TEST_CLASS(BindGroupCacheTests) {
+      public:
+        TEST_METHOD(WritesDescriptorsOnce) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(4);
+            const auto input = std::make_shared<int>(0);
+            const auto output = std::make_shared<int>(1);
+
+            const auto first = gpu.bind(cache, {input, output});
+            Assert::IsNotNull(first);
+            Assert::AreEqual(2u, gpu.m_numDescriptorWrites);
+
+            // eg: the same pass on every frame.
+            for (int i = 0; i < 100; i++) {
+                gpu.submit();
+                gpu.complete();
+                Assert::IsTrue(first == gpu.bind(cache, {input, output}));
+            }
+            Assert::AreEqual(2u, gpu.m_numDescriptorWrites);
+            Assert::AreEqual(size_t(1), cache.size());
+            Assert::AreEqual(0u, gpu.m_numWaits);
+        }
+
+        TEST_METHOD(DistinguishesBindingOrder) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(4);
+            const auto a = std::make_shared<int>(0);
+            const auto b = std::make_shared<int>(1);
+
+            const auto first = gpu.bind(cache, {a, b});
+            const auto second = gpu.bind(cache, {b, a});
+            Assert::IsFalse(first->slot == second->slot);
+            Assert::AreEqual(4u, gpu.m_numDescriptorWrites);
+        }
+
+        TEST_METHOD(RecyclesStaleSlotOnlyAfterGpuCompletes) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(4);
+            auto texture = std::make_shared<int>(0);
+            const auto slot = gpu.bind(cache, {texture})->slot;
+            gpu.submit();
+
+            // The texture is destroyed while the GPU may still read the descriptor.
+            texture.reset();
+            const auto other = std::make_shared<int>(1);
+            Assert::IsFalse(slot == gpu.bind(cache, {other})->slot);
+            Assert::AreEqual(size_t(1), cache.size());
+
+            gpu.submit();
+            gpu.complete();
+            const auto another = std::make_shared<int>(2);
+            Assert::AreEqual(slot, gpu.bind(cache, {another})->slot);
+            Assert::AreEqual(0u, gpu.m_numWaits);
+        }
+
+        TEST_METHOD(EvictsCompletedBindGroupsWhenFull) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(2);
+            const auto a = std::make_shared<int>(0);
+            const auto b = std::make_shared<int>(1);
+            const auto c = std::make_shared<int>(2);
+
+            gpu.bind(cache, {a});
+            gpu.bind(cache, {b});
+            gpu.submit();
+            gpu.complete();
+
+            Assert::IsNotNull(gpu.bind(cache, {c}));
+            Assert::AreEqual(3u, gpu.m_numDescriptorWrites);
+            Assert::AreEqual(0u, gpu.m_numWaits);
+        }
+
+        TEST_METHOD(WaitsForSubmittedWorkAsLastResort) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(2);
+            const auto a = std::make_shared<int>(0);
+            const auto b = std::make_shared<int>(1);
+            const auto c = std::make_shared<int>(2);
+
+            gpu.bind(cache, {a});
+            gpu.bind(cache, {b});
+            gpu.submit();
+
+            Assert::IsNotNull(gpu.bind(cache, {c}));
+            Assert::AreEqual(1u, gpu.m_numWaits);
+        }
+
+        TEST_METHOD(FailsWhenCurrentSubmissionUsesAllSlots) {
+            FakeGpu gpu;
+            auto cache = gpu.createCache(2);
+            const auto a = std::make_shared<int>(0);
+            const auto b = std::make_shared<int>(1);
+            const auto c = std::make_shared<int>(2);
+
+            gpu.bind(cache, {a});
+            gpu.bind(cache, {b});
+
+            Assert::IsNull(gpu.bind(cache, {c}));
+            Assert::AreEqual(2u, gpu.m_numDescriptorWrites);
+
+            // The bind groups of the current submission are still valid.
+            Assert::IsNotNull(gpu.bind(cache, {a}));
+            Assert::AreEqual(2u, gpu.m_numDescriptorWrites);
+        }
+    };
+
+} // namespace toolkit::tests
@@ -0,0 +1,187 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include "interfaces.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::graphics;
+
+    constexpr uint32_t NumRenderTargetEvents = 1000000;
+
+    class FakeContext : public IContext {
+      public:
+        Api getApi() const override {
+            return Api::D3D11;
+        }
+        std::shared_ptr<IDevice> getDevice() const override {
+            return nullptr;
+        }
+        void* getNativePtr() const override {
+            return nullptr;
+        }
+    };
+
+    class FakeTexture : public ITexture {
+      public:
+        Api getApi() const override {
+            return Api::D3D11;
+        }
+        std::shared_ptr<IDevice> getDevice() const override {
+            return nullptr;
+        }
+        const XrSwapchainCreateInfo& getInfo() const override {
+            return m_info;
+        }
+        bool isArray() const override {
+            return false;
+        }
+        std::shared_ptr<IShaderInputTextureView> getShaderResourceView(int32_t slice) const override {
+            return nullptr;
+        }
+        std::shared_ptr<IComputeShaderOutputView> getUnorderedAccessView(int32_t slice) const override {
+            return nullptr;
+        }
+        std::shared_ptr<IRenderTargetView> getRenderTargetView(int32_t slice) const override {
+            return nullptr;
+        }
+        std::shared_ptr<IDepthStencilView> getDepthStencilView(int32_t slice) const override {
+            return nullptr;
+        }
+        void uploadData(const void* buffer, uint32_t rowPitch, int32_t slice) override {
+        }
+        void copyTo(const std::shared_ptr<ITexture>& destination) const override {
+        }
+        void saveToFile(const std::filesystem::path& path) const override {
+        }
+        void* getNativePtr() const override {
+            return nullptr;
+        }
+        uint64_t getNativeFormat() const override {
+            return 0;
+        }
+
+      private:
+        XrSwapchainCreateInfo m_info{XR_TYPE_SWAPCHAIN_CREATE_INFO};
+    };
+
+    // Counts the render target events and records whether the objects were copied on the way.
+    class MockFrameAnalyzer : public IFrameAnalyzer {
+      public:
+        void registerColorSwapchainImage(std::shared_ptr<ITexture> source, utilities::Eye eye) override {
+        }
+        void resetForFrame() override {
+        }
+        void prepareForEndFrame() override {
+        }
+        void onSetRenderTarget(const std::shared_ptr<IContext>& context,
+                               const std::shared_ptr<ITexture>& renderTarget) override {
+            m_numSetRenderTarget++;
+            m_maxUseCount = std::max(m_maxUseCount, std::max(context.use_count(), renderTarget.use_count()));
+        }
+        void onUnsetRenderTarget(const std::shared_ptr<graphics::IContext>& context) override {
+        }
+        void onCopyTexture(const std::shared_ptr<IContext>& context,
+                           const std::shared_ptr<ITexture>& source,
+                           const std::shared_ptr<ITexture>& destination,
+                           int sourceSlice,
+                           int destinationSlice) override {
+        }
+        void onExecuteContexts(const std::vector<const void*>& contexts) override {
+        }
+        utilities::Eye getEyeHint(const std::shared_ptr<IContext>& context) const override {
+            return utilities::Eye::Both;
+        }
+        bool isEyePass(const std::shared_ptr<IContext>& context) const override {
+            return false;
+        }
+
+        uint32_t m_numSetRenderTarget{0};
+        long m_maxUseCount{0};
+    };
+
+    // The signature of the render target event before the objects were borrowed.
+    using OwningSetRenderTargetEvent =
+        std::function<void(std::shared_ptr<IContext>, std::shared_ptr<ITexture> renderTarget, bool hasDepthBuffer)>;
+
+    // Fire the event like the D3D11 hook does: the context wrapper is long-lived, and the render target is wrapped
+    // for the duration of the call. Returns the average time per event.
+    template <typename Event>
+    std::chrono::nanoseconds MeasureHookPath(const Event& event) {
+        const std::shared_ptr<IContext> context = std::make_shared<FakeContext>();
+        const std::shared_ptr<ITexture> renderTarget = std::make_shared<FakeTexture>();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < NumRenderTargetEvents; i++) {
+            event(context, renderTarget, true);
+        }
+        return (std::chrono::steady_clock::now() - start) / NumRenderTargetEvents;
+    }
+
+} // namespace
+
+namespace toolkit::tests {
+
+    // Micro-benchmark of the render target hook path, with the same forwarding as the layer (device event, then frame
+    // analyzer). The timings are only reported, since they depend on the machine.
+    TEST_CLASS(HookPathBenchmarks) {
+      public:
+        TEST_METHOD(SetRenderTargetEvent) {
+            MockFrameAnalyzer borrowingAnalyzer;
+            const IDevice::SetRenderTargetEvent borrowingEvent =
+                [&](const std::shared_ptr<IContext>& context,
+                    const std::shared_ptr<ITexture>& renderTarget,
+                    bool hasDepthBuffer) {
+                    borrowingAnalyzer.onSetRenderTarget(context, renderTarget);
+                    borrowingAnalyzer.getEyeHint(context);
+                };
+            const auto borrowing = MeasureHookPath(borrowingEvent);
+
+            MockFrameAnalyzer owningAnalyzer;
+            const OwningSetRenderTargetEvent owningEvent =
+                [&](std::shared_ptr<IContext> context, std::shared_ptr<ITexture> renderTarget, bool hasDepthBuffer) {
+                    owningAnalyzer.onSetRenderTarget(context, renderTarget);
+                    owningAnalyzer.getEyeHint(context);
+                };
+            const auto owning = MeasureHookPath(owningEvent);
+
+            Logger::WriteMessage(fmt::format("SetRenderTargetEvent: {}ns borrowed, {}ns by value\n",
+                                             borrowing.count(),
+                                             owning.count())
+                                     .c_str());
+
+            // Borrowing never takes a reference to the context or the render target.
+            Assert::AreEqual(NumRenderTargetEvents, borrowingAnalyzer.m_numSetRenderTarget);
+            Assert::AreEqual(1l, borrowingAnalyzer.m_maxUseCount);
+            Assert::AreEqual(NumRenderTargetEvents, owningAnalyzer.m_numSetRenderTarget);
+            Assert::AreEqual(2l, owningAnalyzer.m_maxUseCount);
+        }
+    };
+
+} // namespace toolkit::tests
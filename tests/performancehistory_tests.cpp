@@ -0,0 +1,209 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include "factories.h"
+#include "interfaces.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit::utilities;
+
+    SessionSummary MakeSession(const std::string& applicationVersion,
+                               const std::string& driver,
+                               float frameTimeUs,
+                               float appGpuTimeUs = 5000.f) {
+        SessionSummary summary;
+        summary.applicationVersion = applicationVersion;
+        summary.runtime = "Windows Mixed Reality Runtime";
+        summary.driver = driver;
+        summary.device = "GPU";
+        summary.features = "2000x2000 scl=0/100/0 vrs=0/0 pst=0 hnd=0 mr=0";
+        summary.numFrames = 5400;
+        summary.frameTimeP50Us = frameTimeUs;
+        summary.appCpuTimeUs = 4000.f;
+        summary.appGpuTimeUs = appGpuTimeUs;
+        return summary;
+    }
+
+} // namespace
+
+namespace toolkit::tests {
+
+    TEST_CLASS(ComparePerformanceTests) {
+      public:
+        TEST_METHOD(NoHistory) {
+            Assert::IsFalse(ComparePerformance({}, MakeSession("1.0", "dr1", 20000.f)).detected);
+        }
+
+        TEST_METHOD(IgnoresSlowerSessionWithoutUpdate) {
+            const std::vector<SessionSummary> history = {MakeSession("1.0", "dr1", 10000.f),
+                                                         MakeSession("1.0", "dr1", 10000.f)};
+            Assert::IsFalse(ComparePerformance(history, MakeSession("1.0", "dr1", 20000.f)).detected);
+        }
+
+        TEST_METHOD(DetectsRegressionAfterApplicationUpdate) {
+            const std::vector<SessionSummary> history = {MakeSession("1.0", "dr1", 10000.f),
+                                                         MakeSession("1.0", "dr1", 10000.f)};
+            const auto regression = ComparePerformance(history, MakeSession("1.1", "dr1", 12000.f));
+            Assert::IsTrue(regression.detected);
+            Assert::AreEqual(20.f, regression.frameTimePercent, 0.01f);
+            Assert::AreEqual(0.f, regression.appCpuTimePercent);
+            Assert::AreEqual(0.f, regression.appGpuTimePercent);
+            Assert::IsTrue(regression.isApplicationUpdated);
+            Assert::IsFalse(regression.isRuntimeUpdated);
+            Assert::IsFalse(regression.isDriverUpdated);
+        }
+
+        TEST_METHOD(DetectsRegressionOfAppGpuTime) {
+            const std::vector<SessionSummary> history = {MakeSession("1.0", "dr1", 10000.f, 5000.f)};
+            const auto regression = ComparePerformance(history, MakeSession("1.0", "dr2", 10000.f, 6000.f));
+            Assert::IsTrue(regression.detected);
+            Assert::AreEqual(0.f, regression.frameTimePercent);
+            Assert::AreEqual(20.f, regression.appGpuTimePercent, 0.01f);
+            Assert::IsFalse(regression.isApplicationUpdated);
+            Assert::IsTrue(regression.isDriverUpdated);
+        }
+
+        TEST_METHOD(IgnoresSmallRegressions) {
+            const std::vector<SessionSummary> history = {MakeSession("1.0", "dr1", 10000.f)};
+
+            // Above the absolute threshold, below the relative one.
+            Assert::IsFalse(ComparePerformance(history, MakeSession("1.1", "dr1", 10900.f)).detected);
+
+            // Above the relative threshold, below the absolute one.
+            const std::vector<SessionSummary> fastHistory = {MakeSession("1.0", "dr1", 2000.f)};
+            Assert::IsFalse(ComparePerformance(fastHistory, MakeSession("1.1", "dr1", 2400.f)).detected);
+        }
+
+        TEST_METHOD(IgnoresImprovements) {
+            const std::vector<SessionSummary> history = {MakeSession("1.0", "dr1", 12000.f)};
+            Assert::IsFalse(ComparePerformance(history, MakeSession("1.1", "dr1", 10000.f)).detected);
+        }
+
+        TEST_METHOD(OnlyComparesSameFeaturesAndDevice) {
+            auto otherFeatures = MakeSession("1.0", "dr1", 10000.f);
+            otherFeatures.features = "2000x2000 scl=2/70/0 vrs=0/0 pst=0 hnd=0 mr=0";
+            auto otherDevice = MakeSession("1.0", "dr1", 10000.f);
+            otherDevice.device = "Other GPU";
+
+            Assert::IsFalse(
+                ComparePerformance({otherFeatures, otherDevice}, MakeSession("1.1", "dr1", 20000.f)).detected);
+        }
+
+        TEST_METHOD(BaselineIsMedianOfPreviousEnvironment) {
+            // The slow session of the previous environment is an outlier, and the older environment is not part of
+            // the baseline.
+            const std::vector<SessionSummary> history = {MakeSession("0.9", "dr1", 5000.f),
+                                                         MakeSession("0.9", "dr1", 5000.f),
+                                                         MakeSession("1.0", "dr1", 10000.f),
+                                                         MakeSession("1.0", "dr1", 30000.f),
+                                                         MakeSession("1.0", "dr1", 10000.f)};
+            const auto regression = ComparePerformance(history, MakeSession("1.1", "dr1", 12000.f));
+            Assert::IsTrue(regression.detected);
+            Assert::AreEqual(20.f, regression.frameTimePercent, 0.01f);
+        }
+
+        TEST_METHOD(BaselineIsLimitedToLastSessions) {
+            // Only the last 5 sessions before the update count.
+            std::vector<SessionSummary> history(5, MakeSession("1.0", "dr1", 20000.f));
+            history.insert(history.end(), 5, MakeSession("1.0", "dr1", 10000.f));
+            const auto regression = ComparePerformance(history, MakeSession("1.1", "dr1", 12000.f));
+            Assert::IsTrue(regression.detected);
+            Assert::AreEqual(20.f, regression.frameTimePercent, 0.01f);
+        }
+    };
+
+    TEST_CLASS(PerformanceHistoryTests) {
+      public:
+        TEST_METHOD(ReportsRegressionAgainstRecordedSessions) {
+            const auto path = std::filesystem::temp_directory_path() / "oxrtk-performance-history-test.txt";
+            std::filesystem::remove(path);
+
+            const auto recordSession = [&](const SessionSummary& environment, uint64_t frameTimeUs) {
+                auto history = CreatePerformanceHistory(path, environment);
+                for (uint32_t second = 0; second < 60; second++) {
+                    for (uint32_t frame = 0; frame < 90; frame++) {
+                        history->addFrame(frameTimeUs);
+                    }
+                    history->addTimings(4000, 5000);
+                }
+                history->commit();
+                return history->getRegression();
+            };
+
+            Assert::IsFalse(recordSession(MakeSession("1.0", "dr1", 0.f), 11100).detected);
+            Assert::IsFalse(recordSession(MakeSession("1.0", "dr1", 0.f), 11100).detected);
+
+            const auto regression = recordSession(MakeSession("1.1", "dr1", 0.f), 14100);
+            std::filesystem::remove(path);
+
+            Assert::IsTrue(regression.detected);
+            Assert::IsTrue(regression.isApplicationUpdated);
+            // The frame times are bucketed by 0.1ms.
+            Assert::AreEqual(100.f * (14150.f - 11150.f) / 11150.f, regression.frameTimePercent, 0.01f);
+        }
+
+        TEST_METHOD(ChangingFeaturesRestartsMeasurements) {
+            const auto path = std::filesystem::temp_directory_path() / "oxrtk-performance-history-test.txt";
+            std::filesystem::remove(path);
+
+            auto environment = MakeSession("1.0", "dr1", 0.f);
+            {
+                auto history = CreatePerformanceHistory(path, environment);
+                for (uint32_t second = 0; second < 60; second++) {
+                    history->addFrame(11100);
+                    history->addTimings(4000, 5000);
+                }
+                history->commit();
+            }
+
+            environment.applicationVersion = "1.1";
+            auto history = CreatePerformanceHistory(path, environment);
+            for (uint32_t second = 0; second < 59; second++) {
+                history->addFrame(20000);
+                history->addTimings(4000, 5000);
+            }
+
+            // The comparison happens after a full minute with the same features.
+            history->setFeatures("2000x2000 scl=2/70/0 vrs=0/0 pst=0 hnd=0 mr=0");
+            history->setFeatures(environment.features);
+            history->addFrame(20000);
+            history->addTimings(4000, 5000);
+            Assert::IsFalse(history->getRegression().detected);
+
+            for (uint32_t second = 1; second < 60; second++) {
+                history->addFrame(20000);
+                history->addTimings(4000, 5000);
+            }
+            Assert::IsTrue(history->getRegression().detected);
+            std::filesystem::remove(path);
+        }
+    };
+
+} // namespace toolkit::tests
@@ -0,0 +1,203 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include <random>
+
+#include "posefilter.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit::input;
+
+    // 90Hz hand tracking.
+    constexpr XrTime SamplePeriod = 11'111'111;
+    constexpr uint32_t NumSamples = 900;
+
+    // Typical tracking jitter of the hand joints at rest.
+    constexpr float PositionNoise = 0.002f;
+    constexpr float OrientationNoise = 0.01f;
+
+    const PoseFilter::Parameters FilterParameters{1.f, 10.f, 1.f, 0.f};
+
+    XrPosef MakePose(float x, float y, float z, float yaw) {
+        return {{0, std::sin(yaw / 2), 0, std::cos(yaw / 2)}, {x, y, z}};
+    }
+
+    XrPosef AddNoise(const XrPosef& pose, std::mt19937& rng) {
+        std::normal_distribution<float> positionNoise(0.f, PositionNoise);
+        std::normal_distribution<float> orientationNoise(0.f, OrientationNoise / 2);
+        XrPosef noisy = pose;
+        noisy.position.x += positionNoise(rng);
+        noisy.position.y += positionNoise(rng);
+        noisy.position.z += positionNoise(rng);
+
+        // Small angle approximation, followed by normalization.
+        noisy.orientation.x += orientationNoise(rng);
+        noisy.orientation.y += orientationNoise(rng);
+        noisy.orientation.z += orientationNoise(rng);
+        const float length = std::sqrt(noisy.orientation.x * noisy.orientation.x +
+                                       noisy.orientation.y * noisy.orientation.y +
+                                       noisy.orientation.z * noisy.orientation.z +
+                                       noisy.orientation.w * noisy.orientation.w);
+        noisy.orientation.x /= length;
+        noisy.orientation.y /= length;
+        noisy.orientation.z /= length;
+        noisy.orientation.w /= length;
+        return noisy;
+    }
+
+    float PositionError(const XrPosef& a, const XrPosef& b) {
+        const float dx = a.position.x - b.position.x;
+        const float dy = a.position.y - b.position.y;
+        const float dz = a.position.z - b.position.z;
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    float OrientationError(const XrPosef& a, const XrPosef& b) {
+        const float dot = std::abs(a.orientation.x * b.orientation.x + a.orientation.y * b.orientation.y +
+                                   a.orientation.z * b.orientation.z + a.orientation.w * b.orientation.w);
+        return 2 * std::acos(std::min(dot, 1.f));
+    }
+
+} // namespace
+
+namespace toolkit::tests {
+
+    TEST_CLASS(PoseFilterTests) {
+      public:
+        TEST_METHOD(ReducesJitterAtRest) {
+            std::mt19937 rng(42);
+            const XrPosef pose = MakePose(0.2f, 1.f, -0.3f, 0.5f);
+
+            PoseFilter filter;
+            float rawPositionError = 0, filteredPositionError = 0;
+            float rawOrientationError = 0, filteredOrientationError = 0;
+            for (uint32_t i = 0; i < NumSamples; i++) {
+                const XrTime time = 1 + i * SamplePeriod;
+                const XrPosef noisy = AddNoise(pose, rng);
+                const XrPosef filtered = filter.update(noisy, time, time, FilterParameters);
+
+                // Let the filter settle.
+                if (i >= 90) {
+                    rawPositionError += PositionError(noisy, pose);
+                    filteredPositionError += PositionError(filtered, pose);
+                    rawOrientationError += OrientationError(noisy, pose);
+                    filteredOrientationError += OrientationError(filtered, pose);
+                }
+            }
+
+            Logger::WriteMessage(fmt::format("Position error: {:.2f}mm raw, {:.2f}mm filtered\n",
+                                             1000 * rawPositionError / (NumSamples - 90),
+                                             1000 * filteredPositionError / (NumSamples - 90))
+                                     .c_str());
+            Assert::IsTrue(filteredPositionError < rawPositionError / 2);
+            Assert::IsTrue(filteredOrientationError < rawOrientationError / 2);
+        }
+
+        TEST_METHOD(ExtrapolatesToRequestedTime) {
+            // The hand moves at a constant speed, and the application queries the pose 10ms after the latest sample.
+            constexpr float Speed = 0.5f;
+            constexpr XrTime Latency = 10'000'000;
+
+            PoseFilter filter;
+            PoseFilter extrapolatingFilter;
+            PoseFilter::Parameters extrapolatingParameters = FilterParameters;
+            extrapolatingParameters.maxPredictionMs = 20.f;
+            float error = 0, extrapolatedError = 0;
+            for (uint32_t i = 0; i < NumSamples; i++) {
+                const XrTime sampleTime = 1 + i * SamplePeriod;
+                const XrTime time = sampleTime + Latency;
+                const XrPosef sample = MakePose(Speed * sampleTime / 1e9f, 1.f, 0.f, 0.f);
+                const XrPosef expected = MakePose(Speed * time / 1e9f, 1.f, 0.f, 0.f);
+
+                const XrPosef pose = filter.update(sample, sampleTime, time, FilterParameters);
+                const XrPosef extrapolated =
+                    extrapolatingFilter.update(sample, sampleTime, time, extrapolatingParameters);
+                if (i >= 90) {
+                    error += PositionError(pose, expected);
+                    extrapolatedError += PositionError(extrapolated, expected);
+                }
+            }
+
+            Logger::WriteMessage(fmt::format("Position error at requested time: {:.2f}mm, {:.2f}mm extrapolated\n",
+                                             1000 * error / (NumSamples - 90),
+                                             1000 * extrapolatedError / (NumSamples - 90))
+                                     .c_str());
+            Assert::IsTrue(extrapolatedError < error);
+        }
+
+        TEST_METHOD(DoesNotRewind) {
+            std::mt19937 rng(42);
+            const XrPosef pose = MakePose(0.f, 1.f, 0.f, 0.f);
+            PoseFilter::Parameters parameters = FilterParameters;
+            parameters.maxPredictionMs = 20.f;
+
+            PoseFilter filter;
+            filter.update(AddNoise(pose, rng), 1, 1, parameters);
+            const XrPosef latest = filter.update(AddNoise(pose, rng), 1 + SamplePeriod, 1 + SamplePeriod, parameters);
+
+            // Same sample: same pose.
+            const XrPosef again = filter.update(AddNoise(pose, rng), 1 + SamplePeriod, 1 + SamplePeriod, parameters);
+            Assert::AreEqual(0.f, PositionError(latest, again));
+
+            // Older sample: the filter is not rewound.
+            const XrPosef older = filter.update(AddNoise(pose, rng), 1, 1 + SamplePeriod, parameters);
+            Assert::AreEqual(0.f, PositionError(latest, older));
+        }
+
+        TEST_METHOD(UpdateBenchmark) {
+            std::mt19937 rng(42);
+            const XrPosef pose = MakePose(0.2f, 1.f, -0.3f, 0.5f);
+            std::vector<XrPosef> samples;
+            for (uint32_t i = 0; i < NumSamples; i++) {
+                samples.push_back(AddNoise(pose, rng));
+            }
+            PoseFilter::Parameters parameters = FilterParameters;
+            parameters.maxPredictionMs = 20.f;
+
+            constexpr uint32_t NumIterations = 1000;
+            PoseFilter filter;
+            XrPosef output{};
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < NumIterations; i++) {
+                for (uint32_t j = 0; j < NumSamples; j++) {
+                    const XrTime time = 1 + (static_cast<XrTime>(i) * NumSamples + j) * SamplePeriod;
+                    output = filter.update(samples[j], time, time + SamplePeriod / 2, parameters);
+                }
+            }
+            const auto duration = (std::chrono::steady_clock::now() - start) / (NumIterations * NumSamples);
+
+            Logger::WriteMessage(
+                fmt::format("PoseFilter::update(): {}ns\n",
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count())
+                    .c_str());
+            Assert::IsTrue(PositionError(output, pose) < 0.1f);
+        }
+    };
+
+} // namespace toolkit::tests
@@ -0,0 +1,56 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include "factories.h"
+#include "interfaces.h"
+#include "layer.h"
+
+// Definitions normally provided by the parts of the layer that are not compiled into the tests.
+
+namespace toolkit {
+    OpenXrApi* GetInstance() {
+        return nullptr;
+    }
+} // namespace toolkit
+
+namespace toolkit::log {
+    std::ofstream logStream;
+} // namespace toolkit::log
+
+namespace toolkit::graphics {
+    std::shared_ptr<ITexture> WrapD3D11Texture(std::shared_ptr<IDevice> device,
+                                               const XrSwapchainCreateInfo& info,
+                                               ID3D11Texture2D* texture,
+                                               std::string_view debugName) {
+        return nullptr;
+    }
+
+    std::shared_ptr<ITexture> WrapD3D12Texture(std::shared_ptr<IDevice> device,
+                                               const XrSwapchainCreateInfo& info,
+                                               ID3D12Resource* texture,
+                                               std::string_view debugName) {
+        return nullptr;
+    }
+} // namespace toolkit::graphics
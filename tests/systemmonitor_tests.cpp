@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include "factories.h"
+#include "interfaces.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::utilities;
+
+    using namespace std::chrono_literals;
+
+    // A stand-in for the PDH counters, returning canned values and counting the queries.
+    class FakeSystemUsageProvider : public ISystemUsageProvider {
+      public:
+        bool sample(SystemUsage& usage) override {
+            std::unique_lock lock(m_mutex);
+            m_numSamples++;
+            m_sampled.notify_all();
+            if (!m_isValid) {
+                return false;
+            }
+            usage = m_usage;
+            return true;
+        }
+
+        void setUsage(const SystemUsage& usage, bool isValid = true) {
+            std::unique_lock lock(m_mutex);
+            m_usage = usage;
+            m_isValid = isValid;
+        }
+
+        uint32_t getNumSamples() const {
+            std::unique_lock lock(m_mutex);
+            return m_numSamples;
+        }
+
+        // The monitor stores a sample before taking the next one, so waiting for one extra sample guarantees that the
+        // previous one was processed.
+        bool waitForSamples(uint32_t count) {
+            std::unique_lock lock(m_mutex);
+            const auto target = m_numSamples + count + 1;
+            return m_sampled.wait_for(lock, 5s, [&] { return m_numSamples >= target; });
+        }
+
+      private:
+        mutable std::mutex m_mutex;
+        std::condition_variable m_sampled;
+        SystemUsage m_usage;
+        bool m_isValid{true};
+        uint32_t m_numSamples{0};
+    };
+
+    SystemUsage MakeUsage(float gpuBusyPercent, uint32_t numCpuCores) {
+        SystemUsage usage;
+        usage.gpuBusyPercent = gpuBusyPercent;
+        usage.processVideoMemoryBytes = 512ull * 1024 * 1024;
+        usage.numCpuCores = numCpuCores;
+        for (uint32_t i = 0; i < numCpuCores; i++) {
+            usage.cpuCoreLoadPercent[i] = 10.f * (i + 1);
+        }
+        return usage;
+    }
+
+} // namespace
+
+namespace toolkit::tests {
+
+    TEST_CLASS(SystemMonitorTests) {
+      public:
+        TEST_METHOD(DoesNotSampleUntilEnabled) {
+            auto provider = std::make_shared<FakeSystemUsageProvider>();
+            provider->setUsage(MakeUsage(50.f, 4));
+            auto monitor = CreateSystemMonitor(provider, 1ms);
+
+            std::this_thread::sleep_for(50ms);
+            Assert::AreEqual(0u, provider->getNumSamples());
+            Assert::AreEqual(0u, monitor->getUsage().numCpuCores);
+        }
+
+        TEST_METHOD(ReportsLatestSample) {
+            auto provider = std::make_shared<FakeSystemUsageProvider>();
+            provider->setUsage(MakeUsage(50.f, 4));
+            auto monitor = CreateSystemMonitor(provider, 1ms);
+            monitor->setEnabled(true);
+            Assert::IsTrue(provider->waitForSamples(1));
+
+            auto usage = monitor->getUsage();
+            Assert::AreEqual(50.f, usage.gpuBusyPercent);
+            Assert::AreEqual(512ull * 1024 * 1024, usage.processVideoMemoryBytes);
+            Assert::AreEqual(4u, usage.numCpuCores);
+            Assert::AreEqual(40.f, usage.cpuCoreLoadPercent[3]);
+
+            provider->setUsage(MakeUsage(75.f, 2));
+            Assert::IsTrue(provider->waitForSamples(1));
+
+            usage = monitor->getUsage();
+            Assert::AreEqual(75.f, usage.gpuBusyPercent);
+            Assert::AreEqual(2u, usage.numCpuCores);
+        }
+
+        TEST_METHOD(KeepsLastValidSample) {
+            auto provider = std::make_shared<FakeSystemUsageProvider>();
+            provider->setUsage(MakeUsage(50.f, 4));
+            auto monitor = CreateSystemMonitor(provider, 1ms);
+            monitor->setEnabled(true);
+            Assert::IsTrue(provider->waitForSamples(1));
+
+            // eg: the GPU counters are not published yet right after a device reset.
+            provider->setUsage(MakeUsage(99.f, 8), false /* isValid */);
+            Assert::IsTrue(provider->waitForSamples(2));
+
+            const auto usage = monitor->getUsage();
+            Assert::AreEqual(50.f, usage.gpuBusyPercent);
+            Assert::AreEqual(4u, usage.numCpuCores);
+        }
+
+        TEST_METHOD(ClearsAndStopsWhenDisabled) {
+            auto provider = std::make_shared<FakeSystemUsageProvider>();
+            provider->setUsage(MakeUsage(50.f, 4));
+            auto monitor = CreateSystemMonitor(provider, 1ms);
+            monitor->setEnabled(true);
+            Assert::IsTrue(provider->waitForSamples(1));
+
+            monitor->setEnabled(false);
+            Assert::AreEqual(0u, monitor->getUsage().numCpuCores);
+
+            // A sample that was in flight when disabling must not be stored.
+            std::this_thread::sleep_for(20ms);
+            const auto numSamples = provider->getNumSamples();
+            std::this_thread::sleep_for(50ms);
+            Assert::AreEqual(numSamples, provider->getNumSamples());
+            Assert::AreEqual(0u, monitor->getUsage().numCpuCores);
+
+            monitor->setEnabled(true);
+            Assert::IsTrue(provider->waitForSamples(1));
+            Assert::AreEqual(4u, monitor->getUsage().numCpuCores);
+        }
+
+        TEST_METHOD(StopsWithoutWaitingForPeriod) {
+            auto provider = std::make_shared<FakeSystemUsageProvider>();
+            auto monitor = CreateSystemMonitor(provider, 1h);
+            monitor->setEnabled(true);
+            Assert::IsTrue(provider->waitForSamples(0));
+
+            const auto start = std::chrono::steady_clock::now();
+            monitor.reset();
+            Assert::IsTrue(std::chrono::steady_clock::now() - start < 5s);
+        }
+    };
+
+} // namespace toolkit::tests
@@ -0,0 +1,270 @@
+// MIT License
+//
+// Copyright(c) 2022 Matthieu Bucchianeri
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this softwareand associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright noticeand this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+
+#include <CppUnitTest.h>
+
+#include "factories.h"
+#include "interfaces.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace {
+
+    using namespace toolkit;
+    using namespace toolkit::config;
+
+    constexpr float DegreesToRadians = float(M_PI) / 180.f;
+
+    XrFovf MakeFov(float leftDegrees, float rightDegrees, float upDegrees, float downDegrees) {
+        return {leftDegrees * DegreesToRadians,
+                rightDegrees * DegreesToRadians,
+                upDegrees * DegreesToRadians,
+                downDegrees * DegreesToRadians};
+    }
+
+    int Rate(VariableShadingRateVal rate) {
+        return to_integral(rate);
+    }
+
+} // namespace
+
+namespace toolkit::tests {
+
+    using namespace toolkit::utilities;
+
+    TEST_CLASS(SelectFastestVariantTests) {
+      public:
+        TEST_METHOD(PicksFastestMedian) {
+            const std::vector<std::vector<uint64_t>> timings = {{100, 101, 99}, {80, 81, 79}, {90, 91, 89}};
+            Assert::AreEqual(size_t(1), SelectFastestVariant(timings, 0, 3.f));
+        }
+
+        TEST_METHOD(IgnoresHitches) {
+            // One very slow and one very fast outlier must not move the median.
+            const std::vector<std::vector<uint64_t>> timings = {{100, 100, 100, 100, 100},
+                                                                {80, 80, 80, 80, 1000},
+                                                                {10, 120, 120, 120, 120}};
+            Assert::AreEqual(size_t(1), SelectFastestVariant(timings, 0, 3.f));
+        }
+
+        TEST_METHOD(KeepsDefaultBelowMinimumGain) {
+            const std::vector<std::vector<uint64_t>> timings = {{100, 100, 100}, {98, 98, 98}};
+            Assert::AreEqual(size_t(0), SelectFastestVariant(timings, 0, 3.f));
+            Assert::AreEqual(size_t(1), SelectFastestVariant(timings, 0, 1.f));
+        }
+
+        TEST_METHOD(KeepsDefaultWhenSlower) {
+            const std::vector<std::vector<uint64_t>> timings = {{120, 120, 120}, {100, 100, 100}};
+            Assert::AreEqual(size_t(1), SelectFastestVariant(timings, 1, 3.f));
+        }
+
+        TEST_METHOD(TieWithDefaultKeepsDefault) {
+            const std::vector<std::vector<uint64_t>> timings = {{80, 80, 80}, {100, 100, 100}, {80, 80, 80}};
+            Assert::AreEqual(size_t(0), SelectFastestVariant(timings, 0, 0.f));
+            Assert::AreEqual(size_t(2), SelectFastestVariant(timings, 2, 0.f));
+        }
+
+        TEST_METHOD(TieBetweenOthersPicksFirst) {
+            const std::vector<std::vector<uint64_t>> timings = {{100, 100, 100}, {80, 80, 80}, {80, 80, 80}};
+            Assert::AreEqual(size_t(1), SelectFastestVariant(timings, 0, 3.f));
+        }
+
+        TEST_METHOD(SkipsVariantsWithoutTimings) {
+            const std::vector<std::vector<uint64_t>> timings = {{100, 100, 100}, {}, {90, 90, 90}};
+            Assert::AreEqual(size_t(2), SelectFastestVariant(timings, 0, 3.f));
+        }
+
+        TEST_METHOD(NoValidTimingsKeepsDefault) {
+            Assert::AreEqual(size_t(1), SelectFastestVariant({{}, {}, {}}, 1, 3.f));
+
+            // Without a reference, the other variants cannot be judged.
+            Assert::AreEqual(size_t(0), SelectFastestVariant({{}, {50, 50, 50}}, 0, 3.f));
+
+            Assert::AreEqual(size_t(0), SelectFastestVariant({}, 0, 3.f));
+            Assert::AreEqual(size_t(4), SelectFastestVariant({{100}, {50}}, 4, 3.f));
+        }
+    };
+
+    TEST_CLASS(GetFoveationForLevelTests) {
+      public:
+        TEST_METHOD(Levels) {
+            const struct {
+                XrFoveationLevelFB level;
+                int innerRadius;
+                int outerRadius;
+                int rates[3];
+            } expectations[] = {
+                {XR_FOVEATION_LEVEL_LOW_FB,
+                 55,
+                 80,
+                 {Rate(VariableShadingRateVal::R_1x1),
+                  Rate(VariableShadingRateVal::R_2x1),
+                  Rate(VariableShadingRateVal::R_2x2)}},
+                {XR_FOVEATION_LEVEL_MEDIUM_FB,
+                 50,
+                 60,
+                 {Rate(VariableShadingRateVal::R_1x1),
+                  Rate(VariableShadingRateVal::R_2x2),
+                  Rate(VariableShadingRateVal::R_4x2)}},
+                {XR_FOVEATION_LEVEL_HIGH_FB,
+                 30,
+                 55,
+                 {Rate(VariableShadingRateVal::R_1x1),
+                  Rate(VariableShadingRateVal::R_2x2),
+                  Rate(VariableShadingRateVal::R_4x4)}},
+            };
+
+            const auto fov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            for (const auto& expected : expectations) {
+                const auto foveation = GetFoveationForLevel(expected.level, 0.f, fov, false);
+                Assert::IsTrue(foveation.has_value());
+                Assert::AreEqual(expected.innerRadius, foveation->innerRadius);
+                Assert::AreEqual(expected.outerRadius, foveation->outerRadius);
+                for (size_t i = 0; i < std::size(expected.rates); i++) {
+                    Assert::AreEqual(expected.rates[i], foveation->rates[i]);
+                }
+                Assert::AreEqual(0.f, foveation->verticalOffset);
+                Assert::IsFalse(foveation->isEyeTracked);
+            }
+        }
+
+        TEST_METHOD(HigherLevelsAreNeverFiner) {
+            const auto fov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            const XrFoveationLevelFB levels[] = {
+                XR_FOVEATION_LEVEL_LOW_FB, XR_FOVEATION_LEVEL_MEDIUM_FB, XR_FOVEATION_LEVEL_HIGH_FB};
+            for (size_t i = 1; i < std::size(levels); i++) {
+                const auto lower = GetFoveationForLevel(levels[i - 1], 0.f, fov, false).value();
+                const auto higher = GetFoveationForLevel(levels[i], 0.f, fov, false).value();
+                Assert::IsTrue(higher.innerRadius <= lower.innerRadius);
+                Assert::IsTrue(higher.outerRadius <= lower.outerRadius);
+                for (size_t j = 0; j < std::size(lower.rates); j++) {
+                    Assert::IsTrue(higher.rates[j] >= lower.rates[j]);
+                }
+            }
+        }
+
+        TEST_METHOD(NoFoveation) {
+            const auto fov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            Assert::IsFalse(GetFoveationForLevel(XR_FOVEATION_LEVEL_NONE_FB, 0.f, fov, false).has_value());
+            Assert::IsFalse(GetFoveationForLevel(XrFoveationLevelFB(4), 0.f, fov, false).has_value());
+            Assert::IsFalse(GetFoveationForLevel(XR_FOVEATION_LEVEL_MAX_ENUM_FB, 0.f, fov, false).has_value());
+        }
+
+        TEST_METHOD(VerticalOffset) {
+            const struct {
+                XrFovf fov;
+                float offsetDegrees;
+                float expectedNdc;
+            } expectations[] = {
+                // Symmetric view, tan(45) = 1.
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), 0.f, 0.f},
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), 22.5f, std::tan(22.5f * DegreesToRadians)},
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), -22.5f, -std::tan(22.5f * DegreesToRadians)},
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), 45.f, 1.f},
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), -45.f, -1.f},
+                // Beyond the edges of the view.
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), 60.f, 1.f},
+                {MakeFov(-45.f, 45.f, 45.f, -45.f), -60.f, -1.f},
+                // Asymmetric view, the offset is relative to the half of the view it points to.
+                {MakeFov(-50.f, 40.f, 30.f, -50.f),
+                 10.f,
+                 std::tan(10.f * DegreesToRadians) / std::tan(30.f * DegreesToRadians)},
+                {MakeFov(-50.f, 40.f, 30.f, -50.f),
+                 -10.f,
+                 -std::tan(10.f * DegreesToRadians) / std::tan(50.f * DegreesToRadians)},
+                // No room above the center of the view.
+                {MakeFov(-45.f, 45.f, 0.f, -45.f), 10.f, 0.f},
+                {MakeFov(-45.f, 45.f, -5.f, -45.f), 10.f, 0.f},
+            };
+
+            for (const auto& expected : expectations) {
+                const auto foveation =
+                    GetFoveationForLevel(XR_FOVEATION_LEVEL_MEDIUM_FB, expected.offsetDegrees, expected.fov, false);
+                Assert::AreEqual(expected.expectedNdc, foveation->verticalOffset, 1e-5f);
+            }
+        }
+
+        TEST_METHOD(EyeTracked) {
+            const auto fov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            Assert::IsTrue(GetFoveationForLevel(XR_FOVEATION_LEVEL_LOW_FB, 0.f, fov, true)->isEyeTracked);
+        }
+    };
+
+    TEST_CLASS(FocusViewTests) {
+      public:
+        TEST_METHOD(CenteredFocus) {
+            const auto fullFov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            const auto focusFov = GetFocusFov(fullFov, {0.f, 0.f}, 0.5f);
+            Assert::AreEqual(std::atan(-0.5f), focusFov.angleLeft, 1e-5f);
+            Assert::AreEqual(std::atan(0.5f), focusFov.angleRight, 1e-5f);
+            Assert::AreEqual(std::atan(0.5f), focusFov.angleUp, 1e-5f);
+            Assert::AreEqual(std::atan(-0.5f), focusFov.angleDown, 1e-5f);
+
+            AssertArea({0.25f, 0.25f, 0.75f, 0.75f}, GetFocusArea(fullFov, focusFov));
+        }
+
+        TEST_METHOD(FocusStaysWithinFullView) {
+            const auto fullFov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+
+            // Texture coordinates have V pointing down: the top-right corner is at (1, 0).
+            AssertArea({0.5f, 0.f, 1.f, 0.5f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {1.f, 1.f}, 0.5f)));
+            AssertArea({0.f, 0.5f, 0.5f, 1.f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {-1.f, -1.f}, 0.5f)));
+            AssertArea({0.5f, 0.f, 1.f, 0.5f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {3.f, 2.f}, 0.5f)));
+            AssertArea({0.4f, 0.25f, 0.9f, 0.75f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {0.3f, 0.f}, 0.5f)));
+        }
+
+        TEST_METHOD(FocusSizeIsClamped) {
+            const auto fullFov = MakeFov(-45.f, 45.f, 45.f, -45.f);
+            AssertArea({0.f, 0.f, 1.f, 1.f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {0.5f, 0.5f}, 1.f)));
+            AssertArea({0.f, 0.f, 1.f, 1.f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {0.f, 0.f}, 2.f)));
+            AssertArea({0.5f, 0.5f, 0.5f, 0.5f}, GetFocusArea(fullFov, GetFocusFov(fullFov, {0.f, 0.f}, -1.f)));
+        }
+
+        TEST_METHOD(AsymmetricFullView) {
+            // The area is linear in tangent space, not in angles.
+            const auto fullFov = MakeFov(-50.f, 40.f, 30.f, -50.f);
+            const XrVector2f centers[] = {{0.f, 0.f}, {-0.4f, 0.2f}, {0.9f, -0.9f}};
+            for (const auto& center : centers) {
+                const auto area = GetFocusArea(fullFov, GetFocusFov(fullFov, center, 0.4f));
+                Assert::AreEqual(0.4f, area.z - area.x, 1e-5f);
+                Assert::AreEqual(0.4f, area.w - area.y, 1e-5f);
+                Assert::IsTrue(area.x >= -1e-5f && area.z <= 1.f + 1e-5f);
+                Assert::IsTrue(area.y >= -1e-5f && area.w <= 1.f + 1e-5f);
+            }
+
+            const auto area = GetFocusArea(fullFov, GetFocusFov(fullFov, {0.f, 0.f}, 0.4f));
+            AssertArea({0.3f, 0.3f, 0.7f, 0.7f}, area);
+        }
+
+      private:
+        static void AssertArea(const XrVector4f& expected, const XrVector4f& area) {
+            Assert::AreEqual(expected.x, area.x, 1e-5f);
+            Assert::AreEqual(expected.y, area.y, 1e-5f);
+            Assert::AreEqual(expected.z, area.z, 1e-5f);
+            Assert::AreEqual(expected.w, area.w, 1e-5f);
+        }
+    };
+
+} // namespace toolkit::tests